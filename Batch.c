@@ -0,0 +1,328 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    Batch.c
+ * Purpose:     The --batch=F option, which assembles all of the programs
+ *              listed in the manifest file F with a single command.
+ * Mod History: 2026-10-17 AGT  Began.
+ *              2026-10-17 AGT  The assemblies run in threads of this
+ *                              process, by yaYULAssembleJob(), rather than
+ *                              in child processes.
+ *
+ * Each line of the manifest describes one assembly, as
+ *
+ *      DIRECTORY LISTING [SWITCHES ...] INPUTFILE
+ *
+ * where DIRECTORY is the directory to assemble in, LISTING is the file
+ * (relative to DIRECTORY) which receives what would have been written to
+ * stdout, and the rest is exactly what would have followed "yaYUL" on the
+ * command line.  Blank lines and lines beginning with '#' are ignored.
+ *
+ * Up to --threads=N worker threads (by default, one per CPU) take the
+ * assemblies in turn, and run each by yaYULAssembleJob() (see Library.c),
+ * which gives it a listing, an error file and a directory of its own.
+ * Whatever the assemblies write to stderr is passed along in manifest
+ * order, and at the end a summary of the time taken for each assembly is
+ * printed.  The exit code is 0 if every assembly's was 0, and 1 otherwise.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#ifndef MSC_VS
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+#endif
+
+#ifdef MSC_VS
+
+int
+Batch(int argc, char *argv[])
+{
+  printf("--batch is not supported on this platform.\n");
+  return (1);
+}
+
+#else
+
+//-------------------------------------------------------------------------
+// Some global data.
+
+#define MAX_BATCH_ARGS 64
+
+typedef struct
+{
+  char *Text;                           // The manifest line, for messages.
+  char *Directory, *Listing;
+  int Argc;
+  char *Argv[MAX_BATCH_ARGS + 1];
+  FILE *Errors;
+  int ExitCode;
+  double Seconds;
+} BatchJob_t;
+
+static BatchJob_t *Jobs = NULL;
+static int NumJobs = 0, MaxJobs = 0;
+
+// The next job for a worker thread to take.
+static pthread_mutex_t NextJobLock = PTHREAD_MUTEX_INITIALIZER;
+static int NextJob = 0;
+
+static double
+Elapsed(const struct timeval *Since)
+{
+  struct timeval Now;
+
+  gettimeofday(&Now, NULL);
+  return ((Now.tv_sec - Since->tv_sec) + (Now.tv_usec - Since->tv_usec) / 1e6);
+}
+
+//-------------------------------------------------------------------------
+// Read the manifest.  Returns 0 on success.
+static int
+ReadManifest(const char *Filename, char *Program)
+{
+  FILE *fp;
+  BatchJob_t *Job;
+  char s[4 * MAX_LINE_LENGTH + 1], *ss, *Field;
+  int LineNumber = 0;
+
+  fp = fopen(Filename, "r");
+  if (fp == NULL)
+    {
+      printf("Cannot read batch manifest \"%s\".\n", Filename);
+      return (1);
+    }
+  while (NULL != fgets(s, sizeof(s), fp))
+    {
+      LineNumber++;
+      for (ss = s; *ss == ' ' || *ss == '\t'; ss++)
+        ;
+      if (*ss == 0 || *ss == '\n' || *ss == '\r' || *ss == '#')
+        continue;
+      if (NumJobs == MaxJobs)
+        {
+          MaxJobs += 64;
+          Jobs = (BatchJob_t *) realloc(Jobs, MaxJobs * sizeof(BatchJob_t));
+          if (Jobs == NULL)
+            {
+              printf("Out of memory (9).\n");
+              fclose(fp);
+              return (1);
+            }
+        }
+      Job = &Jobs[NumJobs];
+      memset(Job, 0, sizeof(BatchJob_t));
+      Job->Text = strdup(ss);
+      ss = strdup(ss);
+      if (Job->Text == NULL || ss == NULL)
+        {
+          printf("Out of memory (9).\n");
+          fclose(fp);
+          return (1);
+        }
+      Job->Text[strcspn(Job->Text, "\r\n")] = 0;
+      Job->Argv[Job->Argc++] = Program;
+      for (Field = strtok(ss, " \t\r\n"); Field != NULL;
+          Field = strtok(NULL, " \t\r\n"))
+        {
+          if (Job->Directory == NULL)
+            Job->Directory = Field;
+          else if (Job->Listing == NULL)
+            Job->Listing = Field;
+          else if (Job->Argc < MAX_BATCH_ARGS)
+            Job->Argv[Job->Argc++] = Field;
+          else
+            {
+              printf("%s:%d: Too many switches.\n", Filename, LineNumber);
+              fclose(fp);
+              return (1);
+            }
+        }
+      Job->Argv[Job->Argc] = NULL;
+      if (Job->Argc < 2)
+        {
+          printf("%s:%d: Expected a directory, a listing file, and an input "
+              "file.\n", Filename, LineNumber);
+          fclose(fp);
+          return (1);
+        }
+      NumJobs++;
+    }
+  fclose(fp);
+  return (0);
+}
+
+//-------------------------------------------------------------------------
+// Run one assembly.  The listing file is relative to the job's directory.
+static void
+RunJob(BatchJob_t *Job)
+{
+  yaYULJob_t Context;
+  struct timeval Started;
+  FILE *Listing;
+  char *Path;
+
+  gettimeofday(&Started, NULL);
+  Job->ExitCode = 1;
+  Path = (char *) malloc(strlen(Job->Directory) + strlen(Job->Listing) + 2);
+  if (Path == NULL)
+    {
+      fprintf(Job->Errors, "Out of memory (9).\n");
+      return;
+    }
+  if (Job->Listing[0] == '/')
+    strcpy(Path, Job->Listing);
+  else
+    sprintf(Path, "%s/%s", Job->Directory, Job->Listing);
+  Listing = fopen(Path, "w");
+  free(Path);
+  if (Listing == NULL && access(Job->Directory, X_OK))
+    fprintf(Job->Errors, "Cannot change to directory \"%s\".\n",
+        Job->Directory);
+  else if (Listing == NULL)
+    fprintf(Job->Errors, "Cannot create listing file \"%s\".\n", Job->Listing);
+  else
+    {
+      memset(&Context, 0, sizeof(Context));
+      Context.Directory = Job->Directory;
+      Context.Listing = Listing;
+      Context.Errors = Job->Errors;
+      Job->ExitCode = yaYULAssembleJob(Job->Argc, Job->Argv, &Context);
+      if (fclose(Listing))
+        {
+          fprintf(Job->Errors, "Cannot write listing file \"%s\".\n",
+              Job->Listing);
+          Job->ExitCode = 1;
+        }
+    }
+  Job->Seconds = Elapsed(&Started);
+}
+
+// A worker thread, which runs jobs until there are none left.
+static void *
+Worker(void *Arg)
+{
+  int i;
+
+  for (;;)
+    {
+      pthread_mutex_lock(&NextJobLock);
+      i = NextJob++;
+      pthread_mutex_unlock(&NextJobLock);
+      if (i >= NumJobs)
+        return (NULL);
+      RunJob(&Jobs[i]);
+    }
+}
+
+//-------------------------------------------------------------------------
+// Perform the assemblies listed in a manifest.  Called by main() in place
+// of Assemble() when --batch is used, with the same command line.
+int
+Batch(int argc, char *argv[])
+{
+  const char *Manifest = NULL;
+  struct timeval Started;
+  pthread_t *Workers;
+  char Buffer[4096];
+  size_t n;
+  int MaxRunning = 0, NumWorkers, Failed, i, j;
+
+  for (i = 1; i < argc; i++)
+    {
+      if (!strncmp(argv[i], "--batch=", 8) && argv[i][8])
+        Manifest = &argv[i][8];
+      else if (1 == sscanf(argv[i], "--threads=%d", &j))
+        MaxRunning = j;
+      else
+        {
+          printf("Switch \"%s\" can't be used with --batch.\n", argv[i]);
+          return (1);
+        }
+    }
+  if (Manifest == NULL)
+    {
+      printf("No batch manifest.\n");
+      return (1);
+    }
+  if (MaxRunning < 1)
+    MaxRunning = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  if (MaxRunning < 1)
+    MaxRunning = 1;
+  if (ReadManifest(Manifest, argv[0]))
+    return (1);
+  for (i = 0; i < NumJobs; i++)
+    {
+      Jobs[i].Errors = tmpfile();
+      if (Jobs[i].Errors == NULL)
+        {
+          printf("Cannot create temporary file.\n");
+          return (1);
+        }
+    }
+
+  // If no worker thread can be started, this thread does the work.
+  gettimeofday(&Started, NULL);
+  fflush(NULL);
+  if (MaxRunning > NumJobs)
+    MaxRunning = NumJobs;
+  Workers = (pthread_t *) malloc((MaxRunning + 1) * sizeof(pthread_t));
+  if (Workers == NULL)
+    {
+      printf("Out of memory (9).\n");
+      return (1);
+    }
+  for (NumWorkers = 0; NumWorkers < MaxRunning; NumWorkers++)
+    if (pthread_create(&Workers[NumWorkers], NULL, Worker, NULL))
+      break;
+  if (NumWorkers == 0)
+    Worker(NULL);
+  for (i = 0; i < NumWorkers; i++)
+    pthread_join(Workers[i], NULL);
+  free(Workers);
+
+  // Pass along the error messages, and summarize.
+  for (i = 0; i < NumJobs; i++)
+    {
+      fflush(Jobs[i].Errors);
+      if (ftell(Jobs[i].Errors) <= 0)
+        continue;
+      fprintf(stderr, "(%s)\n", Jobs[i].Text);
+      rewind(Jobs[i].Errors);
+      while (0 < (n = fread(Buffer, 1, sizeof(Buffer), Jobs[i].Errors)))
+        fwrite(Buffer, 1, n, stderr);
+    }
+  printf("Batch assembly summary:\n");
+  printf("  Seconds  Exit  Assembly\n");
+  for (i = Failed = 0; i < NumJobs; i++)
+    {
+      printf("%9.2f  %4d  %s\n", Jobs[i].Seconds, Jobs[i].ExitCode,
+          Jobs[i].Text);
+      if (Jobs[i].ExitCode != 0)
+        Failed++;
+    }
+  printf("Assemblies:  %d (%d failed), %d at a time, %.2f seconds.\n", NumJobs,
+      Failed, NumWorkers ? NumWorkers : 1, Elapsed(&Started));
+  return (Failed != 0);
+}
+
+#endif // MSC_VS
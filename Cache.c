@@ -0,0 +1,555 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    Cache.c
+ * Purpose:     The --cache=DIR option, which saves the results of each
+ *              assembly so that reassembling an unchanged program can
+ *              simply reproduce them.
+ * Mod History: 2026-10-17 AGT  Began.
+ *              2026-10-17 AGT  Added CacheTrackOutputs() and CacheOutputs(),
+ *                              for ParallelPass.c.  --processes doesn't
+ *                              affect the hash.
+ *              2026-10-17 AGT  Running out of memory fails the assembly
+ *                              rather than exiting.
+ *
+ * An assembly is identified by a 64-bit hash of the assembler's version,
+ * the command line, the contents of every source file reachable from the
+ * top-level file through $ directives, and the contents of the HTML-insert
+ * and Default.style files.  Under the cache directory there is a
+ * subdirectory for each assembly, named by the hash in hex, containing:
+ *
+ *   listing     Everything written to stdout.
+ *   errors      Everything written to stderr.
+ *   manifest    The exit code on the first line, followed by the names of
+ *               the output files (the .bin, the .symtab, the HTML files),
+ *               one per line, each preceded by '+' if the file is stored as
+ *               output.N (N being its position in the list) or by '-' if it
+ *               didn't exist at the end of the assembly.
+ *
+ * On a hit, the output files are restored, the listing and errors are
+ * reproduced, and nothing is assembled.  On a miss, stdout and stderr are
+ * redirected into a new subdirectory (named with the process ID, so that
+ * simultaneous assemblies don't interfere) while assembly proceeds, and
+ * at the end the subdirectory is renamed to the hash.  Since a change to
+ * any file changes the hash, only the entries which depended on that file
+ * are affected, and they're never overwritten, just no longer used.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifndef MSC_VS
+#include <unistd.h>
+#else
+#include <io.h>
+#include <direct.h>
+#include <process.h>
+#define mkdir(d,m) _mkdir(d)
+#define getpid _getpid
+#endif
+
+//-------------------------------------------------------------------------
+// Some global data.
+
+static ASSEMBLY uint64_t CacheHash;
+
+// Source files already hashed.
+static ASSEMBLY SourceFile_t **Hashed = NULL;
+static ASSEMBLY int NumHashed = 0, MaxHashed = 0;
+
+// The entry being looked up or created, and room for the name of any file
+// in it (see JoinPath()).
+static ASSEMBLY char *EntryName = NULL, *StagingName = NULL;
+static ASSEMBLY char *PathBuffer = NULL;
+
+// While an assembly is being captured:  the original stdout and stderr,
+// and the output files noted so far.
+static ASSEMBLY int Capturing = 0, SavedStdout = -1, SavedStderr = -1;
+static ASSEMBLY char **Outputs = NULL;
+static ASSEMBLY int NumOutputs = 0, MaxOutputs = 0;
+
+// Whether to keep the list of output files even when not capturing.
+static ASSEMBLY int Tracking = 0;
+
+//-------------------------------------------------------------------------
+// Hashing.  This is FNV-1a.
+
+static void
+HashBytes(const void *Data, size_t Size)
+{
+  const unsigned char *p = (const unsigned char *) Data;
+
+  for (; Size > 0; Size--, p++)
+    CacheHash = (CacheHash ^ *p) * 0x100000001b3ULL;
+}
+
+// Strings are hashed with their terminating nul, so that adjacent strings
+// can't run together.
+static void
+HashString(const char *s)
+{
+  HashBytes(s, strlen(s) + 1);
+}
+
+// Hash a file which isn't assembly-language source, such as an HTML insert.
+static void
+HashOtherFile(const char *Filename)
+{
+  FILE *fp;
+  char Buffer[4096];
+  size_t n;
+
+  HashString(Filename);
+  fp = fopen(Filename, "rb");
+  if (fp == NULL)
+    {
+      HashString("(missing)");
+      return;
+    }
+  while (0 < (n = fread(Buffer, 1, sizeof(Buffer), fp)))
+    HashBytes(Buffer, n);
+  fclose(fp);
+  HashString("(end)");
+}
+
+// Hash the name of an HTML insert, given the text following the opening
+// quote, and the file itself.
+static void
+HashInsert(const char *s)
+{
+  Line_t Filename;
+  int i;
+
+  for (i = 0; s[i] && s[i] != '\"' && i < MAX_LINE_LENGTH; i++)
+    Filename[i] = s[i];
+  Filename[i] = 0;
+  HashOtherFile(Filename);
+}
+
+// Hash a source file, and (recursively) the files it includes.
+static void
+HashSourceFile(const char *Filename)
+{
+  SourceFile_t *File;
+  int i;
+
+  HashString(Filename);
+  File = GetSourceFile(Filename);
+  if (File == NULL)
+    {
+      HashString("(missing)");
+      return;
+    }
+  for (i = 0; i < NumHashed; i++)
+    if (Hashed[i] == File)
+      {
+        HashString("(again)");
+        return;
+      }
+  if (NumHashed == MaxHashed)
+    {
+      MaxHashed += 64;
+      Hashed = (SourceFile_t **) realloc(Hashed,
+          MaxHashed * sizeof(SourceFile_t *));
+      if (Hashed == NULL)
+        {
+          fprintf(LISTING, "Out of memory (7).\n");
+          OutOfMemory = 1;
+          NumHashed = MaxHashed = 0;
+          return;
+        }
+    }
+  Hashed[NumHashed++] = File;
+
+  HashBytes(File->Image, File->ImageSize);
+  HashString("(end)");
+
+  for (i = 0; i < File->NumLines; i++)
+    {
+      SourceLine_t *Line = &File->Lines[i];
+      Line_t Raw, Prepared, Include;
+
+      if (SourceFirstChar(Line) != '$' && Line->Text[0] != '$'
+          && Line->Text[0] != '<' && Line->Text[0] != '#')
+        continue;
+      SourceText(Raw, sizeof(Raw), Line, 1);
+      SourceText(Prepared, sizeof(Prepared), Line, 0);
+      if ((Prepared[0] == '$' && 1 == sscanf(Prepared, "$%s", Include))
+          || (Raw[0] == '$' && 1 == sscanf(Raw, "$%s", Include)))
+        HashSourceFile(Include);
+      else if (!strncmp(Raw, "<HTML \"", 7))
+        HashInsert(&Raw[7]);
+      else if (!strncmp(Raw, "### FILE=\"", 10))
+        HashInsert(&Raw[10]);
+    }
+}
+
+//-------------------------------------------------------------------------
+// Utilities for the cache directory.
+
+// Every name made is the cache directory, or an entry in it, followed by
+// a name of at most PATH_EXTRA characters; CacheLookup() allocates the
+// buffers for them.  JoinPath()'s result lasts until the next call.
+#define PATH_EXTRA 64
+
+static char *
+JoinPath(const char *Directory, const char *Name)
+{
+  sprintf(PathBuffer, "%s/%s", Directory, Name);
+  return (PathBuffer);
+}
+
+// Copy a file.  Returns 0 on success, non-zero on failure.
+static int
+CopyFile(const char *From, const char *To)
+{
+  FILE *In, *Out;
+  char Buffer[4096];
+  size_t n;
+  int RetVal = 0;
+
+  In = fopen(From, "rb");
+  if (In == NULL)
+    return (1);
+  Out = fopen(To, "wb");
+  if (Out == NULL)
+    {
+      fclose(In);
+      return (1);
+    }
+  while (0 < (n = fread(Buffer, 1, sizeof(Buffer), In)))
+    if (n != fwrite(Buffer, 1, n, Out))
+      RetVal = 1;
+  fclose(In);
+  if (fclose(Out))
+    RetVal = 1;
+  return (RetVal);
+}
+
+// Copy a file to an already-open stream.
+static void
+CopyToStream(const char *From, FILE *To)
+{
+  FILE *In;
+  char Buffer[4096];
+  size_t n;
+
+  In = fopen(From, "rb");
+  if (In == NULL)
+    return;
+  while (0 < (n = fread(Buffer, 1, sizeof(Buffer), In)))
+    fwrite(Buffer, 1, n, To);
+  fclose(In);
+  fflush(To);
+}
+
+// Remove a cache entry's directory, along with whatever is in it.
+static void
+RemoveEntry(const char *Entry)
+{
+  char *Path, Name[32];
+  int i;
+
+  for (i = 0; i < NumOutputs; i++)
+    {
+      sprintf(Name, "output.%d", i);
+      Path = JoinPath(Entry, Name);
+      remove(Path);
+    }
+  Path = JoinPath(Entry, "listing");
+  remove(Path);
+  Path = JoinPath(Entry, "errors");
+  remove(Path);
+  Path = JoinPath(Entry, "manifest");
+  remove(Path);
+  rmdir(Entry);
+}
+
+// Point a file descriptor (1 or 2) at a file.  Returns the duplicate of the
+// original descriptor, or -1 on failure.
+static int
+RedirectDescriptor(int Descriptor, const char *Filename)
+{
+  int Saved, fd;
+
+  fd = open(Filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+    return (-1);
+  Saved = dup(Descriptor);
+  if (Saved < 0 || dup2(fd, Descriptor) < 0)
+    {
+      close(fd);
+      if (Saved >= 0)
+        close(Saved);
+      return (-1);
+    }
+  close(fd);
+  return (Saved);
+}
+
+//-------------------------------------------------------------------------
+// Look up the assembly described by the command line in the cache.  Returns
+// 1 if it's there, in which case CacheRestore() should be called to
+// produce the output.  Otherwise, returns 0 after arranging for the
+// assembly's output to be captured, in which case CacheNoteOutput() should
+// be called for each output file and CacheStore() at the end.  Returns -1
+// if memory ran out.
+int
+CacheLookup(const char *Directory, const char *InputFilename, int argc,
+    char *argv[])
+{
+  char Name[32], *Path;
+  struct stat Stat;
+  int i;
+
+  CacheHash = 0xcbf29ce484222325ULL;
+  HashString("yaYUL " NVER " " __DATE__ " " __TIME__);
+  // (--processes doesn't change the output, so it's left out.)
+  for (i = 1; i < argc; i++)
+    if (strncmp(argv[i], "--cache=", 8)
+        && strncmp(argv[i], "--processes=", 12))
+      HashString(argv[i]);
+  HashString("(switches)");
+  HashSourceFile(InputFilename);
+  HashOtherFile("Default.style");
+
+  free(PathBuffer);
+  free(EntryName);
+  free(StagingName);
+  i = strlen(Directory) + 2 * PATH_EXTRA;
+  PathBuffer = (char *) malloc(i);
+  EntryName = (char *) malloc(i);
+  StagingName = (char *) malloc(i);
+  if (PathBuffer == NULL || EntryName == NULL || StagingName == NULL)
+    {
+      fprintf(LISTING, "Out of memory (7).\n");
+      OutOfMemory = 1;
+    }
+  if (OutOfMemory)
+    return (-1);
+
+  mkdir(Directory, 0777);
+  sprintf(Name, "%016llx", (unsigned long long) CacheHash);
+  strcpy(EntryName, JoinPath(Directory, Name));
+  Path = JoinPath(EntryName, "manifest");
+  i = stat(Path, &Stat);
+  if (i == 0)
+    return (1);
+
+  // Not there, so start capturing.
+  sprintf(Name, "%016llx.%d", (unsigned long long) CacheHash, (int) getpid());
+  strcpy(StagingName, JoinPath(Directory, Name));
+  if (mkdir(StagingName, 0777))
+    {
+      fprintf(stderr, "Cannot create cache directory \"%s\".\n", StagingName);
+      return (0);
+    }
+  fflush(stdout);
+  fflush(stderr);
+  Path = JoinPath(StagingName, "listing");
+  SavedStdout = RedirectDescriptor(1, Path);
+  Path = JoinPath(StagingName, "errors");
+  SavedStderr = RedirectDescriptor(2, Path);
+  if (SavedStdout < 0 || SavedStderr < 0)
+    {
+      if (SavedStdout >= 0)
+        dup2(SavedStdout, 1);
+      if (SavedStderr >= 0)
+        dup2(SavedStderr, 2);
+      RemoveEntry(StagingName);
+      fprintf(stderr, "Cannot write to cache directory \"%s\".\n",
+          StagingName);
+      return (0);
+    }
+  Capturing = 1;
+  return (0);
+}
+
+//-------------------------------------------------------------------------
+// Make note of a file written by the assembly being captured.
+void
+CacheNoteOutput(const char *Filename)
+{
+  int i;
+
+  if (!Capturing && !Tracking)
+    return;
+  if (OutOfMemory)
+    return;
+  for (i = 0; i < NumOutputs; i++)
+    if (!strcmp(Outputs[i], Filename))
+      return;
+  if (NumOutputs == MaxOutputs)
+    {
+      char **NewOutputs;
+
+      NewOutputs = (char **) realloc(Outputs,
+          (MaxOutputs + 64) * sizeof(char *));
+      if (NewOutputs == NULL)
+        {
+          fprintf(LISTING, "Out of memory (7).\n");
+          OutOfMemory = 1;
+          return;
+        }
+      Outputs = NewOutputs;
+      MaxOutputs += 64;
+    }
+  Outputs[NumOutputs] = strdup(Filename);
+  if (Outputs[NumOutputs] == NULL)
+    {
+      fprintf(LISTING, "Out of memory (7).\n");
+      OutOfMemory = 1;
+      return;
+    }
+  NumOutputs++;
+}
+
+//-------------------------------------------------------------------------
+// Keep the list of output files from now on, whether or not the assembly
+// is being captured, and fetch the list.  The count is -1 if memory ran
+// out, since the list is then incomplete.
+void
+CacheTrackOutputs(void)
+{
+  Tracking = 1;
+}
+
+char **
+CacheOutputs(int *Count)
+{
+  *Count = OutOfMemory ? -1 : NumOutputs;
+  return (Outputs);
+}
+
+//-------------------------------------------------------------------------
+// At the end of an assembly being captured, save its output in the cache,
+// and reproduce the listing and errors on the real stdout and stderr.
+// RetVal is the program's exit code, and what's returned, except that
+// running out of memory (see OutOfMemory) makes it 1 and leaves the entry
+// out of the cache.
+int
+CacheStore(int RetVal)
+{
+  char Name[32], *Path, *Entry;
+  FILE *Manifest;
+  int i, Failed = 0;
+
+  if (OutOfMemory && RetVal == 0)
+    RetVal = 1;
+  if (!Capturing)
+    return (RetVal);
+  Capturing = 0;
+  fflush(stdout);
+  fflush(stderr);
+  dup2(SavedStdout, 1);
+  close(SavedStdout);
+  dup2(SavedStderr, 2);
+  close(SavedStderr);
+
+  // Copy the output files and write the manifest.
+  Path = JoinPath(StagingName, "manifest");
+  Manifest = OutOfMemory ? NULL : fopen(Path, "w");
+  if (Manifest == NULL)
+    Failed = 1;
+  else
+    {
+      fprintf(Manifest, "%d\n", RetVal);
+      for (i = 0; i < NumOutputs; i++)
+        {
+          sprintf(Name, "output.%d", i);
+          Path = JoinPath(StagingName, Name);
+          if (CopyFile(Outputs[i], Path))
+            {
+              remove(Path);
+              fprintf(Manifest, "-%s\n", Outputs[i]);
+            }
+          else
+            fprintf(Manifest, "+%s\n", Outputs[i]);
+            }
+      if (fclose(Manifest))
+        Failed = 1;
+    }
+
+  // Put the entry into place, unless another assembly beat us to it.
+  Entry = StagingName;
+  if (!Failed && !rename(StagingName, EntryName))
+    Entry = EntryName;
+
+  Path = JoinPath(Entry, "listing");
+  CopyToStream(Path, stdout);
+  Path = JoinPath(Entry, "errors");
+  CopyToStream(Path, stderr);
+
+  if (Entry == StagingName)
+    RemoveEntry(StagingName);
+  return (RetVal);
+}
+
+//-------------------------------------------------------------------------
+// Reproduce an assembly found by CacheLookup().  Returns the exit code of
+// the original assembly.
+int
+CacheRestore(void)
+{
+  FILE *Manifest;
+  Line_t s;
+  char Name[32], *Path;
+  int i, RetVal = 1;
+
+  Path = JoinPath(EntryName, "manifest");
+  Manifest = fopen(Path, "r");
+  if (Manifest == NULL || NULL == fgets(s, sizeof(s), Manifest)
+      || 1 != sscanf(s, "%d", &RetVal))
+    {
+      if (Manifest != NULL)
+        fclose(Manifest);
+      fprintf(stderr, "Corrupted cache entry \"%s\".\n", EntryName);
+      return (1);
+    }
+
+  for (i = 0; NULL != fgets(s, sizeof(s), Manifest); i++)
+    {
+      char *ss;
+
+      ss = strchr(s, '\n');
+      if (ss != NULL)
+        *ss = 0;
+      if (s[0] == '+')
+        {
+          sprintf(Name, "output.%d", i);
+          Path = JoinPath(EntryName, Name);
+          if (CopyFile(Path, &s[1]))
+            fprintf(stderr, "Cannot restore \"%s\" from the cache.\n", &s[1]);
+            }
+      else
+        remove(&s[1]);
+    }
+  fclose(Manifest);
+
+  Path = JoinPath(EntryName, "listing");
+  CopyToStream(Path, stdout);
+  Path = JoinPath(EntryName, "errors");
+  CopyToStream(Path, stderr);
+
+  return (RetVal);
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    Checksum.c
+ * Purpose:     The bank checksums:  summing the banks for the bugger
+ *              words, and the --verify-checksums option.
+ * Mod History: 2026-10-17 AGT  Began.
+ *
+ * A bank's checksum is the sum of its words as computed by Add() in
+ * yaYUL.c, one word after another.  Add() works on native integers from
+ * -037777 to +037777, and when a sum goes out of that range it wraps it
+ * back in by 037777, the other way.  So the running sum is always
+ * congruent to the true sum modulo 037777, but which of the two possible
+ * values it has (say, 0 or -037777) depends on the order of the words:
+ * 10000 + 10000 - 10000 - 10000 (decimal) comes to -037777, while
+ * 10000 - 10000 + 10000 - 10000 comes to 0.  Since the sign of the sum
+ * decides which bugger word is used, ChecksumBanks() can't simply add up
+ * each bank any which way.  Instead it adds up all of the banks at once,
+ * a word from every bank at each step, so each bank is still summed in
+ * order but the banks are independent lanes that the compiler can
+ * vectorize.
+ *
+ * Verifying a rope only needs the congruence, though:  a bank is good if
+ * its sum is congruent to +B, or (without --pos-checksums) to -B, where B
+ * is the bank number.  So VerifyChecksums() just adds up each bank as
+ * ordinary integers and reduces once at the end.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// The modulus of Add():  a native sum outside of -CHECKSUM_WRAP to
+// +CHECKSUM_WRAP is brought back in by CHECKSUM_WRAP.
+#define CHECKSUM_WRAP 037777
+
+// Convert a 15-bit AGC word to a native integer, as AgcToNative() in
+// yaYUL.c, but without branching:  if bit 14 is set, the word is
+// -(077777 & ~Word), which is Word - 077777.
+#define NATIVE(Word) ((Word) - 077777 * ((Word) >> 14))
+
+//-------------------------------------------------------------------------
+// For each bank, sum the first Lengths[Bank] words (at most 02000) of
+// ObjectCode[Bank] exactly as repeated calls of Add() would, and store the
+// result, in AGC format, in Sums[Bank].
+void
+ChecksumBanks(const int Lengths[044], uint16_t Sums[044])
+{
+  int Sum[044], Longest = 0, Bank, Offset, Word, s;
+
+  for (Bank = 0; Bank < 044; Bank++)
+    {
+      Sum[Bank] = 0;
+      if (Lengths[Bank] > Longest)
+        Longest = Lengths[Bank];
+    }
+  if (Longest > 02000)
+    Longest = 02000;
+
+  for (Offset = 0; Offset < Longest; Offset++)
+    for (Bank = 0; Bank < 044; Bank++)
+      {
+        Word = ObjectCode[Bank][Offset] & 077777;
+        s = Sum[Bank] + (NATIVE(Word) & -(Offset < Lengths[Bank]));
+        s -= CHECKSUM_WRAP * (s > CHECKSUM_WRAP);
+        s += CHECKSUM_WRAP * (s < -CHECKSUM_WRAP);
+        Sum[Bank] = s;
+      }
+
+  // Back to 1's complement, as at the end of Add().
+  for (Bank = 0; Bank < 044; Bank++)
+    Sums[Bank] = Sum[Bank] + 077777 * (Sum[Bank] < 0);
+}
+
+//-------------------------------------------------------------------------
+// Check the bank checksums of an existing core-rope image, in one of the
+// ROPE_xxx formats (see Rope.c), assembled with or without --block1 as is
+// in effect now.  With PosChecksums, only +B is accepted.  Lists each bank,
+// and returns the number of banks with bad checksums, or -1 if the file
+// can't be read.  Banks which are entirely 0 are unused, and are skipped.
+int
+VerifyChecksums(const char *Filename, int Format, int PosChecksums)
+{
+  unsigned char *Image;
+  const unsigned char *In;
+  FILE *fp;
+  int Size, NumBanks, BankRaw, Bank, Offset, Raw, Word, Total, Used, Residue;
+  int Bad = 0;
+
+  fp = fopen(Filename, "rb");
+  if (fp == NULL)
+    {
+      fprintf(LISTING, "Cannot open core-rope file \"%s\".\n", Filename);
+      return (-1);
+    }
+  Image = (unsigned char *) malloc(044 * 02000 * 2);
+  if (Image == NULL)
+    {
+      fprintf(LISTING, "Out of memory (13).\n");
+      fclose(fp);
+      return (-1);
+    }
+  Size = fread(Image, 1, 044 * 02000 * 2, fp);
+  if (ferror(fp) || fgetc(fp) != EOF || Size == 0 || (Size % (2 * 02000)))
+    {
+      fprintf(LISTING, "File \"%s\" is not a core-rope image.\n", Filename);
+      fclose(fp);
+      free(Image);
+      return (-1);
+    }
+  fclose(fp);
+
+  // The banks are in the same order as Assemble() writes them.
+  NumBanks = Size / (2 * 02000);
+  for (BankRaw = 0; BankRaw < NumBanks; BankRaw++)
+    {
+      Bank = BankRaw + (Block1 ? 1 : 0);
+      if (Bank < 4 && Format != ROPE_HARDWARE && !Block1)
+        Bank ^= 2;
+
+      In = &Image[BankRaw * 2 * 02000];
+      Total = Used = 0;
+      if (Format == ROPE_HARDWARE)
+        for (Offset = 0; Offset < 02000; Offset++)
+          {
+            Raw = (In[2 * Offset] << 8) | In[2 * Offset + 1];
+            Word = ((Raw & 0100000) >> 1) | (Raw & 037777);
+            Total += NATIVE(Word);
+            Used |= Word;
+          }
+      else
+        for (Offset = 0; Offset < 02000; Offset++)
+          {
+            Raw = (In[2 * Offset] << 8) | In[2 * Offset + 1];
+            Word = Raw >> 1;
+            Total += NATIVE(Word);
+            Used |= Word;
+          }
+
+      if (!Used)
+        {
+          fprintf(LISTING, "Bank %02o:  unused.\n", Bank);
+          continue;
+        }
+      Residue = Total % CHECKSUM_WRAP;
+      if (Residue < 0)
+        Residue += CHECKSUM_WRAP;
+      if (Residue == Bank)
+        fprintf(LISTING, "Bank %02o:  checksum +%02o.\n", Bank, Bank);
+      else if (!PosChecksums
+          && Residue == (CHECKSUM_WRAP - Bank) % CHECKSUM_WRAP)
+        fprintf(LISTING, "Bank %02o:  checksum -%02o.\n", Bank, Bank);
+      else
+        {
+          fprintf(LISTING, "Bank %02o:  bad checksum.\n", Bank);
+          Bad++;
+        }
+    }
+  free(Image);
+  fprintf(LISTING, "Banks with bad checksums:  %d\n", Bad);
+  return (Bad);
+}
@@ -24,57 +24,88 @@
                 01/28/17 MAS   Added support for implicit decimals
                                (numbers are automatical decimal if they
                                have an 8 or a 9)
+                2026-10-17 AGT Replaced the two scans and the sscanf with
+                               the single-pass GetNumber().
 */
 
 #include "yaYUL.h"
-#include <stdlib.h>
-#include <ctype.h>
-#include <string.h>
+#include <limits.h>
 
 //-------------------------------------------------------------------------
-// Reads an octal or decimal constant from a string.  Returns 0 on success.
+// Reads an octal or decimal constant from a string, in a single pass, and
+// returns its radix (8 or 10) along with its value.  Returns 0 on success.
+// The rules are those GetOctOrDec() always had:  digits 0-7 alone (with an
+// optional sign) are octal, while the number is decimal if it ends in 'D'
+// or contains an 8 or a 9.  The value is what sscanf's %o or %d would have
+// given, down to the treatment of overflow, and a lone sign (with or without
+// the 'D') is accepted without changing *Value, as it was by sscanf.
 int
-GetOctOrDec(const char *s, int *Value)
+GetNumber(const char *s, int *Value, int *Radix)
 {
   const char *ss;
-  int has_8_or_9 = 0;
+  unsigned long Oct = 0, Dec = 0;
+  int Negative = 0, Digits = 0, Has8or9 = 0, OctOverflow = 0, DecOverflow = 0;
+  unsigned d;
 
-  // Well, let's see if this is an octal number.
   ss = s;
-
   if (*ss == '+' || *ss == '-')
-    ss++;
+    Negative = (*ss++ == '-');
 
-  for (; *ss; ss++)
-    if (*ss < '0' || *ss > '7')
-      break;
+  for (; (d = (unsigned) (*ss - '0')) <= 9; ss++, Digits++)
+    {
+      if (d >= 8)
+        Has8or9 = 1;
+      else if (Oct > (ULONG_MAX >> 3))
+        OctOverflow = 1;
+      else
+        Oct = (Oct << 3) | d;
+      if (Dec > (ULONG_MAX - d) / 10)
+        DecOverflow = 1;
+      else
+        Dec = Dec * 10 + d;
+    }
 
-  if (!*ss && ss != s)
+  if (!*ss && ss != s && !Has8or9)
     {
-      // It is, it is!
-      sscanf(s, "%o", Value);
+      *Radix = 8;
+      if (Digits)
+        {
+          if (OctOverflow)
+            Oct = ULONG_MAX;
+          else if (Negative)
+            Oct = -Oct;
+          *Value = (int) (unsigned) Oct;
+        }
       return (0);
-    }  
-  
-  // Now, let's see if it's a decimal number.
-  ss = s;
-  if (*ss == '+' || *ss == '-')
-    ss++;
+    }
 
-  for (; *ss; ss++)
-    if (*ss == '8' || *ss == '9')   
-      has_8_or_9 = 1;
-    else if (*ss < '0' || *ss > '9') 
-      break;
-
-  if ((*ss == 'D' && ss[1] == 0 && ss != s) || (has_8_or_9 && ss[0] == 0))
+  if ((*ss == 'D' && ss[1] == 0 && ss != s) || (Has8or9 && !*ss))
     {
-      // It is, it is!
-      sscanf(s, "%d", Value);
+      long l;
+
+      *Radix = 10;
+      if (Digits)
+        {
+          if (Negative)
+            l = (DecOverflow || Dec > (unsigned long) LONG_MAX + 1) ?
+                LONG_MIN : (long) (0 - Dec);
+          else
+            l = (DecOverflow || Dec > LONG_MAX) ? LONG_MAX : (long) Dec;
+          *Value = (int) l;
+        }
       return (0);
-    }  
-    
-  // It wasn't either octal or decimal.  :-(      
-  return (1);    
+    }
+
+  // It wasn't either octal or decimal.  :-(
+  return (1);
 }
 
+//-------------------------------------------------------------------------
+// Reads an octal or decimal constant from a string.  Returns 0 on success.
+int
+GetOctOrDec(const char *s, int *Value)
+{
+  int Radix;
+
+  return (GetNumber(s, Value, &Radix));
+}
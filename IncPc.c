@@ -26,6 +26,9 @@
   History:      04/15/03 RSB    Began.
                 08/18/16 RSB    Some cross-my-finger-and-hope tweaks for
                                 --block1.
+                2026-10-17 AGT  Counts its calls, for --stats.
+                2026-10-17 AGT  The usual case, with no change of bank, is
+                                done from a table of the memory regions.
  */
 
 #include "yaYUL.h"
@@ -33,13 +36,70 @@
 #include <math.h>
 #include <string.h>
 
+//-------------------------------------------------------------------------
+// The range of S-register values in each kind of memory region, and how
+// the S-register is converted back to a pseudo-address there.  The table
+// is indexed by Block1, and then by REGION_INDEX() of the address.  It
+// says just what the general code in IncPc() below would decide.
+
+enum { REGION_NONE, REGION_UNBANKED, REGION_EBANKED, REGION_FBANKED };
+
+typedef struct
+{
+    int Min, Max, Kind;
+} Region_t;
+
+#define REGION_INDEX(a) \
+    ((a)->Erasable | ((a)->Fixed << 1) | ((a)->Banked << 2) | ((a)->Unbanked << 3))
+
+static const Region_t Regions[2][16] = {
+    {
+        { 0, 0, REGION_NONE },                  // (nothing)
+        { 0, 0, REGION_NONE },                  // Erasable
+        { 0, 0, REGION_NONE },                  // Fixed
+        { 0, 0, REGION_NONE },                  // Erasable Fixed
+        { 0, 0, REGION_NONE },                  // Banked
+        { 01400, 01777, REGION_EBANKED },       // Erasable Banked
+        { 02000, 03777, REGION_FBANKED },       // Fixed Banked
+        { 01400, 01777, REGION_EBANKED },       // Erasable Fixed Banked
+        { 0, 0, REGION_NONE },                  // Unbanked
+        { 0, 01377, REGION_UNBANKED },          // Erasable Unbanked
+        { 04000, 07777, REGION_UNBANKED },      // Fixed Unbanked
+        { 0, 01377, REGION_UNBANKED },          // Erasable Fixed Unbanked
+        { 0, 0, REGION_NONE },                  // Banked Unbanked
+        { 0, 01377, REGION_UNBANKED },          // Erasable Banked Unbanked
+        { 02000, 03777, REGION_UNBANKED },      // Fixed Banked Unbanked
+        { 0, 01377, REGION_UNBANKED }           // (everything)
+    }, {
+        { 0, 0, REGION_NONE },
+        { 0, 0, REGION_NONE },
+        { 0, 0, REGION_NONE },
+        { 0, 0, REGION_NONE },
+        { 0, 0, REGION_NONE },
+        { 0, 0, REGION_NONE },
+        { 06000, 07777, REGION_FBANKED },
+        { 0, 0, REGION_NONE },
+        { 0, 0, REGION_NONE },
+        { 0, 01777, REGION_UNBANKED },
+        { 02000, 07777, REGION_UNBANKED },
+        { 0, 01777, REGION_UNBANKED },
+        { 0, 0, REGION_NONE },
+        { 0, 01777, REGION_UNBANKED },
+        { 06000, 07777, REGION_UNBANKED },
+        { 0, 01777, REGION_UNBANKED }
+    }
+};
+
 //-------------------------------------------------------------------------
 // Increment program counter by a certain amount. 
 // Sets the Overflow flag in the Address_t structure.
 void IncPc(Address_t *OldPc, int Increment, Address_t *NewPc)
 {
+    const Region_t *Region;
     int i, j, Max, Min, BankIncrement;
 
+    StatsCounters.IncPcCalls++;
+
     // I have no theoretical basis for how to treat the case of Increment
     // being very large (larger than a bank size), but there is a place
     // in the Luminary source code where decrements of about 12000 (octal)
@@ -86,7 +146,8 @@ void IncPc(Address_t *OldPc, int Increment, Address_t *NewPc)
             NewPc->EB = 0;
             NewPc->FB = 0;
 #ifdef YAYUL_TRACE
-            printf("*** IncPc (%d): clearing superbank...\n", __LINE__);
+            fprintf(LISTING, "*** IncPc (%d): clearing superbank...\n",
+                __LINE__);
 #endif
             NewPc->Super = 0;
             NewPc->SReg = NewPc->Value;
@@ -99,6 +160,39 @@ void IncPc(Address_t *OldPc, int Increment, Address_t *NewPc)
     if (NewPc->Overflow)
         return;
 
+    // Almost always, the bank doesn't change, and everything about the
+    // memory region can simply be looked up.
+    if (BankIncrement == 0) {
+        i = NewPc->SReg + Increment;
+        NewPc->SReg = i;
+        Region = &Regions[Block1 != 0][REGION_INDEX(NewPc)];
+        if (Region->Kind == REGION_NONE) {
+            NewPc->Invalid = 1;
+            return;
+        }
+        if (i < Region->Min) {
+            NewPc->Overflow = 1;
+            NewPc->SReg = Region->Min;
+        } else if (i > Region->Max) {
+            NewPc->Overflow = 1;
+            NewPc->SReg = Region->Max;
+        }
+        switch (Region->Kind) {
+        case REGION_UNBANKED:
+            NewPc->Value = NewPc->SReg;
+            break;
+        case REGION_EBANKED:
+            NewPc->Value = (NewPc->SReg - 01400) + 0400 * NewPc->EB;
+            break;
+        case REGION_FBANKED:
+            NewPc->Value = 010000 + (NewPc->SReg - 02000) + 02000 * NewPc->FB;
+            if (NewPc->Super && NewPc->FB >= 030)
+                NewPc->Value += 010 * 02000;
+            break;
+        }
+        return;
+    }
+
     // Compute the new S-register value (in the absence of overflow).
     i = (j = NewPc->SReg) + Increment;
     NewPc->SReg = i;
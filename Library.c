@@ -0,0 +1,224 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    Library.c
+ * Purpose:     yaYULAssemble(), for programs which link with the assembler
+ *              (the yayul library) rather than running yaYUL.
+ * Mod History: 2026-10-17 AGT  Began.
+ *              2026-10-17 AGT  Added yaYULAssembleJob(), for Batch.c.
+ *
+ * yaYULAssemble() performs one assembly, exactly as running yaYUL with the
+ * same command line would, except that the listing goes to the FILE given
+ * rather than to stdout.  It can be called any number of times, and from
+ * any number of threads at once.  yaYULAssembleJob() is the same, but can
+ * also send the error messages somewhere other than stderr, and assemble
+ * in some other directory.
+ *
+ * That works because every variable making up the state of an assembly is
+ * declared ASSEMBLY (see yaYUL.h), i.e., thread-local.  Each call runs the
+ * assembly in a new thread, so it starts with all of that state freshly
+ * initialized, and whatever memory the assembly allocated is released
+ * before the thread ends.  The only state shared among the threads is the
+ * sorted operator tables, which are sorted just once, before the first
+ * assembly.  The big buffers, ObjectCode[] and the rope image, are
+ * allocated for each assembly rather than being thread-local, so the
+ * thread-local state of every thread in the process is only about 17K.
+ *
+ * The --cache and --processes options work by redirecting the whole
+ * process's stdout, so they're ignored here.
+ *
+ * The current directory, on the other hand, belongs to the process.  On
+ * Linux, an assembly thread given a directory of its own calls
+ * unshare(CLONE_FS) to get a current directory of its own, which it can
+ * then change at will.  Elsewhere, such assemblies take turns, changing
+ * the process's current directory and changing it back afterward.
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#ifndef MSC_VS
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#endif
+
+#ifdef MSC_VS
+
+int
+yaYULAssemble(int argc, char *argv[], FILE *Listing)
+{
+  fprintf(stderr, "yaYULAssemble() is not supported on this platform.\n");
+  return (1);
+}
+
+int
+yaYULAssembleJob(int argc, char *argv[], const yaYULJob_t *Job)
+{
+  fprintf(stderr, "yaYULAssembleJob() is not supported on this platform.\n");
+  return (1);
+}
+
+#else
+
+//-------------------------------------------------------------------------
+// Some global data.
+
+typedef struct
+{
+  int argc;
+  char **argv;
+  yaYULJob_t Job;
+  int RetVal;
+} LibraryJob_t;
+
+static pthread_once_t OperatorsSorted = PTHREAD_ONCE_INIT;
+
+#ifndef __linux__
+static pthread_mutex_t DirectoryLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+//-------------------------------------------------------------------------
+// Undo ChangeDirectory().
+static void
+RestoreDirectory(int Saved)
+{
+#ifndef __linux__
+  if (Saved >= 0)
+    {
+      if (fchdir(Saved))
+        fprintf(ERRORS, "Cannot change back to the original directory.\n");
+      close(Saved);
+      pthread_mutex_unlock(&DirectoryLock);
+    }
+#endif
+}
+
+//-------------------------------------------------------------------------
+// Change to the job's directory, if it has one, as described above.
+// Returns 0 on success, or non-zero (having said why) if it can't.  If
+// so, RestoreDirectory() mustn't be called.
+static int
+ChangeDirectory(LibraryJob_t *Job, int *Saved)
+{
+  *Saved = -1;
+  if (Job->Job.Directory == NULL)
+    return (0);
+#ifdef __linux__
+  if (unshare(CLONE_FS))
+    {
+      fprintf(ERRORS, "Cannot give the assembly a directory of its own.\n");
+      return (1);
+    }
+#else
+  pthread_mutex_lock(&DirectoryLock);
+  *Saved = open(".", O_RDONLY);
+  if (*Saved < 0)
+    {
+      pthread_mutex_unlock(&DirectoryLock);
+      fprintf(ERRORS, "Cannot open the current directory.\n");
+      return (1);
+    }
+#endif
+  if (chdir(Job->Job.Directory))
+    {
+      fprintf(ERRORS, "Cannot change to directory \"%s\".\n",
+          Job->Job.Directory);
+      RestoreDirectory(*Saved);
+      return (1);
+    }
+  return (0);
+}
+
+//-------------------------------------------------------------------------
+// The thread in which an assembly runs.
+static void *
+AssemblyThread(void *Arg)
+{
+  LibraryJob_t *Job = (LibraryJob_t *) Arg;
+  int Saved;
+
+  ListingFile = Job->Job.Listing;
+  ErrorFile = Job->Job.Errors;
+  if (ChangeDirectory(Job, &Saved))
+    return (NULL);
+  Job->RetVal = Assemble(Job->argc, Job->argv);
+  fflush(ListingFile);
+  fflush(ERRORS);
+  RestoreDirectory(Saved);
+
+  // Release everything the assembly allocated.
+  ClearSymbols();
+  ClearLines();
+  ClearSourceFiles();
+  ResolveClear();
+  ClearPass();
+  return (NULL);
+}
+
+//-------------------------------------------------------------------------
+// Perform an assembly.  argv[] is the same as the command line of yaYUL,
+// argv[0] included.  The listing is written to Listing (or to stdout if
+// NULL).  Returns what yaYUL's exit code would have been.
+int
+yaYULAssemble(int argc, char *argv[], FILE *Listing)
+{
+  yaYULJob_t Job;
+
+  memset(&Job, 0, sizeof(Job));
+  Job.Listing = Listing;
+  return (yaYULAssembleJob(argc, argv, &Job));
+}
+
+// The same, but as described by Job (see yaYUL.h).  The filenames on the
+// command line are relative to Job->Directory, if given.
+int
+yaYULAssembleJob(int argc, char *argv[], const yaYULJob_t *Job)
+{
+  LibraryJob_t LibraryJob;
+  pthread_t Thread;
+
+  pthread_once(&OperatorsSorted, SortAllOperators);
+  LibraryJob.argc = argc;
+  LibraryJob.argv = argv;
+  LibraryJob.Job = *Job;
+  if (LibraryJob.Job.Listing == NULL)
+    LibraryJob.Job.Listing = stdout;
+  if (LibraryJob.Job.Errors == NULL)
+    LibraryJob.Job.Errors = stderr;
+  LibraryJob.RetVal = 1;
+  if (pthread_create(&Thread, NULL, AssemblyThread, &LibraryJob))
+    {
+      fprintf(LibraryJob.Job.Errors,
+          "Cannot create a thread for the assembly.\n");
+      return (1);
+    }
+  pthread_join(Thread, NULL);
+  return (LibraryJob.RetVal);
+}
+
+#endif // MSC_VS
@@ -0,0 +1,510 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    ParallelPass.c
+ * Purpose:     The --processes=N option, which splits the final (output)
+ *              pass among several processes.
+ * Mod History: 2026-10-17 AGT  Began.
+ *              2026-10-17 AGT  The children's operand-cache counts are
+ *                              added to the parent's.
+ *              2026-10-17 AGT  The children send their lines via GetLine(),
+ *                              since the line table is no longer made of
+ *                              SymbolLine_t.
+ *              2026-10-17 AGT  The object code is sent without parities.
+ *              2026-10-17 AGT  Renamed the option from --threads, since it
+ *                              starts processes.
+ *              2026-10-17 AGT  The children's --stats counters and times,
+ *                              and the lines they evaluated, are sent back.
+ *
+ * By the time the final pass begins, every symbol has its value, and the
+ * last symbol-resolution pass has recorded (see PassBoundaries in Pass.c)
+ * the complete state of the assembly at each $ directive of the top-level
+ * file.  So the top-level file can be cut up at those points into chunks,
+ * each of which can be assembled independently of the others, starting
+ * from the recorded state.  Since the assembler's state is all in global
+ * variables, each chunk is assembled by a child process rather than by a
+ * thread; the child's listing, errors, and HTML are captured in temporary
+ * files, and the object code and line-table entries it produced are sent
+ * back in another.  The parent then pastes it all together in order.
+ *
+ * The result is exactly what the serial pass would have produced, provided
+ * that the state at the end of each chunk is the same as the recorded
+ * state at which the next chunk began.  That's checked, and if it isn't so
+ * (or if anything else goes wrong), the output of the children is thrown
+ * away and Pass() is simply called as usual.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#ifndef MSC_VS
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+//-------------------------------------------------------------------------
+// Some global data.
+
+extern ASSEMBLY int LineTableSize;
+extern ASSEMBLY int inHeader;
+void SaveUsedCounts(void);
+
+#ifdef MSC_VS
+
+// No fork() on Windows, so always let the caller do it serially.
+int
+ParallelPass(const char *InputFilename, FILE *OutputFile, int *Fatals,
+    int *Warnings)
+{
+  return (1);
+}
+
+#else
+
+// What a child reports back, at the beginning of its results file.  This
+// is followed by NumOutputs file names (each an int length and the
+// characters), NumCells ChunkCell_t, and NumLines SymbolLine_t.
+typedef struct
+{
+  int RetVal, Fatals, Warnings, Reassigned;
+  PassBoundary_t End;
+  int UsedInBank[044];
+  unsigned long OperandHits, OperandMisses;
+  int LinesEvaluated, LinesSkipped;
+  StatsChild_t Stats;
+  int NumOutputs, NumCells, NumLines;
+} ChunkResult_t;
+
+typedef struct
+{
+  short Bank, Offset;
+  uint16_t Data;                        // Including OBJECT_WRITTEN.
+} ChunkCell_t;
+
+typedef struct
+{
+  const PassBoundary_t *Start;          // NULL for the first chunk.
+  int End;                              // -1 for the last chunk.
+  const PassBoundary_t *Next;           // Where the next chunk starts.
+  FILE *Listing, *Errors, *Html, *Results;
+  pid_t Pid;
+  int Ok;
+  ChunkResult_t Result;
+  char **Outputs;
+} Chunk_t;
+
+static ASSEMBLY Chunk_t *Chunks = NULL;
+static ASSEMBLY int NumChunks = 0;
+
+// The normalized names of all the HTML files the assembly would create.
+static ASSEMBLY char **HtmlNames = NULL;
+static ASSEMBLY int NumHtmlNames = 0, MaxHtmlNames = 0;
+
+//-------------------------------------------------------------------------
+// With --html, each source file gets its own HTML file, which the serial
+// pass simply rewrites if the file happens to be included twice.  In that
+// case the chunks could be writing the same file at the same time, so
+// find out whether every file in the include tree is distinct.  Returns 1
+// if so.  (A file which includes itself counts as included twice, so this
+// can't recurse forever.)
+static int
+AddHtmlName(const char *Filename)
+{
+  SourceFile_t *File;
+  char *Name;
+  Line_t Included;
+  int i;
+
+  Name = NormalizeFilename((char *) Filename);
+  for (i = 0; i < NumHtmlNames; i++)
+    if (!strcmp(HtmlNames[i], Name))
+      return (0);
+  if (NumHtmlNames == MaxHtmlNames)
+    {
+      MaxHtmlNames += 64;
+      HtmlNames = (char **) realloc(HtmlNames, MaxHtmlNames * sizeof(char *));
+      if (HtmlNames == NULL)
+        {
+          MaxHtmlNames = NumHtmlNames = 0;
+          return (0);
+        }
+    }
+  HtmlNames[NumHtmlNames] = strdup(Name);
+  if (HtmlNames[NumHtmlNames] == NULL)
+    return (0);
+  NumHtmlNames++;
+
+  File = GetSourceFile(Filename);
+  if (File == NULL)
+    return (0);
+  for (i = 0; i < File->NumLines; i++)
+    if (SourceFirstChar(&File->Lines[i]) == '$')
+      {
+        Line_t Text;
+        SourceText(Text, sizeof(Text), &File->Lines[i], 0);
+        if (sscanf(Text, "$%s", Included) != 1)
+          return (0);
+        if (!AddHtmlName(Included))
+          return (0);
+      }
+  return (1);
+}
+
+static int
+HtmlNamesUnique(const char *InputFilename)
+{
+  int i, RetVal;
+
+  RetVal = AddHtmlName(InputFilename);
+  for (i = 0; i < NumHtmlNames; i++)
+    free(HtmlNames[i]);
+  NumHtmlNames = 0;
+  return (RetVal);
+}
+
+//-------------------------------------------------------------------------
+// Divide the top-level file into at most MaxChunks chunks of roughly equal
+// numbers of lines (counting the included files), at the recorded
+// boundaries.  Returns the number of chunks.
+static int
+PlanChunks(int MaxChunks)
+{
+  int i, n, Goal;
+
+  free(Chunks);
+  Chunks = (Chunk_t *) calloc(MaxChunks, sizeof(Chunk_t));
+  if (Chunks == NULL)
+    return (0);
+  n = 0;
+  Chunks[0].Start = NULL;
+  for (i = 0; i < NumPassBoundaries && n + 1 < MaxChunks; i++)
+    {
+      Goal = (int) ((n + 1) * (long long) PassTotalLines / MaxChunks);
+      if (PassBoundaries[i].CurrentLineAll < Goal)
+        continue;
+      Chunks[n].End = PassBoundaries[i].Line;
+      Chunks[n].Next = &PassBoundaries[i];
+      n++;
+      Chunks[n].Start = &PassBoundaries[i];
+    }
+  Chunks[n].End = -1;
+  Chunks[n].Next = NULL;
+  return (n + 1);
+}
+
+//-------------------------------------------------------------------------
+// Assemble one chunk, in the child process.  Doesn't return.
+static void
+RunChunk(Chunk_t *Chunk, const char *InputFilename, FILE *OutputFile)
+{
+  ChunkResult_t *Result = &Chunk->Result;
+  ChunkCell_t Cell;
+  SymbolLine_t Line;
+  char **Outputs;
+  int FirstOutput, FirstLine, i, j, n;
+
+  if (dup2(fileno(Chunk->Listing), 1) < 0 || dup2(fileno(Chunk->Errors), 2) < 0)
+    _exit(1);
+  if (HtmlOut != NULL)
+    HtmlOut = Chunk->Html;
+  CacheOutputs(&FirstOutput);
+  CacheTrackOutputs();
+  FirstLine = LineTableSize;
+
+  ChunkStart = Chunk->Start;
+  ChunkEnd = Chunk->End;
+  memset(Result, 0, sizeof(ChunkResult_t));
+  Result->OperandHits = OperandHits;
+  Result->OperandMisses = OperandMisses;
+  StatsChildStart(&Result->Stats);
+  Result->RetVal = Pass(1, InputFilename, OutputFile, &Result->Fatals,
+      &Result->Warnings);
+  StatsChildEnd(&Result->Stats);
+  Result->OperandHits = OperandHits - Result->OperandHits;
+  Result->OperandMisses = OperandMisses - Result->OperandMisses;
+  Result->LinesEvaluated = LinesEvaluated;
+  Result->LinesSkipped = LinesSkipped;
+  Result->Reassigned = numSymbolsReassigned;
+  Result->End = ChunkEndState;
+  GetBankCounts(Result->UsedInBank);
+  Outputs = CacheOutputs(&n);
+  if (n < 0)
+    _exit(1);
+  Result->NumOutputs = n - FirstOutput;
+  for (i = 0; i < 044; i++)
+    for (j = 0; j < 02000; j++)
+      if (ObjectCode[i][j] & OBJECT_WRITTEN)
+        Result->NumCells++;
+  Result->NumLines = LineTableSize - FirstLine;
+
+  fflush(NULL);
+  fwrite(Result, sizeof(ChunkResult_t), 1, Chunk->Results);
+  for (i = FirstOutput; i < n; i++)
+    {
+      j = strlen(Outputs[i]);
+      fwrite(&j, sizeof(int), 1, Chunk->Results);
+      fwrite(Outputs[i], 1, j, Chunk->Results);
+    }
+  memset(&Cell, 0, sizeof(Cell));
+  for (i = 0; i < 044; i++)
+    for (j = 0; j < 02000; j++)
+      if (ObjectCode[i][j] & OBJECT_WRITTEN)
+        {
+          Cell.Bank = i;
+          Cell.Offset = j;
+          Cell.Data = ObjectCode[i][j];
+          fwrite(&Cell, sizeof(Cell), 1, Chunk->Results);
+        }
+  for (i = FirstLine; i < LineTableSize; i++)
+    {
+      GetLine(i, &Line);
+      fwrite(&Line, sizeof(Line), 1, Chunk->Results);
+    }
+  if (fflush(Chunk->Results) || ferror(Chunk->Results))
+    _exit(1);
+  _exit(0);
+}
+
+//-------------------------------------------------------------------------
+// Read back the part of a child's results preceding the object code.
+// Returns 0 on success.
+static int
+ReadResults(Chunk_t *Chunk)
+{
+  ChunkResult_t *Result = &Chunk->Result;
+  int i, n;
+
+  rewind(Chunk->Results);
+  if (1 != fread(Result, sizeof(ChunkResult_t), 1, Chunk->Results))
+    return (1);
+  if (Result->NumOutputs < 0 || Result->NumCells < 0 || Result->NumLines < 0)
+    return (1);
+  Chunk->Outputs = (char **) calloc(Result->NumOutputs + 1, sizeof(char *));
+  if (Chunk->Outputs == NULL)
+    return (1);
+  for (i = 0; i < Result->NumOutputs; i++)
+    {
+      if (1 != fread(&n, sizeof(int), 1, Chunk->Results) || n < 0
+          || n > MAX_LINE_LENGTH)
+        return (1);
+      Chunk->Outputs[i] = (char *) calloc(n + 1, 1);
+      if (Chunk->Outputs[i] == NULL
+          || n != fread(Chunk->Outputs[i], 1, n, Chunk->Results))
+        return (1);
+    }
+  return (0);
+}
+
+// Copy the whole of a temporary file to an output file.
+static void
+CopyCapture(FILE *From, FILE *To)
+{
+  char Buffer[4096];
+  size_t n;
+
+  rewind(From);
+  while (0 < (n = fread(Buffer, 1, sizeof(Buffer), From)))
+    fwrite(Buffer, 1, n, To);
+}
+
+// Get rid of everything having to do with the chunks.
+static void
+FreeChunks(int RemoveOutputs)
+{
+  int i, j;
+
+  for (i = 0; i < NumChunks; i++)
+    {
+      if (Chunks[i].Listing != NULL)
+        fclose(Chunks[i].Listing);
+      if (Chunks[i].Errors != NULL)
+        fclose(Chunks[i].Errors);
+      if (Chunks[i].Html != NULL)
+        fclose(Chunks[i].Html);
+      if (Chunks[i].Results != NULL)
+        fclose(Chunks[i].Results);
+      if (Chunks[i].Outputs != NULL)
+        {
+          for (j = 0; Chunks[i].Outputs[j] != NULL; j++)
+            {
+              if (RemoveOutputs)
+                remove(Chunks[i].Outputs[j]);
+              free(Chunks[i].Outputs[j]);
+            }
+          free(Chunks[i].Outputs);
+        }
+    }
+  free(Chunks);
+  Chunks = NULL;
+  NumChunks = 0;
+}
+
+//-------------------------------------------------------------------------
+// Perform the final pass using up to Processes processes at once.  Returns
+// 0 on success, in which case everything is as though Pass(1, ...) had
+// been called, or 1 if the caller needs to call Pass(1, ...) itself.
+int
+ParallelPass(const char *InputFilename, FILE *OutputFile, int *Fatals,
+    int *Warnings)
+{
+  ChunkCell_t Cell;
+  SymbolLine_t Line;
+  int i, j, Running, Launched, Finished, Status, Ok;
+  unsigned StyleHash;
+  pid_t Pid;
+
+  if (Processes <= 1 || NumPassBoundaries == 0)
+    return (1);
+  if (Html)
+    {
+      if (!HtmlNamesUnique(InputFilename))
+        return (1);
+      // The chunks all start out with the HTML style as it is now.
+      StyleHash = HtmlStyleHash();
+      for (i = 0; i < NumPassBoundaries; i++)
+        if (PassBoundaries[i].StyleHash != StyleHash)
+          return (1);
+    }
+  NumChunks = PlanChunks(4 * Processes);
+  if (NumChunks < 2)
+    {
+      FreeChunks(0);
+      return (1);
+    }
+  for (i = 0; i < NumChunks; i++)
+    {
+      Chunks[i].Listing = tmpfile();
+      Chunks[i].Errors = tmpfile();
+      Chunks[i].Html = tmpfile();
+      Chunks[i].Results = tmpfile();
+      if (Chunks[i].Listing == NULL || Chunks[i].Errors == NULL
+          || Chunks[i].Html == NULL || Chunks[i].Results == NULL)
+        {
+          FreeChunks(0);
+          return (1);
+        }
+    }
+
+  // Run the children, no more than Processes of them at a time.
+  fflush(NULL);
+  Running = Launched = Finished = 0;
+  while (Finished < NumChunks)
+    {
+      while (Running < Processes && Launched < NumChunks)
+        {
+          Pid = fork();
+          if (Pid == 0)
+            RunChunk(&Chunks[Launched], InputFilename, OutputFile);
+          Chunks[Launched].Pid = Pid;
+          if (Pid < 0)
+            Finished++;
+          else
+            Running++;
+          Launched++;
+        }
+      if (Running == 0)
+        continue;
+      Pid = wait(&Status);
+      if (Pid < 0)
+        break;
+      for (i = 0; i < NumChunks; i++)
+        if (Chunks[i].Pid == Pid)
+          {
+            Chunks[i].Ok = WIFEXITED(Status) && WEXITSTATUS(Status) == 0;
+            Running--;
+            Finished++;
+            break;
+          }
+    }
+
+  // Check that the chunks fit together.
+  Ok = (Finished == NumChunks);
+  for (i = 0; i < NumChunks; i++)
+    {
+      if (!Chunks[i].Ok || ReadResults(&Chunks[i]))
+        {
+          Ok = 0;
+          continue;
+        }
+      if (Chunks[i].Result.RetVal != 0 || Chunks[i].Result.Reassigned != 0)
+        Ok = 0;
+      if (Chunks[i].Next != NULL
+          && memcmp(&Chunks[i].Result.End, Chunks[i].Next,
+              sizeof(PassBoundary_t)))
+        Ok = 0;
+    }
+  if (!Ok)
+    {
+      FreeChunks(1);
+      return (1);
+    }
+
+  // Paste them together.
+  *Fatals = *Warnings = 0;
+  LinesEvaluated = LinesSkipped = 0;
+  if (ClearObjectCode())
+    {
+      FreeChunks(1);
+      (*Fatals)++;
+      return (0);
+    }
+  for (i = 0; i < NumChunks; i++)
+    {
+      CopyCapture(Chunks[i].Listing, stdout);
+      CopyCapture(Chunks[i].Errors, stderr);
+      if (HtmlOut != NULL)
+        CopyCapture(Chunks[i].Html, HtmlOut);
+      for (j = 0; j < Chunks[i].Result.NumCells; j++)
+        {
+          if (1 != fread(&Cell, sizeof(Cell), 1, Chunks[i].Results)
+              || Cell.Bank < 0 || Cell.Bank >= 044 || Cell.Offset < 0
+              || Cell.Offset >= 02000)
+            break;
+          ObjectCode[Cell.Bank][Cell.Offset] = Cell.Data;
+        }
+      for (j = 0; j < Chunks[i].Result.NumLines; j++)
+        {
+          if (1 != fread(&Line, sizeof(Line), 1, Chunks[i].Results))
+            break;
+          AddLine(&Line.CodeAddress, Line.FileName, Line.LineNumber);
+        }
+      for (j = 0; j < Chunks[i].Result.NumOutputs; j++)
+        CacheNoteOutput(Chunks[i].Outputs[j]);
+      *Fatals += Chunks[i].Result.Fatals;
+      *Warnings += Chunks[i].Result.Warnings;
+      OperandHits += Chunks[i].Result.OperandHits;
+      OperandMisses += Chunks[i].Result.OperandMisses;
+      LinesEvaluated += Chunks[i].Result.LinesEvaluated;
+      LinesSkipped += Chunks[i].Result.LinesSkipped;
+      StatsChildAdd(&Chunks[i].Result.Stats);
+    }
+
+  // Leave things as the final pass would have.
+  SaveUsedCounts();
+  SetBankCounts(Chunks[NumChunks - 1].Result.UsedInBank);
+  numSymbolsReassigned = 0;
+  thisIsTheLastPass = 1;
+  inHeader = 0;
+  FreeChunks(0);
+  return (0);
+}
+
+#endif // MSC_VS
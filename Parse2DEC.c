@@ -38,33 +38,130 @@
                                spills over into the Extra field. Fix handling
                                of numbers where the exponents are all in the
                                operand field.
+                2026-10-17 AGT Replaced pow() in ScaleFactor() by tables of
+                               exact powers, and strtod() by the
+                               single-pass GetDecimal() where it can be
+                               done exactly.
+                2026-10-17 AGT GetDecimal() is global, so that
+                               bench/check-numbers.c can check it.
  */
 
 #include "yaYUL.h"
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <ctype.h>
+
+//-------------------------------------------------------------------------
+// Powers of ten and two, all of which are computed by the compiler.  Every
+// power of two is exact, as are the powers of ten up to 1E22; the negative
+// powers of ten are rounded from the literal, just as pow() rounds them.
+
+#define MAX_POW10 22
+#define MAX_POW2 63
+static const double Pow10[2 * MAX_POW10 + 1] =
+  { 1E-22, 1E-21, 1E-20, 1E-19, 1E-18, 1E-17, 1E-16, 1E-15, 1E-14, 1E-13,
+    1E-12, 1E-11, 1E-10, 1E-9, 1E-8, 1E-7, 1E-6, 1E-5, 1E-4, 1E-3, 1E-2,
+    1E-1, 1E0, 1E1, 1E2, 1E3, 1E4, 1E5, 1E6, 1E7, 1E8, 1E9, 1E10, 1E11,
+    1E12, 1E13, 1E14, 1E15, 1E16, 1E17, 1E18, 1E19, 1E20, 1E21, 1E22 };
+
+#define P2(n) ((double) (1ULL << (n)))
+#define P2S(n) 1.0 / P2(n), 1.0 / P2(n - 1), 1.0 / P2(n - 2), 1.0 / P2(n - 3)
+#define P2U(n) P2(n), P2(n + 1), P2(n + 2), P2(n + 3)
+static const double Pow2[2 * MAX_POW2 + 1] =
+  { P2S(63), P2S(59), P2S(55), P2S(51), P2S(47), P2S(43), P2S(39), P2S(35),
+    P2S(31), P2S(27), P2S(23), P2S(19), P2S(15), P2S(11), P2S(7),
+    1.0 / P2(3), 1.0 / P2(2), 1.0 / P2(1),
+    P2U(0), P2U(4), P2U(8), P2U(12), P2U(16), P2U(20), P2U(24), P2U(28),
+    P2U(32), P2U(36), P2U(40), P2U(44), P2U(48), P2U(52), P2U(56),
+    P2(60), P2(61), P2(62), P2(63) };
+#undef P2S
+#undef P2U
+#undef P2
 
 //-------------------------------------------------------------------------
 // Converts a string like "E+-n" or "B+-n" to a scale factor.
 double ScaleFactor(char *s)
 {
-    int n;
+    const char *ss;
+    int n, Negative;
 
-    if (*s == 0)
+    if (*s != 'E' && *s != 'B')
         return (1.0);
 
-    if (*s == 'E') {
+    // The exponent, as atoi() would read it.  Anything atoi() might treat
+    // differently, like leading spaces or a huge number, is left to it.
+    ss = s + 1;
+    Negative = 0;
+    if (*ss == '+' || *ss == '-')
+        Negative = (*ss++ == '-');
+    for (n = 0; *ss >= '0' && *ss <= '9' && n <= 1000; ss++)
+        n = n * 10 + (*ss - '0');
+    if (n > 1000 || isspace((unsigned char) *ss))
         n = atoi(s + 1);
-        return (pow(10.0, n));
-    }
+    else if (Negative)
+        n = -n;
 
-    if (*s == 'B') {
-        n = atoi(s + 1);
-        return (pow(2.0, n));
-    }
+    if (*s == 'E')
+        return ((n >= -MAX_POW10 && n <= MAX_POW10) ? Pow10[n + MAX_POW10] : pow(10.0, n));
+    return ((n >= -MAX_POW2 && n <= MAX_POW2) ? Pow2[n + MAX_POW2] : pow(2.0, n));
+}
+
+//-------------------------------------------------------------------------
+// Reads a decimal number like strtod(s, NULL), but in a single pass.  When
+// there are no more than 19 significant digits, the digits form an integer
+// of at most 2**53, and the power of ten is within the range of Pow10[],
+// both are exact as doubles and a single multiplication or division gives
+// the correctly-rounded result, as strtod() does.  Anything else, including
+// the hexadecimal, infinite and NaN forms of strtod(), is handed to strtod().
+double GetDecimal(const char *s)
+{
+    const char *ss = s;
+    unsigned long long Mantissa = 0;
+    int Negative = 0, Significant = 0, Digits = 0, Exponent = 0;
+    int e, ExponentNegative;
+    double x;
 
-    return (1.0);
+    if (*ss == '+' || *ss == '-')
+        Negative = (*ss++ == '-');
+    for (; *ss >= '0' && *ss <= '9'; ss++, Digits++)
+        if (Mantissa || *ss != '0') {
+            Mantissa = Mantissa * 10 + (*ss - '0');
+            if (++Significant > 19)
+                return (strtod(s, NULL));
+        }
+    if (*ss == '.')
+        for (ss++; *ss >= '0' && *ss <= '9'; ss++, Digits++) {
+            Exponent--;
+            if (Mantissa || *ss != '0') {
+                Mantissa = Mantissa * 10 + (*ss - '0');
+                if (++Significant > 19)
+                    return (strtod(s, NULL));
+            }
+        }
+    if (!Digits)
+        return (strtod(s, NULL));
+    if (*ss == 'E' || *ss == 'e') {
+        ss++;
+        ExponentNegative = 0;
+        if (*ss == '+' || *ss == '-')
+            ExponentNegative = (*ss++ == '-');
+        if (*ss < '0' || *ss > '9')
+            return (strtod(s, NULL));
+        for (e = 0; *ss >= '0' && *ss <= '9' && e <= 1000; ss++)
+            e = e * 10 + (*ss - '0');
+        Exponent += ExponentNegative ? -e : e;
+    }
+    if (*ss != 0 || Mantissa > (1ULL << 53)
+            || Exponent < -MAX_POW10 || Exponent > MAX_POW10)
+        return (strtod(s, NULL));
+
+    x = (double) Mantissa;
+    if (Exponent < 0)
+        x /= Pow10[MAX_POW10 - Exponent];
+    else
+        x *= Pow10[MAX_POW10 + Exponent];
+    return (Negative ? -x : x);
 }
 
 //-------------------------------------------------------------------------
@@ -160,7 +257,7 @@ int Parse2DEC(ParseInput_t *InRecord, ParseOutput_t *OutRecord)
                 }
             }
             strcpy(tmpoperand, InRecord->Operand);
-            tmpval = strtod(tmpoperand, NULL);
+            tmpval = GetDecimal(tmpoperand);
             ptmpmod1 = tmpmod1;
             ptmpmod2 = tmpmod2;
         } else {
@@ -188,7 +285,7 @@ int Parse2DEC(ParseInput_t *InRecord, ParseOutput_t *OutRecord)
                     ptmpmod2 = InRecord->Mod2;
                 }
             }
-            tmpval = strtod(InRecord->Operand, NULL);
+            tmpval = GetDecimal(InRecord->Operand);
         }
     }
 
@@ -298,7 +395,7 @@ int ParseDEC(ParseInput_t *InRecord, ParseOutput_t *OutRecord)
         tmpmod1 = InRecord->Operand;
         tmpmod2 = InRecord->Mod1;
     } else {
-        tmpval = strtod(InRecord->Operand, NULL);
+        tmpval = GetDecimal(InRecord->Operand);
         tmpmod1 = InRecord->Mod1;
         tmpmod2 = InRecord->Mod2;
     }
@@ -23,6 +23,10 @@
                 06/28/09 RSB    Added HTML output.
                 09/07/09 JL     Fixed typo in PrintBankCounts.
                 08/21/16 RSB    Adapted for --block1.
+                2026-10-17 AGT  Lines which use the bank counts are marked
+                                as volatile for Resolve.c.
+                2026-10-17 AGT  Added GetBankCounts() and SetBankCounts().
+                2026-10-17 AGT  Added BankCountsChanged().
 
   I'm not actually certain what the BANK pseudo-op is supposed to do with 
   the banks in super-bank 1.  I allow those to be accepted, as bank 
@@ -38,8 +42,8 @@
 // each bank.   
 
 #define NUM_FIXED_BANKS 044
-static int PriorPassUsedInBank[NUM_FIXED_BANKS] = { 0 };
-static int UsedInBank[NUM_FIXED_BANKS] = { 0 };
+static ASSEMBLY int PriorPassUsedInBank[NUM_FIXED_BANKS] = { 0 };
+static ASSEMBLY int UsedInBank[NUM_FIXED_BANKS] = { 0 };
 
 void SaveUsedCounts(void)
 {
@@ -47,6 +51,7 @@ void SaveUsedCounts(void)
 }
 int GetPriorBankCount(int bank)
 {
+    ResolveVolatile();
     if (bank < 0 || bank >= NUM_FIXED_BANKS)
         return (0);
 
@@ -63,10 +68,30 @@ void StartBankCounts(void)
         UsedInBank[i] = 0;
 }
 
+//------------------------------------------------------------------------
+// Save or restore the entire UsedInBank array, which must be NUM_FIXED_BANKS
+// (044) long.  Used by ParallelPass.c.
+void GetBankCounts(int *Counts)
+{
+    memcpy(Counts, UsedInBank, sizeof(UsedInBank));
+}
+
+void SetBankCounts(const int *Counts)
+{
+    memcpy(UsedInBank, Counts, sizeof(UsedInBank));
+}
+
+// Have the usage counts changed since the end of the preceding pass?
+int BankCountsChanged(void)
+{
+    return (0 != memcmp(PriorPassUsedInBank, UsedInBank, sizeof(UsedInBank)));
+}
+
 //------------------------------------------------------------------------
 // Check bank count.
 int GetBankCount(int bank)
 {
+    ResolveVolatile();
     if (bank < 0 || bank >= NUM_FIXED_BANKS)
         return (0);
 
@@ -79,14 +104,15 @@ void PrintBankCounts(void)
 {
     int i;
 
-    printf("Usage Table for Fixed-Memory Banks\n");
-    printf("----------------------------------\n");
+    fprintf(LISTING, "Usage Table for Fixed-Memory Banks\n");
+    fprintf(LISTING, "----------------------------------\n");
 
     if (HtmlOut != NULL)
         fprintf (HtmlOut, "<h1>Usage Table for Fixed-Memory Banks</h1>\n");
 
     for (i = (Block1 ? 1 : 0); i < (Block1 ? 035 : NUM_FIXED_BANKS); i++) {
-        printf("Bank %02o:  %04o/2000 words used.\n", i, UsedInBank[i]);
+        fprintf(LISTING, "Bank %02o:  %04o/2000 words used.\n", i,
+            UsedInBank[i]);
         if (HtmlOut != NULL)
             fprintf(HtmlOut, "Bank %02o:  %04o/2000 words used.\n", i, UsedInBank[i]);
     }
@@ -147,6 +173,7 @@ ParseSECSIZ(ParseInput_t *InRecord, ParseOutput_t *OutRecord)
   unsigned sectionSize;
   Address_t *pc;
 
+  ResolveVolatile();
   if (1 != sscanf (InRecord->Operand, "%o", &sectionSize) || sectionSize == 0)
     goto error;
 
@@ -216,6 +243,8 @@ ParseBANK(ParseInput_t *InRecord, ParseOutput_t *OutRecord)
 {
     int Value, i;
 
+    ResolveVolatile();
+
     // Pass EXTEND through.
     OutRecord->Extend = InRecord->Extend;
 
@@ -27,8 +27,8 @@
 #include <stdlib.h>
 #include <string.h>
 
-extern Line_t CurrentFilename;
-extern int CurrentLineInFile;
+extern ASSEMBLY Line_t CurrentFilename;
+extern ASSEMBLY int CurrentLineInFile;
 
 //------------------------------------------------------------------------
 // Return 0 on success.
@@ -49,7 +49,7 @@ int ParseCHECKequals(ParseInput_t *InRecord, ParseOutput_t *OutRecord)
     }
   else
     {
-      Symbol_t *labelSymbol = GetSymbol(InRecord->Label);
+      Address_t *labelSymbol = GetSymbol(InRecord->Label);
       if (labelSymbol == NULL)
         {
           sprintf(OutRecord->ErrorMessage, "Symbol \"%s\" not defined, skipping...", InRecord->Label);
@@ -58,7 +58,7 @@ int ParseCHECKequals(ParseInput_t *InRecord, ParseOutput_t *OutRecord)
         }
       else
         {
-          labelValue = labelSymbol->Value;
+          labelValue = *labelSymbol;
           lhValue = labelValue.Value;
           lhValid = 1;
         } 
@@ -35,6 +35,8 @@
  *                              found some places in SUNBURST.  However, I
  *               01/29/17 MAS   Added an address calculation tweak for
  *                              the --raytheon option.
+ *               2026-10-17 AGT Operands are looked up in the cache kept by
+ *                              Resolve.c before being worked out.
  */
 
 #include "yaYUL.h"
@@ -46,8 +48,8 @@
 // need the current file name and line number of the symbol, so i take the
 // global variables in Pass.c. I am being lazy here, I probably should
 // include this information in InputRecord_t.
-extern Line_t CurrentFilename;
-extern int CurrentLineInFile;
+extern ASSEMBLY Line_t CurrentFilename;
+extern ASSEMBLY int CurrentLineInFile;
 
 //------------------------------------------------------------------------
 // Fetch a symbol value, possibly with offset.  Return 0 on success.
@@ -58,44 +60,80 @@ extern int CurrentLineInFile;
 // offsets --- such as converting one operand type to another.  Therefore,
 // I now simply put the offset into a global variable, where it is 
 // eventually added to the already-processed opcode+operand.  
+// ... Later still:  Since the same line almost always comes out the same way
+// in the next pass, what was found is kept in the line's operand cache (see
+// Resolve.c), and is simply reused as long as the operand is the same and
+// the symbol hasn't changed.
 int
 FetchSymbolPlusOffset(Address_t *pc, char *Operand, char *Mod1,
     Address_t *Value)
 {
-  Symbol_t *Symbol;
+  Address_t *Symbol;
   Address_t dummyAddress;
-  int i, Offset;
+  OperandCache_t *Cache;
+  int i, Offset, Number, Hit;
+
+  Cache = ResolveOperandCache(Operand, Mod1, &Hit);
+  if (Hit)
+    {
+      if (Cache->IsNumber)
+        {
+          IncPc(pc, Cache->Offset, Value);
+          return (0);
+        }
+      ResolveNoteRead(Cache->Symbol);
+      *Value = Cache->Value;
+      if (Block1 && Cache->HasOffset)
+        OpcodeOffset = Cache->Offset;
+      return (0);
+    }
 
   i = GetOctOrDec(Operand, &Offset);
   if (!i)
     {
+      if (Cache != NULL)
+        {
+          Cache->IsNumber = 1;
+          Cache->Offset = Offset;
+          Cache->Filled = 1;
+        }
       IncPc(pc, Offset, Value);
       return (0);
     }
   Value->Invalid = 1;
-  Symbol = GetSymbol(Operand);
+  Symbol = GetNumberedSymbol(Operand, &Number);
   if (Symbol == NULL)
     return (1);
-  *Value = Symbol->Value;
+  *Value = *Symbol;
   i = GetOctOrDec(Mod1, &Offset);
   if (!i)
     {
       if (Block1)
         {
-          //IncPc (&Symbol->Value, Offset, Value);
+          //IncPc (Symbol, Offset, Value);
           OpcodeOffset = Offset;
           // I'm not sure how to treat very big offsets.  Empirically, this works.
           if (OpcodeOffset >= 0)
             OpcodeOffset &= 07777;
           else
             OpcodeOffset = -(07777 & -OpcodeOffset);
+          Offset = OpcodeOffset;
         }
       else
         {
-          PseudoToStruct(Symbol->Value.Value + Offset, &dummyAddress);
+          PseudoToStruct(Symbol->Value + Offset, &dummyAddress);
           *Value = dummyAddress;
         }
     }
+  if (Cache != NULL)
+    {
+      Cache->IsNumber = 0;
+      Cache->HasOffset = !i;
+      Cache->Symbol = Number;
+      Cache->Offset = Offset;
+      Cache->Value = *Value;
+      Cache->Filled = 1;
+    }
   return (0);
 }
 
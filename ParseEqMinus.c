@@ -32,8 +32,8 @@
 // need the current file name and line number of the symbol, so i take the
 // global variables in Pass.c. I am being lazy here, I probably should
 // include this information in InputRecord_t.
-extern Line_t CurrentFilename;
-extern int CurrentLineInFile;
+extern ASSEMBLY Line_t CurrentFilename;
+extern ASSEMBLY int CurrentLineInFile;
 
 //------------------------------------------------------------------------
 // Return 0 on success.
@@ -27,8 +27,8 @@
 #include <stdlib.h>
 #include <string.h>
 
-extern Line_t CurrentFilename;
-extern int CurrentLineInFile;
+extern ASSEMBLY Line_t CurrentFilename;
+extern ASSEMBLY int CurrentLineInFile;
 
 int ParseEqualsECADR(ParseInput_t *InRecord, ParseOutput_t *OutRecord)
 {
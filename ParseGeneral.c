@@ -46,7 +46,7 @@
 #include <stdlib.h>
 #include <string.h>
 
-int KeepExtend = 0;
+ASSEMBLY int KeepExtend = 0;
 
 //------------------------------------------------------------------------
 // A sort of generalized parser that works for most instruction types.
@@ -37,7 +37,7 @@
 int ParseSETLOC(ParseInput_t *InRecord, ParseOutput_t *OutRecord)
 {
     int Value, i;
-    Symbol_t *Symbol;
+    Address_t *Symbol;
 
     OutRecord->ProgramCounter = InRecord->ProgramCounter;
     OutRecord->SBank= InRecord->SBank;
@@ -95,7 +95,7 @@ int ParseSETLOC(ParseInput_t *InRecord, ParseOutput_t *OutRecord)
                 OutRecord->ProgramCounter.Invalid = 1;
             }
         } else {
-            OutRecord->ProgramCounter = Symbol->Value;
+            OutRecord->ProgramCounter = *Symbol;
         }
     }
 
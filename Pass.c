@@ -121,6 +121,48 @@
  *             			The result is that --block1 assembly was working essentially by
  *             			accident, and similarly was failing by accident in Mac OS X.
  *            	2018-10-12 RSB	Added --simulation stuff.
+ *              2026-10-17 AGT  Source files are now read only once, and the
+ *                              tab-expansion, comment-splitting and field-
+ *                              splitting of each line is done only on the
+ *                              first pass; later passes replay the cached
+ *                              line records (see SourceLines.c).
+ *              2026-10-17 AGT  In the symbol-resolution passes, lines whose
+ *                              inputs haven't changed since the preceding
+ *                              pass are skipped (see Resolve.c).  The state
+ *                              carried from line to line, which used to be
+ *                              local to Pass(), is now static so that it
+ *                              can be saved and restored.
+ *              2026-10-17 AGT  Operators are looked up in a perfect hash
+ *                              table rather than by bsearch().
+ *              2026-10-17 AGT  Added LookUpOperator(), for timing the
+ *                              operator lookups.
+ *              2026-10-17 AGT  ObjectCode[] is allocated by ClearObjectCode()
+ *                              rather than being a thread-local array.
+ *              2026-10-17 AGT  The symbol-resolution passes note the state at
+ *                              each $ directive of the top-level file, and the
+ *                              output pass can be limited to a range of lines
+ *                              of the top-level file, for ParallelPass.c.
+ *              2026-10-17 AGT  Added SortAllOperators().
+ *              2026-10-17 AGT  The state of the assembly is thread-local
+ *                              (ASSEMBLY).  Added ClearPass().
+ *              2026-10-17 AGT  Overlong lines are no longer split into
+ *                              several lines, but truncated with a warning.
+ *              2026-10-17 AGT  The --block1 column-16 test uses the column
+ *                              found by the tokenizer.
+ *              2026-10-17 AGT  The first pass defines the symbols as it goes,
+ *                              when DiscoveringSymbols is set.
+ *              2026-10-17 AGT  The boundaries include the line count kept
+ *                              by Resolve.c for the operand cache.
+ *              2026-10-17 AGT  Only the front of the parse records is reset
+ *                              for each line, and lastLines[] is a ring.
+ *              2026-10-17 AGT  ObjectCode[] is 16 bits per word, with the
+ *                              parity left for Rope.c to work out, and is
+ *                              cleared only for the pass which writes it.
+ *              2026-10-17 AGT  Pass() returns -1, rather than exiting, if
+ *                              there's no memory for the operator table.
+ *              2026-10-17 AGT  Back to comparing the text at column 16 for
+ *                              the --block1 column-16 test, since a field
+ *                              which merely starts there isn't the same.
  *
  * I don't really try to duplicate the formatting used by the original
  * assembly-language code, since that format was appropriate for
@@ -155,40 +197,40 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <stddef.h>
 
 //-------------------------------------------------------------------------
 // Some global data.
 
-Line_t CurrentFilename;
-int CurrentLineInFile = 0;
-int thisIsTheLastPass = 0;
+ASSEMBLY Line_t CurrentFilename;
+ASSEMBLY int CurrentLineInFile = 0;
+ASSEMBLY int thisIsTheLastPass = 0;
 
 // We allow a certain number of levels of include files.  To handle this,
 // we need a stack of input files.
 #define MAX_STACKED_INCLUDES 5
-static int NumStackedIncludes = 0;
+static ASSEMBLY int NumStackedIncludes = 0;
 typedef struct
 {
-  FILE *InputFile;
+  SourceCursor_t InputFile;
   Line_t InputFilename;
   int CurrentLineInFile;
   FILE *HtmlOut;
-  int yulType; // 0 for .agc, 1 for .yul.
 } StackedInclude_t;
-static StackedInclude_t StackedIncludes[MAX_STACKED_INCLUDES];
+static ASSEMBLY StackedInclude_t StackedIncludes[MAX_STACKED_INCLUDES];
 
 // Some dummy strings for parsing an input line.
-static Line_t Fields[6];
-static int NumFields = 0;
-
-char *assemblyTarget = "AGC4";
-int Block1 = 0;
-int EarlySBank = 0;
-int Raytheon = 0;
-int blk2 = 0;
-int Html = 0;
-FILE *HtmlOut = NULL;
-int inHeader = 1;
+static ASSEMBLY Line_t Fields[6];
+static ASSEMBLY int NumFields = 0;
+
+ASSEMBLY char *assemblyTarget = "AGC4";
+ASSEMBLY int Block1 = 0;
+ASSEMBLY int EarlySBank = 0;
+ASSEMBLY int Raytheon = 0;
+ASSEMBLY int blk2 = 0;
+ASSEMBLY int Html = 0;
+ASSEMBLY FILE *HtmlOut = NULL;
+ASSEMBLY int inHeader = 1;
 
 // Data structure used to map opcode or pseudo-op names to function calls.
 // Basically, for each opcode or pseudo-op, there is an external
@@ -515,8 +557,8 @@ static ParserMatch_t ParsersBlock1[] =
     { "XCH", OP_BASIC, ParseXCH } };
 #define NUM_PARSERS_BLOCK1 (sizeof (ParsersBlock1) / sizeof (ParsersBlock1[0]))
 
-static ParserMatch_t *Parsers = ParsersBlock2;
-static int NUM_PARSERS = NUM_PARSERS_BLOCK2;
+static ASSEMBLY ParserMatch_t *Parsers = ParsersBlock2;
+static ASSEMBLY int NUM_PARSERS = NUM_PARSERS_BLOCK2;
 
 // This is the default table of interpreter instructions, and
 // is the one used for all Block 2 software except the BLK2 target
@@ -1214,18 +1256,33 @@ static InterpreterMatch_t InterpreterOpcodesBlock1[] =
     { "XSU,2", 0072 } };
 #define NUM_INTERPRETERS_BLOCK1 (sizeof (InterpreterOpcodesBlock1) / sizeof (InterpreterOpcodesBlock1[0]))
 
-static InterpreterMatch_t *InterpreterOpcodes = InterpreterOpcodesBlock2;
-static int NUM_INTERPRETERS = NUM_INTERPRETERS_BLOCK2;
-
-// Buffer for binary data.
-int ObjectCode[044][02000];
-unsigned char Parities[044][02000];
-
-int NumInterpretiveOperands = 0, RawNumInterpretiveOperands;
-int nnnnFields[4];
-unsigned char SwitchIncrement[4], SwitchInvert[4];
-int OpcodeOffset;
-int ArgType = 0;
+static ASSEMBLY InterpreterMatch_t *InterpreterOpcodes = InterpreterOpcodesBlock2;
+static ASSEMBLY int NUM_INTERPRETERS = NUM_INTERPRETERS_BLOCK2;
+
+// Buffer for binary data, 044 banks of 02000 words.  It's allocated by
+// ClearObjectCode(), rather than being an array, because it's much larger
+// than the rest of the thread-local state put together.
+ASSEMBLY uint16_t (*ObjectCode)[02000] = NULL;
+
+// The state at each $ directive in the top-level file, as of the last
+// call to Pass(0), and the total number of lines assembled.
+ASSEMBLY PassBoundary_t *PassBoundaries = NULL;
+ASSEMBLY int NumPassBoundaries = 0, PassTotalLines = 0;
+static ASSEMBLY int MaxPassBoundaries = 0;
+
+// If ChunkEnd isn't -1, Pass(1) processes only the part of the top-level
+// file (along with whatever it includes) from the boundary ChunkStart (or
+// from the beginning, if NULL) up to line ChunkEnd, and leaves the state
+// at that point in ChunkEndState.
+ASSEMBLY const PassBoundary_t *ChunkStart = NULL;
+ASSEMBLY int ChunkEnd = -1;
+ASSEMBLY PassBoundary_t ChunkEndState;
+
+ASSEMBLY int NumInterpretiveOperands = 0, RawNumInterpretiveOperands;
+ASSEMBLY int nnnnFields[4];
+ASSEMBLY unsigned char SwitchIncrement[4], SwitchInvert[4];
+ASSEMBLY int OpcodeOffset;
+ASSEMBLY int ArgType = 0;
 
 //-------------------------------------------------------------------------
 // Add an opcode to OpcodeOffset.
@@ -1258,7 +1315,7 @@ SortParsers(void)
 }
 
 static ParserMatch_t *
-FindParser(const char *Name)
+SearchParsers(const char *Name)
 {
   ParserMatch_t Key;
   strncpy(Key.Name, Name, MAX_LABEL_LENGTH);
@@ -1291,8 +1348,36 @@ SortInterpreters(void)
     }
 }
 
+// Sort the operator arrays for every target at once, before any of them
+// has been selected.  Used by Library.c, so that all of the assemblies in
+// the process can share the sorted arrays.
+void
+SortAllOperators(void)
+{
+  if (!ParsersSorted)
+    {
+      ParsersSorted = 1;
+      qsort(ParsersBlock2, NUM_PARSERS_BLOCK2, sizeof(ParsersBlock2[0]),
+          CompareParsers);
+      qsort(ParsersBLK2, NUM_PARSERS_BLK2, sizeof(ParsersBLK2[0]),
+          CompareParsers);
+      qsort(ParsersBlock1, NUM_PARSERS_BLOCK1, sizeof(ParsersBlock1[0]),
+          CompareParsers);
+    }
+  if (!InterpretersSorted)
+    {
+      InterpretersSorted = 1;
+      qsort(InterpreterOpcodesBlock2, NUM_INTERPRETERS_BLOCK2,
+          sizeof(InterpreterOpcodesBlock2[0]), CompareInterpreters);
+      qsort(InterpreterOpcodesBLK2, NUM_INTERPRETERS_BLK2,
+          sizeof(InterpreterOpcodesBLK2[0]), CompareInterpreters);
+      qsort(InterpreterOpcodesBlock1, NUM_INTERPRETERS_BLOCK1,
+          sizeof(InterpreterOpcodesBlock1[0]), CompareInterpreters);
+    }
+}
+
 static InterpreterMatch_t *
-FindInterpreter(const char *Name)
+SearchInterpreters(const char *Name)
 {
   InterpreterMatch_t Key;
 
@@ -1303,6 +1388,245 @@ FindInterpreter(const char *Name)
       sizeof(InterpreterOpcodes[0]), CompareInterpreters));
 }
 
+//-------------------------------------------------------------------------
+// Operator names are looked up several times for every line of every pass,
+// so rather than searching the sorted Parsers and InterpreterOpcodes arrays
+// each time, we use a perfect hash table covering the operators of both
+// arrays for the selected target.  Each slot holds a name, along with the
+// ParserMatch_t and InterpreterMatch_t entries for it (either of which may
+// be NULL), so a single probe gives both.  The table is built once, after
+// the arrays have been sorted, by the "hash and displace" method:  the
+// names are first hashed into buckets, and each bucket then gets its own
+// hash seed, chosen so that its names land in slots not already used.
+typedef struct
+{
+  char Name[MAX_LABEL_LENGTH + 1];      // Empty if the slot is unused.
+  ParserMatch_t *Parser;
+  InterpreterMatch_t *Interpreter;
+} OperatorMatch_t;
+
+static ASSEMBLY OperatorMatch_t *Operators = NULL;
+static ASSEMBLY unsigned *OperatorSeeds = NULL;
+static ASSEMBLY unsigned OperatorMask = 0, NumOperatorBuckets = 0;
+
+// Only the first MAX_LABEL_LENGTH characters of the name are significant,
+// as they were for the bsearch() lookups.
+static unsigned
+HashOperator(const char *Name, unsigned Seed)
+{
+  unsigned Hash = 2166136261u ^ (Seed * 0x9E3779B9u);
+  int i;
+
+  for (i = 0; i < MAX_LABEL_LENGTH && Name[i]; i++)
+    Hash = (Hash ^ (unsigned char) Name[i]) * 16777619u;
+  return (Hash ^ (Hash >> 15));
+}
+
+// Returns 0 on success, or non-zero if memory runs out.
+static int
+BuildOperatorTable(void)
+{
+  const char **Names;
+  int *Buckets, *Counts = NULL, NumNames = 0, i, j, k, n;
+  unsigned Size, Seed;
+
+  if (Operators != NULL)
+    return (0);
+
+  // Collect the distinct names.
+  Names = (const char **) malloc((NUM_PARSERS + NUM_INTERPRETERS)
+      * sizeof(char *));
+  Buckets = (int *) malloc((NUM_PARSERS + NUM_INTERPRETERS) * sizeof(int));
+  if (Names == NULL || Buckets == NULL)
+    goto OutOfMemory;
+  for (i = 0; i < NUM_PARSERS + NUM_INTERPRETERS; i++)
+    {
+      const char *Name;
+      Name = (i < NUM_PARSERS) ? Parsers[i].Name :
+          InterpreterOpcodes[i - NUM_PARSERS].Name;
+      for (j = 0; j < NumNames; j++)
+        if (!strcmp(Names[j], Name))
+          break;
+      if (j == NumNames)
+        Names[NumNames++] = Name;
+    }
+
+  for (Size = 64; Size < 2 * NumNames; Size *= 2)
+    ;
+  OperatorMask = Size - 1;
+  NumOperatorBuckets = Size / 2;
+  Operators = (OperatorMatch_t *) calloc(Size, sizeof(OperatorMatch_t));
+  OperatorSeeds = (unsigned *) calloc(NumOperatorBuckets, sizeof(unsigned));
+  Counts = (int *) calloc(NumOperatorBuckets, sizeof(int));
+  if (Operators == NULL || OperatorSeeds == NULL || Counts == NULL)
+    goto OutOfMemory;
+  for (i = 0; i < NumNames; i++)
+    {
+      Buckets[i] = HashOperator(Names[i], 0) % NumOperatorBuckets;
+      Counts[Buckets[i]]++;
+    }
+
+  // Place the buckets, the most crowded first.
+  for (n = NumNames; n > 0; n--)
+    for (k = 0; k < NumOperatorBuckets; k++)
+      {
+        if (Counts[k] != n)
+          continue;
+        for (Seed = 1;; Seed++)
+          {
+            // Do the names in this bucket all go into distinct empty slots?
+            for (i = 0; i < NumNames; i++)
+              if (Buckets[i] == k)
+                {
+                  OperatorMatch_t *Slot;
+                  Slot = &Operators[HashOperator(Names[i], Seed) & OperatorMask];
+                  if (Slot->Name[0] != 0)
+                    break;
+                  strcpy(Slot->Name, Names[i]);
+                }
+            if (i == NumNames)
+              break;
+            // No, so take them back out and try another seed.
+            for (j = 0; j < i; j++)
+              if (Buckets[j] == k)
+                Operators[HashOperator(Names[j], Seed) & OperatorMask].Name[0] =
+                    0;
+          }
+        OperatorSeeds[k] = Seed;
+      }
+
+  // Where names are duplicated, use the same entries bsearch() finds.
+  for (i = 0; i <= OperatorMask; i++)
+    if (Operators[i].Name[0] != 0)
+      {
+        Operators[i].Parser = SearchParsers(Operators[i].Name);
+        Operators[i].Interpreter = SearchInterpreters(Operators[i].Name);
+      }
+
+  free(Names);
+  free(Buckets);
+  free(Counts);
+  return (0);
+
+  OutOfMemory:
+  fprintf(LISTING, "Out of memory (6).\n");
+  free(Names);
+  free(Buckets);
+  free(Counts);
+  free(Operators);
+  free(OperatorSeeds);
+  Operators = NULL;
+  OperatorSeeds = NULL;
+  return (1);
+}
+
+// Release the operator table and the recorded boundaries, at the end of an
+// assembly.
+void
+ClearPass(void)
+{
+  free(Operators);
+  free(OperatorSeeds);
+  Operators = NULL;
+  OperatorSeeds = NULL;
+  OperatorMask = NumOperatorBuckets = 0;
+  free(PassBoundaries);
+  PassBoundaries = NULL;
+  NumPassBoundaries = MaxPassBoundaries = 0;
+  free(ObjectCode);
+  ObjectCode = NULL;
+}
+
+//-------------------------------------------------------------------------
+// Allocate ObjectCode[] if it hasn't been already, and empty it.  Returns
+// 0 on success, or non-zero if out of memory.
+int
+ClearObjectCode(void)
+{
+  if (ObjectCode == NULL)
+    ObjectCode = (uint16_t (*)[02000]) malloc(044 * sizeof(*ObjectCode));
+  if (ObjectCode == NULL)
+    {
+      fprintf(LISTING, "Out of memory (11).\n");
+      return (1);
+    }
+  memset(ObjectCode, 0, 044 * sizeof(*ObjectCode));
+  return (0);
+}
+
+// Returns NULL if Name is neither a parser nor an interpreter opcode.
+static OperatorMatch_t *
+FindOperator(const char *Name)
+{
+  OperatorMatch_t *Slot;
+  unsigned Seed;
+
+  Seed = OperatorSeeds[HashOperator(Name, 0) % NumOperatorBuckets];
+  Slot = &Operators[HashOperator(Name, Seed) & OperatorMask];
+  if (Slot->Name[0] == 0 || strncmp(Slot->Name, Name, MAX_LABEL_LENGTH))
+    return (NULL);
+  return (Slot);
+}
+
+static ParserMatch_t *
+FindParser(const char *Name)
+{
+  OperatorMatch_t *Slot = FindOperator(Name);
+  return (Slot ? Slot->Parser : NULL);
+}
+
+static InterpreterMatch_t *
+FindInterpreter(const char *Name)
+{
+  OperatorMatch_t *Slot = FindOperator(Name);
+  return (Slot ? Slot->Interpreter : NULL);
+}
+
+//-------------------------------------------------------------------------
+// Make the operator lookups Pass() makes for a source line whose operator
+// is Name:  the line scanner's, then the interpreter's, and then (unless
+// the operator is interpretive) the parser's.  If Search is set, they are
+// made by bsearch() instead, as they were before there was a hash table.
+// Returns the number of matches found.  This is only for timing the two,
+// by bench/bench-operators.c.
+int
+LookUpOperator(const char *Name, int Search)
+{
+  OperatorMatch_t *Operator;
+  ParserMatch_t *Match;
+  InterpreterMatch_t *iMatch;
+  int Found;
+
+  if (Operators == NULL)
+    {
+      SortParsers();
+      SortInterpreters();
+      if (BuildOperatorTable())
+        return (0);
+    }
+
+  if (Search)
+    {
+      iMatch = SearchInterpreters(Name);
+      Match = SearchParsers(Name);
+      Found = (iMatch != NULL) + (Match != NULL);
+      iMatch = SearchInterpreters(Name);
+      if (!iMatch)
+        Match = SearchParsers(Name);
+    }
+  else
+    {
+      Operator = FindOperator(Name);
+      iMatch = Operator ? Operator->Interpreter : NULL;
+      Match = Operator ? Operator->Parser : NULL;
+      Found = (iMatch != NULL) + (Match != NULL);
+      iMatch = FindInterpreter(Name);
+      if (!iMatch)
+        Match = FindParser(Name);
+    }
+  return (Found + (iMatch != NULL) + (Match != NULL));
+}
+
 //-------------------------------------------------------------------------
 // This function simply checks to see if a given string is the name of an 
 // interpreter instruction.  It is used only for colorizing HTML output.
@@ -1310,11 +1634,13 @@ FindInterpreter(const char *Name)
 static int
 IsInterpretive(char *s)
 {
-  ParserMatch_t *Match;
-  if (FindInterpreter(s))
+  OperatorMatch_t *Match;
+  Match = FindOperator(s);
+  if (Match == NULL)
+    return (0);
+  if (Match->Interpreter)
     return (1);
-  Match = FindParser(s);
-  if (Match && Match->OpType == OP_INTERPRETER)
+  if (Match->Parser && Match->Parser->OpType == OP_INTERPRETER)
     return (1);
   return (0);
 }
@@ -1327,19 +1653,19 @@ AddressPrint(Address_t *Address)
 {
   if (Address->Invalid)
     {
-      printf("???????  ");
+      fprintf(LISTING, "???????  ");
       if (HtmlOut)
         fprintf(HtmlOut, "???????  ");
     }
   else if (Address->Constant)
     {
-      printf("%07o  ", Address->Value & 07777777);
+      fprintf(LISTING, "%07o  ", Address->Value & 07777777);
       if (HtmlOut)
         fprintf(HtmlOut, "%07o  ", Address->Value & 07777777);
     }
   else if (Address->Unbanked)
     {
-      printf("   %04o  ", Address->SReg);
+      fprintf(LISTING, "   %04o  ", Address->SReg);
       if (HtmlOut)
         fprintf(HtmlOut, "   %04o  ", Address->SReg);
     }
@@ -1347,13 +1673,13 @@ AddressPrint(Address_t *Address)
     {
       if (Address->Erasable)
         {
-          printf("E%1o,%04o  ", Address->EB, Address->SReg);
+          fprintf(LISTING, "E%1o,%04o  ", Address->EB, Address->SReg);
           if (HtmlOut)
             fprintf(HtmlOut, "E%1o,%04o  ", Address->EB, Address->SReg);
         }
       else if (Address->Fixed)
         {
-          printf("%02o,%04o  ", Address->FB + 010 * Address->Super,
+          fprintf(LISTING, "%02o,%04o  ", Address->FB + 010 * Address->Super,
               Address->SReg);
           if (HtmlOut)
             fprintf(HtmlOut, "%02o,%04o  ", Address->FB + 010 * Address->Super,
@@ -1361,7 +1687,7 @@ AddressPrint(Address_t *Address)
         }
       else
         {
-          printf("int-err  ");
+          fprintf(LISTING, "int-err  ");
           if (HtmlOut)
             fprintf(HtmlOut, "int-err  ");
           return (1);
@@ -1369,7 +1695,7 @@ AddressPrint(Address_t *Address)
     }
   else
     {
-      printf("int-err  ");
+      fprintf(LISTING, "int-err  ");
       if (HtmlOut)
         fprintf(HtmlOut, "int-err  ");
       return (1);
@@ -1416,15 +1742,17 @@ IsEmbeddedConstant(char *s)
 // resolve symbols.  With each successive pass, resolves more symbols.
 // It returns -1 on a completely unrecoverable error.  When called with 
 // WriteOutput=1 tries to write the output binary.  It is assumed that 
-// SymbolPass and SortSymbols have been used prior to the first call to Pass.
+// SymbolPass and SortSymbols have been used prior to the first call to Pass,
+// or else that the first call is made with DiscoveringSymbols set and
+// followed by SortSymbols.
 
-int WriteOutputDebug;
+ASSEMBLY int WriteOutputDebug;
 
 // The following used to be local to the Pass() function, but apparently
 // the initializers don't work the way I expect, causing boogered-up 
 // behavior, so I made them global.
 static Address_t DefaultAddress = INVALID_ADDRESS;
-  static ParseInput_t ParseInputRecord;
+  static ASSEMBLY ParseInput_t ParseInputRecord;
 
   static ParseInput_t DefaultParseInput =
     {
@@ -1442,17 +1770,19 @@ static Address_t DefaultAddress = INVALID_ADDRESS;
     0,// Index
     0,// Extend
     0,// IndexValid
+    0,// Column8
+    0,// InversionPending
+    0,// commentColumn
     INVALID_EBANK,// EBank
     INVALID_SBANK// SBank
   };
 
-static ParseOutput_t ParseOutputRecord,
+static ASSEMBLY ParseOutput_t ParseOutputRecord,
   DefaultParseOutput=
   { INVALID_ADDRESS,    // ProgramCounter
 0,                  // Reserved
         { 0, 0 },           // Words [0:1]
       0,                  // NumWords
-      "",                 // ErrorMessage
       INVALID_ADDRESS,    // LabelValue
     0,                  // Index
       0,                  // Warning
@@ -1460,39 +1790,135 @@ static ParseOutput_t ParseOutputRecord,
       0,                  // LabelValueValid
       0,                  // Extend
       0,                  // IndexValid
+  0,                  // Equals
+      0,                  // Column8
       INVALID_EBANK,       // EBank
     INVALID_SBANK,       // SBank
-  0                   // Equals
+      ""                  // ErrorMessage
     };
 
+// The following are carried from one source line to the next by Pass(),
+// in addition to the fields of ParseOutputRecord.
+static ASSEMBLY int StadrInvert = 0;
+static ASSEMBLY int expectedNumInterpreterOperatorLines = 0,
+    currentNumInterpreterOperatorLines = 0;
+static ASSEMBLY int noOperator = 1, foundInterpreterOperandCount = 0;
+
+//-------------------------------------------------------------------------
+// Save all of the state carried from one source line to the next, either
+// just before a line is evaluated (After=0) or just after (After=1).
+static void
+CaptureLineState(LineState_t *State, int After)
+{
+  memset(State, 0, sizeof(LineState_t));
+  if (After)
+    {
+      State->ProgramCounter = ParseOutputRecord.ProgramCounter;
+      State->EBank = ParseOutputRecord.EBank;
+      State->SBank = ParseOutputRecord.SBank;
+      State->Index = ParseOutputRecord.Index;
+      State->Extend = ParseOutputRecord.Extend;
+      State->IndexValid = ParseOutputRecord.IndexValid;
+    }
+  else
+    {
+      State->ProgramCounter = ParseInputRecord.ProgramCounter;
+      State->EBank = ParseInputRecord.EBank;
+      State->SBank = ParseInputRecord.SBank;
+      State->Index = ParseInputRecord.Index;
+      State->Extend = ParseInputRecord.Extend;
+      State->IndexValid = ParseInputRecord.IndexValid;
+    }
+  State->NumInterpretiveOperands = NumInterpretiveOperands;
+  State->RawNumInterpretiveOperands = RawNumInterpretiveOperands;
+  memcpy(State->nnnnFields, nnnnFields, sizeof(nnnnFields));
+  memcpy(State->SwitchIncrement, SwitchIncrement, sizeof(SwitchIncrement));
+  memcpy(State->SwitchInvert, SwitchInvert, sizeof(SwitchInvert));
+  State->StadrInvert = StadrInvert;
+  State->ExpectedOperatorLines = expectedNumInterpreterOperatorLines;
+  State->CurrentOperatorLines = currentNumInterpreterOperatorLines;
+  State->NoOperator = noOperator;
+  State->FoundOperandCount = foundInterpreterOperandCount;
+  State->LineInFile = CurrentLineInFile;
+}
+
+// Save the complete state of the assembly at the top of Pass()'s loop.
+static void
+CaptureBoundary(PassBoundary_t *Boundary, int Line, int CurrentLineAll)
+{
+  memset(Boundary, 0, sizeof(PassBoundary_t));
+  Boundary->Line = Line;
+  Boundary->CurrentLineAll = CurrentLineAll;
+  Boundary->CurrentLineInFile = CurrentLineInFile;
+  Boundary->inHeader = inHeader;
+  Boundary->ResolveLine = ResolveLineCount();
+  CaptureLineState(&Boundary->State, 0);
+  GetBankCounts(Boundary->UsedInBank);
+  if (Html)
+    Boundary->StyleHash = HtmlStyleHash();
+}
+
+// Make it as though a line had been evaluated, given the state saved just
+// after it was evaluated on some earlier pass.
+static void
+RestoreLineState(const LineState_t *State)
+{
+  ParseOutputRecord.ProgramCounter = State->ProgramCounter;
+  ParseOutputRecord.EBank = State->EBank;
+  ParseOutputRecord.SBank = State->SBank;
+  ParseOutputRecord.Index = State->Index;
+  ParseOutputRecord.Extend = State->Extend;
+  ParseOutputRecord.IndexValid = State->IndexValid;
+  NumInterpretiveOperands = State->NumInterpretiveOperands;
+  RawNumInterpretiveOperands = State->RawNumInterpretiveOperands;
+  memcpy(nnnnFields, State->nnnnFields, sizeof(nnnnFields));
+  memcpy(SwitchIncrement, State->SwitchIncrement, sizeof(SwitchIncrement));
+  memcpy(SwitchInvert, State->SwitchInvert, sizeof(SwitchInvert));
+  StadrInvert = State->StadrInvert;
+  expectedNumInterpreterOperatorLines = State->ExpectedOperatorLines;
+  currentNumInterpreterOperatorLines = State->CurrentOperatorLines;
+  noOperator = State->NoOperator;
+  foundInterpreterOperandCount = State->FoundOperandCount;
+}
+
 int
 Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
     int *Warnings)
 {
   void SaveUsedCounts(void);
-  int yulType = 0;
-  int IncludeDirective;
+  SourceLine_t EmptyLine =
+    { "", 0, NULL, 1 };
+  SourceLine_t *Line;
+  SourceTokens_t *Tokens;
+  int IncludeDirective, RawTokens;
   ParserMatch_t *Match;
   InterpreterMatch_t *iMatch;
+  OperatorMatch_t *Operator;
   int RetVal = 1, PinchHitting;
   Line_t s;
-  FILE *InputFile;
+  SourceCursor_t InputFile;
   int CurrentLineAll = 0;
-  int i, j, k;    // dummies.
-  char *ss;    // dummies.
-  int StadrInvert = 0;
+  int i, j;    // dummies.
   int BlockAssigned = 0;
-  int expectedNumInterpreterOperatorLines = 0,
-      currentNumInterpreterOperatorLines = 0;
-  int noOperator = 1, foundInterpreterOperandCount /*, firstInterpreterColumn*/;
-  static char lastLines[10][sizeof(s)] =
+  LineState_t LineState;
+  // The last ten lines, as a ring, for looking at in a debugger.  The most
+  // recent is lastLines[lastLine].
+  static ASSEMBLY char lastLines[10][sizeof(s)] =
     { "", "", "", "", "", "", "", "", "", "" };
+  static ASSEMBLY int lastLine = 0;
 
   debugLineString = s;
   debugLine = 1;
   SaveUsedCounts();
   thisIsTheLastPass = WriteOutput;
   numSymbolsReassigned = 0;
+  StadrInvert = 0;
+  expectedNumInterpreterOperatorLines = currentNumInterpreterOperatorLines = 0;
+  noOperator = 1;
+  foundInterpreterOperandCount = 0;
+  ResolveStartPass(!WriteOutput && !formatOnly && !toYulOnly && !debugLevel);
+  if (!WriteOutput)
+    NumPassBoundaries = 0;
 
   // Set for the proper assembly target
   // The default for these settings is Block2 (YUL name AGC, I think).
@@ -1523,19 +1949,16 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
   SortInterpreters();
   *Fatals = *Warnings = 0;
 
-  for (i = 0; i < 044; i++)
-    for (j = 0; j < 02000; j++)
-      {
-        ObjectCode[i][j] = 0;
-        Parities[i][j] = 0;
-      }
+  if (BuildOperatorTable() || (WriteOutput && ClearObjectCode()))
+    {
+      (*Fatals)++;
+      return (-1);
+    }
 
   // Open the input file.
   strcpy(CurrentFilename, InputFilename);
-  InputFile = fopen(CurrentFilename, "r");
-  if (!InputFile)
+  if (OpenSource(&InputFile, CurrentFilename))
     goto Done;
-  yulType = (NULL != strstr(InputFilename, ".yul"));
 
   // Loop on the lines of the input file.  The assembler passes differ
   // among themselves as follows:
@@ -1559,39 +1982,81 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
   // The SBank starts "unestablished", which = 0.
   ParseOutputRecord.SBank = (const SBank_t) INVALID_SBANK;
 
+  // Pick up partway through the top-level file, if so directed.
+  if (ChunkStart != NULL)
+    {
+      InputFile.Next = ChunkStart->Line;
+      RestoreLineState(&ChunkStart->State);
+      SetBankCounts(ChunkStart->UsedInBank);
+      CurrentLineAll = ChunkStart->CurrentLineAll;
+      CurrentLineInFile = ChunkStart->CurrentLineInFile;
+      inHeader = ChunkStart->inHeader;
+      ResolveSetLineCount(ChunkStart->ResolveLine);
+    }
+
   for (;;)
     {
       IncludeDirective = 0;
       OpcodeOffset = 0;
       PinchHitting = 0;
       ArgType = 0;
-      // Set up the default info for this line.
-      ParseInputRecord = DefaultParseInput;
+      // Set up the default info for this line.  Only the fields which
+      // precede the banks are reset from the defaults; see yaYUL.h.
+      memcpy(&ParseInputRecord, &DefaultParseInput,
+          offsetof(ParseInput_t, EBank));
       ParseInputRecord.ProgramCounter = ParseOutputRecord.ProgramCounter;
       ParseInputRecord.EBank = ParseOutputRecord.EBank;
       ParseInputRecord.SBank = ParseOutputRecord.SBank;
       ParseInputRecord.Index = ParseOutputRecord.Index;
       ParseInputRecord.IndexValid = ParseOutputRecord.IndexValid;
       ParseInputRecord.Extend = ParseOutputRecord.Extend;
-      ParseOutputRecord = DefaultParseOutput;
-      ParseOutputRecord.EBank = ParseInputRecord.EBank;
-      ParseOutputRecord.SBank = ParseInputRecord.SBank;
+      memcpy(&ParseOutputRecord, &DefaultParseOutput,
+          offsetof(ParseOutput_t, EBank));
+      ParseOutputRecord.ErrorMessage[0] = 0;
+      // Stop here if this is as far as we were supposed to go, and make
+      // note of the state at each $ directive in the top-level file.
+      if (NumStackedIncludes == 0)
+        {
+          if (ChunkEnd != -1 && InputFile.Next >= ChunkEnd)
+            {
+              CaptureBoundary(&ChunkEndState, InputFile.Next, CurrentLineAll);
+              break;
+            }
+          if (!WriteOutput && InputFile.Next < InputFile.File->NumLines
+              && SourceFirstChar(&InputFile.File->Lines[InputFile.Next]) == '$')
+            {
+              if (NumPassBoundaries == MaxPassBoundaries)
+                {
+                  PassBoundary_t *Boundaries;
+                  Boundaries = (PassBoundary_t *) realloc(PassBoundaries,
+                      (MaxPassBoundaries + 64) * sizeof(PassBoundary_t));
+                  if (Boundaries == NULL)
+                    {
+                      fprintf(LISTING, "Out of memory (8).\n");
+                      OutOfMemory = 1;
+                      goto Done;
+                    }
+                  PassBoundaries = Boundaries;
+                  MaxPassBoundaries += 64;
+                }
+              CaptureBoundary(&PassBoundaries[NumPassBoundaries++],
+                  InputFile.Next, CurrentLineAll);
+            }
+        }
       // Get the next line from the file.
-      ss = fgets(s, sizeof(s) - 1, InputFile);
-      //printf("LINE -> %s", s);
+      Line = NextSourceLine(&InputFile);
       // At end of the file?
-      if (!ss)
+      if (!Line)
         {
           // We've reached the end of this input file.  Need to switch
           // files (if we were within an include-file) or to end the pass.
           inHeader = 0;
           if (NumStackedIncludes)
             {
-              fclose(InputFile);
               NumStackedIncludes--;
               if (WriteOutput)
                 {
-                  printf("(End of include-file %s, resuming %s)\n",
+                  fprintf(LISTING, "(End of include-file %s, resuming %s)\n",
                       CurrentFilename,
                       StackedIncludes[NumStackedIncludes].InputFilename);
                   if (HtmlOut)
@@ -1613,8 +2078,7 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
               CurrentLineInFile =
                   StackedIncludes[NumStackedIncludes].CurrentLineInFile;
               HtmlOut = StackedIncludes[NumStackedIncludes].HtmlOut;
-              yulType = StackedIncludes[NumStackedIncludes].yulType;
-              s[0] = 0;
+              Line = &EmptyLine;
             }
           else
             {
@@ -1630,30 +2094,24 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
         }
       debugLine = CurrentLineAll;
 
-      // For --simulation.
-      if (s[0] != '#')
-	if ((Simulation && strstr(s, "-SIMULATION")) || (!Simulation && strstr(s, "+SIMULATION")))
-	  {
-	    memmove(&s[1], s, sizeof(s) - 1);
-	    s[sizeof(s) - 1] = 0;
-	    s[0] = '#';
-	  }
+      // The line's text, already converted for --simulation and for the
+      // "#>" construct of .yul files when the file was read.
+      SourceText(s, sizeof(s), Line, 0);
+      RawTokens = 0;
 
       // Analyze the input line.
 
       // If it is not a ## line and not completely blank, then we are no longer
       // in the file header.
-      for (ss = s; *ss && isspace(*ss); ss++)
-        ;
-      if (*ss == 0) // completely whitespace
+      if (Line->Blank) // completely whitespace
         {
           if (toYulOnly)
             {
-              printf("%-80s\n", "");
+              fprintf(LISTING, "%-80s\n", "");
               continue;
             }
         }
-      else if (s[0] == '#' && s[1] == '#' && 1 != sscanf(s, "## Page%d", &k)) // is a ## line
+      else if (Line->PoundPound) // is a ## line
         {
 	  // Intentionally empty.
         }
@@ -1662,44 +2120,48 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
           inHeader = 0;
           if (toYulOnly)
             {
-              printf("P%04d   %-72s\n", toYulOnlySequenceNumber++,
+              fprintf(LISTING, "P%04d   %-72s\n", toYulOnlySequenceNumber++,
                   toYulOnlyLogSection);
             }
         }
 
-      // Convert the construct "#>' (column 1) used in .yul files to an
-      // indented ##-style comment.
-      if (yulType && s[0] == '#' && s[1] == '>')
-        {
-          s[1] = '#';
-          memmove(&s[6], s, 1 + strlen(s));
-          memset(s, '\t', 6);
-        }
-
       // Is it an HTML insert?  If so, transparently process and discard.
       if (formatOnly || toYulOnly)
         {
           if (s[0] == '#' && s[1] == '#')
             {
-              printf("%s", s);
+              fprintf(LISTING, "%s", s);
               continue;
             }
         }
-      else if (HtmlCheck(WriteOutput, InputFile, s, sizeof(s), CurrentFilename,
-          &CurrentLineAll, &CurrentLineInFile))
+      else if (s[0] == '#' || s[0] == '<')
         {
-          // The following 3 lines are a fix for the following bug:
-          // https://github.com/rburkey2005/virtualagc/issues/45.
-          ParseOutputRecord.ProgramCounter = ParseInputRecord.ProgramCounter;
-          ParseOutputRecord.EBank = ParseInputRecord.EBank;
-          ParseOutputRecord.SBank = ParseInputRecord.SBank;
-          continue;
+          // (HTML inserts always begin with '#' or '<', so other lines needn't
+          // be checked.)
+          i = InputFile.Next;
+          if (HtmlCheck(WriteOutput, &InputFile, s, sizeof(s), CurrentFilename,
+              &CurrentLineAll, &CurrentLineInFile))
+            {
+              // The following 3 lines are a fix for the following bug:
+              // https://github.com/rburkey2005/virtualagc/issues/45.
+              ParseOutputRecord.ProgramCounter = ParseInputRecord.ProgramCounter;
+              ParseOutputRecord.EBank = ParseInputRecord.EBank;
+              ParseOutputRecord.SBank = ParseInputRecord.SBank;
+              continue;
+            }
+          // If HtmlCheck() read past the end of a ## block, s now holds the
+          // unconverted text of the line following the block.
+          if (InputFile.Next != i)
+            {
+              Line = &InputFile.File->Lines[InputFile.Next - 1];
+              RawTokens = 1;
+            }
         }
 
       // Is it an "include" directive?
       if (formatOnly && s[0] == '$')
         {
-          printf("%s", s);
+          fprintf(LISTING, "%s", s);
           continue;
         }
       if (s[0] == '$')
@@ -1709,12 +2171,13 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
           ParseOutputRecord.EBank = ParseInputRecord.EBank;
           ParseOutputRecord.SBank = ParseInputRecord.SBank;
           if (WriteOutput)
-            printf("%06d,%06d: %s", CurrentLineAll, CurrentLineInFile, s);
+            fprintf(LISTING, "%06d,%06d: %s", CurrentLineAll,
+                CurrentLineInFile, s);
 
           if (NumStackedIncludes == MAX_STACKED_INCLUDES)
             {
-              printf("Too many levels of include-files.\n");
-              fprintf(stderr, "%s:%d: Too many levels of include-files.\n",
+              fprintf(LISTING, "Too many levels of include-files.\n");
+              fprintf(ERRORS, "%s:%d: Too many levels of include-files.\n",
                   CurrentFilename, CurrentLineInFile);
               goto Done;
             }
@@ -1725,13 +2188,12 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
           StackedIncludes[NumStackedIncludes].CurrentLineInFile =
               CurrentLineInFile;
           StackedIncludes[NumStackedIncludes].HtmlOut = HtmlOut;
-          StackedIncludes[NumStackedIncludes].yulType = yulType;
           NumStackedIncludes++;
 
           if (sscanf(s, "$%s", CurrentFilename) != 1)
             {
-              printf("Include-directive has no filename.\n");
-              fprintf(stderr, "%s:%d: Include-directive has no filename.\n",
+              fprintf(LISTING, "Include-directive has no filename.\n");
+              fprintf(ERRORS, "%s:%d: Include-directive has no filename.\n",
                   CurrentFilename, CurrentLineInFile);
               goto Done;
             }
@@ -1754,98 +2216,76 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                 goto Done;
             }
 
-          InputFile = fopen(CurrentFilename, "r");
-          if (!InputFile)
+          if (OpenSource(&InputFile, CurrentFilename))
             {
-              printf("Include-file \"%s\" does not exist.\n", CurrentFilename);
-              fprintf(stderr, "%s:%d: Include-file does not exist.\n",
+              fprintf(LISTING, "Include-file \"%s\" does not exist.\n",
+                  CurrentFilename);
+              fprintf(ERRORS, "%s:%d: Include-file does not exist.\n",
                   CurrentFilename, CurrentLineInFile);
               goto Done;
             }
-          yulType = (NULL != strstr(CurrentFilename, ".yul"));
 
           inHeader = 1;
           CurrentLineInFile = 0;
           continue;
         }
 
-      // Frankly, tabs and newlines will cause me a lot of problems further down, since
-      // there are actually a couple of things we need to use column alignment to check
-      // out.  So let's just start by expanding all tabs to spaces.
-      ParseInputRecord.Column8 = ' ';
-      ParseInputRecord.InversionPending = 0;
-      ss = strstr(s, "\n");
-      if (ss != NULL )
-        *ss = 0;
-      s[sizeof(s) - 1] = 0;
-      for (ss = s; *ss;)
+      // In the first pass, any symbol the line defines is added to the
+      // symbol table before the line is evaluated (see SymbolPass.c).
+      if (DiscoveringSymbols && DiscoverSymbols(InputFile.File, Line))
         {
-          if (*ss == '\t')
-            {
-              int pos, tabStop, len;
-              pos = ss - s;
-              tabStop = ((pos + 8) & ~7);
-              len = strlen(ss + 1);
-              if (tabStop + len >= sizeof(s))
-                len = sizeof(s) - tabStop - 1;
-              if (len > 0)
-                memmove(&s[tabStop], &s[pos + 1], len + 1);
-              else
-                s[tabStop] = 0;
-              for (; pos < tabStop && pos < sizeof(s); pos++)
-                s[pos] = ' ';
-              ss = &s[tabStop];
-            }
-          else
-            ss++;
+          fprintf(LISTING, "Out of memory (2).\n");
+          goto Done;
         }
-      *ss = 0;
-
-      if (yulType)
-        yul2agc(s);
-
-      // Find and remove the comment field, if any.
-      //printf ("Line -> \"%s\"\n", s);
-      ParseInputRecord.commentColumn = 0;
-      for (ParseInputRecord.Comment = s;
-          *ParseInputRecord.Comment
-              && *ParseInputRecord.Comment != COMMENT_SEPARATOR;
-          ParseInputRecord.Comment++)
-        ;
-      if (*ParseInputRecord.Comment == COMMENT_SEPARATOR)
+
+      // If nothing the line depends on has changed since the preceding
+      // pass, there's no need to evaluate it again.
+      CaptureLineState(&LineState, 0);
+      if (ResolveBeginLine(Line, RawTokens, &LineState))
         {
-          ParseInputRecord.commentColumn = ParseInputRecord.Comment - s;
-          *ParseInputRecord.Comment++ = 0;
-          // Trim the newline at the end:
-          //for (ss = ParseInputRecord.Comment; *ss; ss++)
-          //    if (*ss == '\n')
-          //        *ss = 0;
-          if (toYulOnly && ParseInputRecord.Comment[0] == COMMENT_SEPARATOR)
-            {
-              ParseInputRecord.Comment++;
-              if (*ParseInputRecord.Comment == ' ')
-                ParseInputRecord.Comment++;
-              printf("#>%-38s%-40s\n", "", ParseInputRecord.Comment);
-              *ParseInputRecord.Comment = 0;
-            }
+          RestoreLineState(&LineState);
+          UpdateBankCounts(&ParseOutputRecord.ProgramCounter);
+          continue;
         }
-      //printf ("Comment -> \"%s\"\n", ParseInputRecord.Comment);
 
-      if (Block1 && strlen(s) >= 16)
+      // Fetch the line as already split into fields.  The tab-expansion,
+      // conversion of .yul cards, removal of the comment, and the --block1
+      // column 16 stuff, are all done the first time the line is seen, and
+      // it's simply a matter of copying the results.  (It must be a copy,
+      // because some of the parsers modify the fields.)
+      Tokens = GetSourceTokens(InputFile.File, Line, RawTokens);
+      if (Tokens == NULL)
+        {
+          fprintf(LISTING, "Out of memory (4).\n");
+          OutOfMemory = 1;
+          goto Done;
+        }
+      memcpy(s, Tokens->Text, Tokens->TextSize);
+      ParseInputRecord.Column8 = Tokens->Column8;
+      ParseInputRecord.InversionPending = Tokens->InversionPending;
+      ParseInputRecord.commentColumn = Tokens->CommentColumn;
+      ParseInputRecord.Comment = &s[Tokens->CommentOffset];
+      if (toYulOnly && ParseInputRecord.Comment[0] == COMMENT_SEPARATOR)
         {
-          ParseInputRecord.Column8 = s[15];
-          s[15] = ' ';
-          ParseInputRecord.InversionPending = (ParseInputRecord.Column8 == '-');
+          ParseInputRecord.Comment++;
+          if (*ParseInputRecord.Comment == ' ')
+            ParseInputRecord.Comment++;
+          fprintf(LISTING, "#>%-38s%-40s\n", "", ParseInputRecord.Comment);
+          *ParseInputRecord.Comment = 0;
         }
 
-      // Suck in all other fields. Below, i is going to be the index of the next input field to be processed.
-      NumFields = sscanf(s, "%s%s%s%s%s%s", Fields[0], Fields[1], Fields[2],
-          Fields[3], Fields[4], Fields[5]);
+      // Pick up all other fields. Below, i is going to be the index of the next input field to be processed.
+      NumFields = Tokens->NumFields;
+      for (i = 0; i < NumFields; i++)
+        {
+          memcpy(Fields[i], &s[Tokens->FieldStart[i]], Tokens->FieldLength[i]);
+          Fields[i][Tokens->FieldLength[i]] = 0;
+        }
       if (NumFields >= 1)
         {
           int whichColumn;
           // Column at which Field[0] starts.
-          whichColumn = strstr(s, Fields[0]) - s;
+          whichColumn = Tokens->FieldStart[0];
           i = 0;
           if (whichColumn == 0)
             {
@@ -1866,9 +2306,8 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
               j++;
             }
 
-          for (k = 9; k > 0; k--)
-            strcpy(lastLines[k], lastLines[k - 1]);
-          strcpy(lastLines[0], s);
+          lastLine = (lastLine + 1) % 10;
+          strcpy(lastLines[lastLine], s);
 
           // It is assumed by convention that
           // the first operand appears at column 16, therefore if Fields[i] doesn't
@@ -1883,8 +2322,9 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                 noOperator = 0;
             }
 
-          iMatch = noOperator ? NULL : FindInterpreter(Fields[i]);
-          Match = FindParser(Fields[i]);
+          Operator = FindOperator(Fields[i]);
+          iMatch = (noOperator || !Operator) ? NULL : Operator->Interpreter;
+          Match = Operator ? Operator->Parser : NULL;
 
           if (Block1)
             {
@@ -2007,7 +2447,7 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
             {
               if (!strcmp(ParseInputRecord.Operator, "CADR"))
                 {
-                  static char fakeOperand[32];
+                  static ASSEMBLY char fakeOperand[32];
                   sprintf(fakeOperand, "%o",
                       (ParseInputRecord.ProgramCounter.FB << 10)
                           + (ParseInputRecord.ProgramCounter.SReg & 01777));
@@ -2028,45 +2468,45 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
             {
               yes = 1;
               if (ParseInputRecord.Label[0])
-                printf("%-15s", ParseInputRecord.Label);
+                fprintf(LISTING, "%-15s", ParseInputRecord.Label);
               else if (ParseInputRecord.FalseLabel[0])
-                printf(" %-14s", ParseInputRecord.FalseLabel);
+                fprintf(LISTING, " %-14s", ParseInputRecord.FalseLabel);
               else
-                printf("               ");
-              printf("%c", ParseInputRecord.Column8);
+                fprintf(LISTING, "               ");
+              fprintf(LISTING, "%c", ParseInputRecord.Column8);
               if (ParseInputRecord.Operator[0])
-                printf("%-16s", ParseInputRecord.Operator);
+                fprintf(LISTING, "%-16s", ParseInputRecord.Operator);
               else
-                printf("                ");
+                fprintf(LISTING, "                ");
               if (ParseInputRecord.Operand[0])
-                printf("%-16s", ParseInputRecord.Operand);
+                fprintf(LISTING, "%-16s", ParseInputRecord.Operand);
               else
-                printf("                ");
+                fprintf(LISTING, "                ");
               if (ParseInputRecord.Mod1[0])
-                printf("%-8s", ParseInputRecord.Mod1);
+                fprintf(LISTING, "%-8s", ParseInputRecord.Mod1);
               else
-                printf("        ");
+                fprintf(LISTING, "        ");
               if (ParseInputRecord.Mod2[0])
-                printf("%-8s", ParseInputRecord.Mod2);
+                fprintf(LISTING, "%-8s", ParseInputRecord.Mod2);
               else
-                printf("        ");
+                fprintf(LISTING, "        ");
             }
           if (ParseInputRecord.Comment[0])
             {
               if (!yes && ParseInputRecord.commentColumn > 0)
                 {
-                  printf("%*s", 64, " ");
+                  fprintf(LISTING, "%*s", 64, " ");
                 }
               if (ParseInputRecord.Comment[0] != '#')
                 {
-                  printf("#%s", ParseInputRecord.Comment);
+                  fprintf(LISTING, "#%s", ParseInputRecord.Comment);
                 }
               else
                 {
-                  printf("%s", ParseInputRecord.Comment);
+                  fprintf(LISTING, "%s", ParseInputRecord.Comment);
                 }
             }
-          printf("\n");
+          fprintf(LISTING, "\n");
           continue;
         }
       if (toYulOnly)
@@ -2077,7 +2517,7 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
           if (ParseInputRecord.commentColumn == 0
               && ParseInputRecord.Comment[0] != 0)
             {
-              printf("R%04d   %-72s\n", toYulOnlySequenceNumber++,
+              fprintf(LISTING, "R%04d   %-72s\n", toYulOnlySequenceNumber++,
                   ParseInputRecord.Comment);
               continue;
             }
@@ -2086,9 +2526,11 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
               && ParseInputRecord.Operand[0] == 0)
             {
               if (ParseInputRecord.Comment[0] == 0)
-                printf("R%04d   %-72s\n", toYulOnlySequenceNumber++, "");
+                fprintf(LISTING, "R%04d   %-72s\n",
+                    toYulOnlySequenceNumber++, "");
               else
-                printf("A%04d   %-32s%-40s\n", toYulOnlySequenceNumber++, "",
+                fprintf(LISTING, "A%04d   %-32s%-40s\n",
+                    toYulOnlySequenceNumber++, "",
                     ParseInputRecord.Comment);
               continue;
             }
@@ -2106,9 +2548,9 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
             strcpy(dummyOperator, ParseInputRecord.Operator);
           sprintf(dummyOperand, "%s %s %s", ParseInputRecord.Operand,
               ParseInputRecord.Mod1, ParseInputRecord.Mod2);
-          printf(" %04d   %-8s %-6s %-16s%-40s\n", toYulOnlySequenceNumber++,
-              dummyLabel, dummyOperator, dummyOperand,
-              ParseInputRecord.Comment);
+          fprintf(LISTING, " %04d   %-8s %-6s %-16s%-40s\n",
+              toYulOnlySequenceNumber++, dummyLabel, dummyOperator,
+              dummyOperand, ParseInputRecord.Comment);
           continue;
         }
 
@@ -2508,12 +2950,23 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
               &ParseInputRecord.ProgramCounter, Type, CurrentFilename,
               CurrentLineInFile);
         }
+      CaptureLineState(&LineState, 1);
+      ResolveEndLine(&LineState);
 
       // Write the output.
       if (WriteOutput && !IncludeDirective)
         {
           char *Suffix;
 
+          if (Tokens->Truncated && !ParseOutputRecord.Fatal
+              && !ParseOutputRecord.Warning)
+            {
+              ParseOutputRecord.Warning = 1;
+              sprintf(ParseOutputRecord.ErrorMessage,
+                  "Line is longer than %d characters, and was truncated",
+                  MAX_LINE_LENGTH);
+            }
+
           // If doing HTML output, need to put an anchor here if the line has a label
           // or is a definition of a variable or constant.
           if (HtmlOut && *ParseInputRecord.Label != 0)
@@ -2528,26 +2981,27 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
 
           if (ParseOutputRecord.Fatal)
             {
-              printf("%s:%d: Fatal Error: %s\n", CurrentFilename,
+              fprintf(LISTING, "%s:%d: Fatal Error: %s\n", CurrentFilename,
                   CurrentLineInFile, ParseOutputRecord.ErrorMessage);
               if (HtmlOut)
                 fprintf(HtmlOut, COLOR_FATAL "Fatal Error:  %s</span>\n",
                     ParseOutputRecord.ErrorMessage);
-              fprintf(stderr, "%s:%d: Fatal Error: %s\n", CurrentFilename,
+              fprintf(ERRORS, "%s:%d: Fatal Error: %s\n", CurrentFilename,
                   CurrentLineInFile, ParseOutputRecord.ErrorMessage);
               (*Fatals)++;
             }
           else if (ParseOutputRecord.Warning)
             {
-              printf("Warning: %s:\n", ParseOutputRecord.ErrorMessage);
+              fprintf(LISTING, "Warning: %s:\n",
+                  ParseOutputRecord.ErrorMessage);
               if (HtmlOut)
                 fprintf(HtmlOut, COLOR_WARNING "Warning:  %s</span>\n",
                     ParseOutputRecord.ErrorMessage);
-              fprintf(stderr, "%s:%d: Warning: %s\n", CurrentFilename,
+              fprintf(ERRORS, "%s:%d: Warning: %s\n", CurrentFilename,
                   CurrentLineInFile, ParseOutputRecord.ErrorMessage);
               (*Warnings)++;
             }
-          printf("%06d,%06d: ", CurrentLineAll, CurrentLineInFile);
+          fprintf(LISTING, "%06d,%06d: ", CurrentLineAll, CurrentLineInFile);
           if (HtmlOut)
             fprintf(HtmlOut, "%06d,%06d: ", CurrentLineAll, CurrentLineInFile);
           if (*ParseInputRecord.Label != 0 || *ParseInputRecord.FalseLabel != 0
@@ -2564,7 +3018,7 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                 }
               else
                 {
-                  printf("         ");
+                  fprintf(LISTING, "         ");
                   if (HtmlOut)
                     fprintf(HtmlOut, "         ");
                 }
@@ -2575,7 +3029,7 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                 }
               else
                 {
-                  printf("         ");
+                  fprintf(LISTING, "         ");
                   if (HtmlOut)
                     fprintf(HtmlOut, "         ");
                 }
@@ -2583,13 +3037,14 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                 {
                   if (ParseOutputRecord.Words[0] == ILLEGAL_SYMBOL_VALUE)
                     {
-                      printf("????? ");
+                      fprintf(LISTING, "????? ");
                       if (HtmlOut)
                         fprintf(HtmlOut, "????? ");
                     }
                   else
                     {
-                      printf("%05o ", ParseOutputRecord.Words[0] & 077777);
+                      fprintf(LISTING, "%05o ",
+                          ParseOutputRecord.Words[0] & 077777);
                       if (HtmlOut)
                         fprintf(HtmlOut, "%05o ",
                             ParseOutputRecord.Words[0] & 077777);
@@ -2617,8 +3072,7 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                             {
                               int SReg = (ParseInputRecord.ProgramCounter.SReg + i) & 01777;
                               int Data = ParseOutputRecord.Words[i] & 077777;
-                              ObjectCode[bank][SReg] = Data;
-                              Parities[bank][SReg] = CalculateParity(Data);
+                              ObjectCode[bank][SReg] = Data | OBJECT_WRITTEN;
                             }
 
                           // JMS: 07.28
@@ -2632,7 +3086,7 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                 }
               else
                 {
-                  printf("      ");
+                  fprintf(LISTING, "      ");
                   if (HtmlOut)
                     fprintf(HtmlOut, "%s", NormalizeStringN("", 6));
                 }
@@ -2641,13 +3095,14 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                 {
                   if (ParseOutputRecord.Words[1] == ILLEGAL_SYMBOL_VALUE)
                     {
-                      printf("????? ");
+                      fprintf(LISTING, "????? ");
                       if (HtmlOut)
                         fprintf(HtmlOut, "?????&nbsp");
                     }
                   else
                     {
-                      printf("%05o ", ParseOutputRecord.Words[1] & 077777);
+                      fprintf(LISTING, "%05o ",
+                          ParseOutputRecord.Words[1] & 077777);
                       if (HtmlOut)
                         fprintf(HtmlOut, "%05o ",
                             ParseOutputRecord.Words[1] & 077777);
@@ -2655,7 +3110,7 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                 }
               else
                 {
-                  printf("      ");
+                  fprintf(LISTING, "      ");
                   if (HtmlOut)
                     fprintf(HtmlOut, "%s", NormalizeStringN("", 6));
                 }
@@ -2675,7 +3130,7 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                     strcat(ParseInputRecord.Operand, Suffix);
                 }
 
-              printf(" %-8s %-8s %c%-8s %-10s %-10s %-8s\t#%s",
+              fprintf(LISTING, " %-8s %-8s %c%-8s %-10s %-10s %-8s\t#%s",
                   ParseInputRecord.Label, ParseInputRecord.FalseLabel,
                   ParseOutputRecord.Column8, ParseInputRecord.Operator,
                   ParseInputRecord.Operand, ParseInputRecord.Mod1,
@@ -2683,7 +3138,7 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
 
               if (HtmlOut)
                 {
-                  Symbol_t *Symbol;
+                  int Symbol;
                   int Comma = 0, Dollar = 0, n;
 
                   if (*ParseInputRecord.Label == 0)
@@ -2744,9 +3199,9 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                       if (j)
                         goto InterpreterOpcode;
                     }
-                  Symbol = GetSymbol(ParseInputRecord.Operand);
+                  Symbol = FindSymbol(ParseInputRecord.Operand);
                   n = strlen(ParseInputRecord.Operand);
-                  if (!Symbol)
+                  if (Symbol < 0)
                     {
                       if (iMatch)
                         {
@@ -2755,9 +3210,9 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                                   || ParseInputRecord.Operand[n - 1] == '2'))
                             {
                               ParseInputRecord.Operand[n - 2] = 0;
-                              Symbol = GetSymbol(ParseInputRecord.Operand);
+                              Symbol = FindSymbol(ParseInputRecord.Operand);
                               ParseInputRecord.Operand[n - 2] = ',';
-                              if (Symbol)
+                              if (Symbol >= 0)
                                 {
                                   Comma = 1;
                                   goto FoundComma;
@@ -2766,8 +3221,8 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                         }
                       if (!strncmp(ParseInputRecord.Operand, "$$/", 3))
                         {
-                          Symbol = GetSymbol(&ParseInputRecord.Operand[3]);
-                          if (Symbol)
+                          Symbol = FindSymbol(&ParseInputRecord.Operand[3]);
+                          if (Symbol >= 0)
                             {
                               Dollar = 3;
                               goto FoundComma;
@@ -2789,11 +3244,11 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                     {
                       FoundComma: if (Dollar)
                         fprintf(HtmlOut, "$$/");
-                      if (!strcmp(CurrentFilename, Symbol->FileName))
+                      if (!strcmp(CurrentFilename, GetSymbolFileName(Symbol)))
                         fprintf(HtmlOut, "<a href=\"");
                       else
                         fprintf(HtmlOut, "<a href=\"%s",
-                            NormalizeFilename(Symbol->FileName));
+                            NormalizeFilename(GetSymbolFileName(Symbol)));
                       if (Comma)
                         ParseInputRecord.Operand[n - 2] = 0;
                       fprintf(HtmlOut, "#%s\">",
@@ -2824,21 +3279,17 @@ Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
                 }
             }
 
-          printf("\n");
+          fprintf(LISTING, "\n");
           if (HtmlOut)
             fprintf(HtmlOut, "\n");
         }
     }
 
   // Done with this pass.
+  PassTotalLines = CurrentLineAll;
   RetVal = 0;
 
-  Done: if (InputFile)
-    fclose(InputFile);
-
-  for (i = 0; i < NumStackedIncludes; i++)
-    fclose(StackedIncludes[i].InputFile);
-
+  Done:
   NumStackedIncludes = 0;
 
   return (RetVal);
@@ -27,12 +27,75 @@
                 08/18/16 RSB.   Tweaks related to --block1.
                 10/12/16 RSB.   Cosmetic change which should not affect
                                 the output in any way.
+                2026-10-17 AGT  The conversions are done from tables of the
+                                0400-word segments of the pseudo-address
+                                space.
  */
 
 #include "yaYUL.h"
 #include <stdlib.h>
 #include <string.h>
 
+//------------------------------------------------------------------------
+// Every 0400-word segment of the pseudo-address space lies within a single
+// memory region, so the conversions below are made by copying an Address_t
+// for the start of the segment, and adding the position within it to the
+// S-register.  There are tables for PseudoToStruct() with and without
+// --block1, and for PseudoToEBanked().  (The fields are, in order, Invalid,
+// Constant, Address, SReg, Erasable, Fixed, Unbanked, Banked, EB, FB, Super,
+// Overflow, Value, and Syllable.)
+
+#define NUM_SEGMENTS ((0117777 + 1) / 0400)
+
+// Unbanked erasable or fixed, starting at S-register value s.
+#define UE(s) { 0, 0, 1, (s), 1, 0, 1, 0, 0, 0, 0, 0, 0, 0 }
+#define UF(s) { 0, 0, 1, (s), 0, 1, 1, 0, 0, 0, 0, 0, 0, 0 }
+#define UF4(s) UF(s), UF((s) + 0400), UF((s) + 01000), UF((s) + 01400)
+// Erasable bank e.
+#define BE(e) { 0, 0, 1, 01400, 1, 0, 0, 1, (e), 0, 0, 0, 0, 0 }
+// The four segments of fixed bank f (of superbank x), with its S-register
+// values starting at s.
+#define BF(s, f, x) { 0, 0, 1, (s), 0, 1, 0, 1, 0, (f) & 037, (x), 0, 0, 0 }
+#define BF4(s, f, x) BF(s, f, x), BF((s) + 0400, f, x), BF((s) + 01000, f, x), \
+    BF((s) + 01400, f, x)
+#define FB4(f, x) BF4(02000, f, x), BF4(02000, (f) + 1, x), \
+    BF4(02000, (f) + 2, x), BF4(02000, (f) + 3, x)
+#define B1FB4(f) BF4(06000, f, 0), BF4(06000, (f) + 1, 0), \
+    BF4(06000, (f) + 2, 0), BF4(06000, (f) + 3, 0)
+
+static const Address_t Segments[NUM_SEGMENTS] = {
+    UE(0), UE(0400), UE(01000), BE(3), BE(4), BE(5), BE(6), BE(7),
+    UF4(04000), UF4(06000),
+    FB4(000, 0), FB4(004, 0), FB4(010, 0), FB4(014, 0),
+    FB4(020, 0), FB4(024, 0), FB4(030, 0), FB4(034, 0),
+    FB4(030, 1)
+};
+
+static const Address_t Block1Segments[NUM_SEGMENTS] = {
+    UE(0), UE(0400), UE(01000), UE(01400),
+    UF4(02000), UF4(04000),
+    B1FB4(003), B1FB4(007), B1FB4(013), B1FB4(017), B1FB4(023),
+    B1FB4(027), B1FB4(033), B1FB4(037), B1FB4(043),
+    BF4(06000, 047, 0)
+};
+
+static const Address_t EBankedSegments[NUM_SEGMENTS] = {
+    BE(0), BE(1), BE(2), BE(3), BE(4), BE(5), BE(6), BE(7),
+    UF4(04000), UF4(06000),
+    FB4(000, 0), FB4(004, 0), FB4(010, 0), FB4(014, 0),
+    FB4(020, 0), FB4(024, 0), FB4(030, 0), FB4(034, 0),
+    FB4(030, 1)
+};
+
+#undef UE
+#undef UF
+#undef UF4
+#undef BE
+#undef BF
+#undef BF4
+#undef FB4
+#undef B1FB4
+
 //------------------------------------------------------------------------
 // The difference between PseudoToEBanked and PseudoToSegmented is simply
 // that in the case of the former E-banks are used in preference to 
@@ -40,44 +103,16 @@
 // whenever possible.
 void PseudoToEBanked(int Value, ParseOutput_t *OutRecord)
 {
-    OutRecord->ProgramCounter = (const Address_t) { 0 };
-
     if (Value < 0 || Value > 0117777) {
+        OutRecord->ProgramCounter = (const Address_t) { 0 };
         strcpy(OutRecord->ErrorMessage, "Addresses must be between 0 and 0117777.");
         OutRecord->Fatal = 1;
         OutRecord->ProgramCounter.Invalid = 1;
         return;
     }
 
-    if (Value <= 03777) {
-        OutRecord->ProgramCounter.Address = 1;
-        OutRecord->ProgramCounter.Erasable = 1;
-        OutRecord->ProgramCounter.Banked = 1;
-        OutRecord->ProgramCounter.SReg = 01400 + (Value & 0377);
-        OutRecord->ProgramCounter.EB = Value / 0400;
-    } else if (Value <= 07777) {
-        OutRecord->ProgramCounter.Address = 1;
-        OutRecord->ProgramCounter.Fixed = 1;
-        OutRecord->ProgramCounter.Unbanked = 1;
-        OutRecord->ProgramCounter.SReg = Value;
-    } else {
-        OutRecord->ProgramCounter.Address = 1;
-        OutRecord->ProgramCounter.Fixed = 1;
-        OutRecord->ProgramCounter.Banked = 1;
-        OutRecord->ProgramCounter.SReg = 02000 + (Value & 01777);
-
-        if (Value >= 04000 && Value <= 05777)
-            OutRecord->ProgramCounter.FB = 2;
-        else if (Value >= 06000 && Value <= 07777)
-            OutRecord->ProgramCounter.FB = 3;
-        else if (Value < 0110000)
-            OutRecord->ProgramCounter.FB = (Value - 010000) / 02000;
-        else  {
-            OutRecord->ProgramCounter.Super = 1;
-            OutRecord->ProgramCounter.FB = (Value - 030000) / 02000;
-        } 
-    }
-
+    OutRecord->ProgramCounter = EBankedSegments[Value >> 8];
+    OutRecord->ProgramCounter.SReg += Value & 0377;
     OutRecord->ProgramCounter.Value = Value;
 }
 
@@ -93,49 +128,14 @@ void PseudoToSegmented(int Value, ParseOutput_t *OutRecord)
 
 int PseudoToStruct(int Value, Address_t *Address)
 {
-    *Address = VALID_ADDRESS;
-
     if (Value < 0 || Value > 0117777) {
+        *Address = VALID_ADDRESS;
         Address->Invalid = 1;
         return (1);
     }
 
-    if ((Block1 && Value <= 01777) || Value <= 01377) {
-        Address->Address = 1;
-        Address->Erasable = 1;
-        Address->Unbanked = 1;
-        Address->SReg = Value;
-    } else if (!Block1 && Value <= 03777) {
-        Address->Address = 1;
-        Address->Erasable = 1;
-        Address->Banked = 1;
-        Address->SReg = 01400 + (Value & 0377);
-        Address->EB = Value / 0400;
-    } else if ((!Block1 && Value <= 07777) || (Block1 && Value <= 05777)) {
-        Address->Address = 1;
-        Address->Fixed = 1;
-        Address->Unbanked = 1;
-        Address->SReg = Value;
-    } else {
-        Address->Address = 1;
-        Address->Fixed = 1;
-        Address->Banked = 1;
-        Address->SReg = Block1 ? (06000 + (Value & 01777)) : (02000 + (Value & 01777));
-
-        if (Block1)
-            Address->FB = 3 + (Value - 06000) / 02000;
-        else if (Value >= 04000 && Value <= 05777)
-            Address->FB = 2;
-        else if (Value >= 06000 && Value <= 07777)
-            Address->FB = 3;
-        else if (Value < 0110000)
-            Address->FB = (Value - 010000) / 02000;
-        else {
-            Address->Super = 1;
-            Address->FB = (Value - 030000) / 02000;
-        }
-    }
-
+    *Address = (Block1 ? Block1Segments : Segments)[Value >> 8];
+    Address->SReg += Value & 0377;
     Address->Value = Value;
 
     return (0);
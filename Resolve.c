@@ -0,0 +1,604 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    Resolve.c
+ * Purpose:     Keeps track of what each source line depended upon during
+ *              the symbol-resolution passes, so that on the next pass only
+ *              the lines which could possibly come out differently need to
+ *              be evaluated again.
+ * Mod History: 2026-10-17 AGT  Began.
+ *              2026-10-17 AGT  Added ResolveClear().
+ *              2026-10-17 AGT  Added ResolveConverged().
+ *              2026-10-17 AGT  Added ResolveRenumber(), since the symbols
+ *                              may now be sorted after the first pass.
+ *              2026-10-17 AGT  Added the operand cache.
+ *              2026-10-17 AGT  Recording stops, rather than the program
+ *                              exiting, if memory runs out.
+ *
+ * The main program calls Pass(0) over and over until the symbol values stop
+ * changing, and for most of the source lines nothing changes from one of
+ * these passes to the next.  What a line does in Pass(0) depends only on:
+ *
+ *   1. The state carried over from the preceding line (program counter,
+ *      banks, INDEX/EXTEND, the interpretive-operand bookkeeping, and so on),
+ *      which Pass() packs into a LineState_t.
+ *   2. The values of the symbols it looks up with GetSymbol().
+ *   3. The fixed-bank usage counts, for BANK, BLOCK, BBCON and SECSIZ.
+ *
+ * and what it does is simply to produce a new LineState_t, assign values to
+ * zero or more symbols with EditSymbolNew(), and bump the bank-usage counts.
+ * So for each line evaluated we record the state before and after, the
+ * symbols read, and the symbols assigned.  On the next pass, if the state
+ * before the line is the same as last time, and none of the symbols read
+ * has changed since the line was evaluated, the line is skipped:  the
+ * recorded assignments are repeated and the recorded state after it is
+ * used instead.  Lines which touch the bank-usage counts are marked
+ * volatile, and are always evaluated.
+ *
+ * "Changed since the line was evaluated" is determined by keeping a clock
+ * which ticks every time any symbol's value actually changes, and stamping
+ * each symbol with the clock at its last change.
+ *
+ * The lines are identified by their order of evaluation within the pass,
+ * which is the same from one pass to the next, since the files read don't
+ * change.  (The same file can be included more than once, so the
+ * SourceLine_t isn't enough by itself, though it's checked too.)
+ *
+ * The same records tell us when the passes have converged.  If, during a
+ * pass, no symbol changed after some line had read it, and no symbol
+ * changed more than once, then every line of the next pass would be
+ * skipped, starting from the same state as this time, and repeating the
+ * same assignments without changing anything.  That pass would be a waste
+ * of time, and ResolveConverged() says so.  This is tracked as the reads
+ * and assignments happen, by stamping each symbol with the pass in which
+ * it was last read and last assigned.
+ *
+ * Even a line which has to be evaluated again, such as any line in the
+ * final pass, usually has the same operand as last time, referring to a
+ * symbol whose value hasn't changed.  So FetchSymbolPlusOffset() keeps what
+ * it made of each line's operand in an OperandCache_t, which is reused as
+ * long as the operand text is the same and the symbol hasn't changed since
+ * (according to the same clock).  Lines are again identified by their order
+ * within the pass, but this time skipped lines are counted too, and the
+ * entries are kept even when the records are forgotten.
+ *
+ * If memory runs out, everything here stops:  every line is evaluated and
+ * nothing is recorded or cached for the rest of the pass, after which the
+ * assembly fails anyway.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+//-------------------------------------------------------------------------
+// Some global data.
+
+extern ASSEMBLY Line_t CurrentFilename;
+
+// An assignment made to a symbol by a line.
+typedef struct
+{
+  int Symbol;
+  Address_t Value;
+  int Type;
+  unsigned LineNumber;
+} ResolveEdit_t;
+
+// What we know about a line from the last time it was evaluated.
+typedef struct
+{
+  SourceLine_t *Line;
+  int RawTokens;
+  unsigned Valid :1;
+  unsigned Volatile :1;
+  unsigned Clock;                       // SymbolClock when evaluated.
+  LineState_t Before, After;
+  int *Reads;
+  int NumReads, MaxReads;
+  ResolveEdit_t *Edits;
+  int NumEdits, MaxEdits;
+} ResolveRecord_t;
+
+static ASSEMBLY ResolveRecord_t *Records = NULL;
+static ASSEMBLY int NumRecords = 0, MaxRecords = 0;
+
+// What we know about each symbol, indexed by symbol number:  the clock at
+// its last change, and the passes in which it was last read and assigned.
+typedef struct
+{
+  unsigned Stamp;
+  unsigned ReadPass, EditPass;
+} ResolveSymbol_t;
+static ASSEMBLY unsigned SymbolClock = 0;
+static ASSEMBLY ResolveSymbol_t *SymbolStamps = NULL;
+static ASSEMBLY int NumSymbolStamps = 0, MaxSymbolStamps = 0;
+
+// Whether skipping is allowed in the current pass, and the line (if any)
+// whose dependencies are currently being recorded.
+static ASSEMBLY int Enabled = 0;
+static ASSEMBLY ResolveRecord_t *Recording = NULL;
+static ASSEMBLY int NextRecord = 0;
+
+// The number of the current pass, and whether it has (so far) reached a
+// fixed point.
+static ASSEMBLY unsigned PassNumber = 0;
+static ASSEMBLY int Settled = 0;
+
+// Statistics for the most recent pass.
+ASSEMBLY int LinesEvaluated = 0, LinesSkipped = 0;
+
+// The operand cache.  OperandIndex[] gives, for each line, the index of its
+// entry in OperandCaches[], or -1 if it has none.  CurrentLine is the line
+// being evaluated, and CachedLine is the last line to have used its entry.
+static ASSEMBLY int *OperandIndex = NULL;
+static ASSEMBLY int NumOperandIndex = 0, MaxOperandIndex = 0;
+static ASSEMBLY OperandCache_t *OperandCaches = NULL;
+static ASSEMBLY int NumOperandCaches = 0, MaxOperandCaches = 0;
+static ASSEMBLY int CurrentLine = -1, CachedLine = -1;
+ASSEMBLY unsigned long OperandHits = 0, OperandMisses = 0;
+
+//-------------------------------------------------------------------------
+// Throw away everything known about the lines.
+static void
+ForgetRecords(void)
+{
+  int i;
+
+  for (i = 0; i < NumRecords; i++)
+    Records[i].Valid = 0;
+}
+
+//-------------------------------------------------------------------------
+// Give up, having run out of memory.
+static void
+NoMemory(void)
+{
+  fprintf(LISTING, "Out of memory (5).\n");
+  OutOfMemory = 1;
+  Recording = NULL;
+}
+
+//-------------------------------------------------------------------------
+// Make sure that there are stamps for symbols 0 through Symbol.  (Symbols
+// may be added during the first pass.)  Returns non-zero if memory ran
+// out, now or before.
+static int
+GrowStamps(int Symbol)
+{
+  ResolveSymbol_t *Stamps;
+  int NewMax;
+
+  if (OutOfMemory)
+    return (1);
+  if (Symbol < NumSymbolStamps)
+    return (0);
+  if (Symbol >= MaxSymbolStamps)
+    {
+      NewMax = MaxSymbolStamps ? 2 * MaxSymbolStamps : 16384;
+      while (Symbol >= NewMax)
+        NewMax *= 2;
+      Stamps = (ResolveSymbol_t *) realloc(SymbolStamps,
+          NewMax * sizeof(ResolveSymbol_t));
+      if (Stamps == NULL)
+        {
+          NoMemory();
+          return (1);
+        }
+      SymbolStamps = Stamps;
+      MaxSymbolStamps = NewMax;
+    }
+  memset(&SymbolStamps[NumSymbolStamps], 0,
+      (Symbol + 1 - NumSymbolStamps) * sizeof(ResolveSymbol_t));
+  NumSymbolStamps = Symbol + 1;
+  return (0);
+}
+
+//-------------------------------------------------------------------------
+// Release everything, at the end of an assembly.
+void
+ResolveClear(void)
+{
+  int i;
+
+  for (i = 0; i < NumRecords; i++)
+    {
+      free(Records[i].Reads);
+      free(Records[i].Edits);
+    }
+  free(Records);
+  Records = NULL;
+  NumRecords = MaxRecords = NextRecord = 0;
+  free(SymbolStamps);
+  SymbolStamps = NULL;
+  NumSymbolStamps = MaxSymbolStamps = 0;
+  SymbolClock = 0;
+  Recording = NULL;
+  PassNumber = 0;
+  Settled = 0;
+  free(OperandIndex);
+  OperandIndex = NULL;
+  NumOperandIndex = MaxOperandIndex = 0;
+  free(OperandCaches);
+  OperandCaches = NULL;
+  NumOperandCaches = MaxOperandCaches = 0;
+  CurrentLine = CachedLine = -1;
+  OperandHits = OperandMisses = 0;
+}
+
+//-------------------------------------------------------------------------
+// Call at the start of each pass.  If Enable is zero, every line will be
+// evaluated, and nothing is recorded; this is the case for the final pass,
+// for --debug, and so on.
+void
+ResolveStartPass(int Enable)
+{
+  Enabled = Enable;
+  Recording = NULL;
+  NextRecord = 0;
+  CurrentLine = CachedLine = -1;
+  LinesEvaluated = LinesSkipped = 0;
+  PassNumber++;
+  Settled = Enabled;
+  if (!Enabled)
+    ForgetRecords();
+}
+
+//-------------------------------------------------------------------------
+// Called by SortSymbols() when the symbols have been renumbered:  symbol
+// number i (of OldCount) is now NewNumbers[i] (of NewCount), or -1 if it
+// has been removed.  Lines which used a removed symbol must be evaluated
+// again.
+void
+ResolveRenumber(const int *NewNumbers, int OldCount, int NewCount)
+{
+  ResolveSymbol_t *Stamps;
+  int i, j;
+
+  if (OutOfMemory)
+    return;
+  Stamps = (ResolveSymbol_t *) calloc(NewCount + 1, sizeof(ResolveSymbol_t));
+  if (Stamps == NULL)
+    {
+      NoMemory();
+      return;
+    }
+
+  for (i = 0; i < NumRecords; i++)
+    {
+      ResolveRecord_t *Record = &Records[i];
+      for (j = 0; j < Record->NumReads; j++)
+        if (Record->Reads[j] >= OldCount || NewNumbers[Record->Reads[j]] < 0)
+          Record->Valid = 0;
+        else
+          Record->Reads[j] = NewNumbers[Record->Reads[j]];
+      for (j = 0; j < Record->NumEdits; j++)
+        if (Record->Edits[j].Symbol >= OldCount
+            || NewNumbers[Record->Edits[j].Symbol] < 0)
+          Record->Valid = 0;
+        else
+          Record->Edits[j].Symbol = NewNumbers[Record->Edits[j].Symbol];
+    }
+  for (i = 0; i < NumOperandCaches; i++)
+    {
+      OperandCache_t *Entry = &OperandCaches[i];
+      if (!Entry->Filled || Entry->IsNumber)
+        continue;
+      if (Entry->Symbol >= OldCount || NewNumbers[Entry->Symbol] < 0)
+        Entry->Filled = 0;
+      else
+        Entry->Symbol = NewNumbers[Entry->Symbol];
+    }
+
+  for (i = 0; i < OldCount && i < NumSymbolStamps; i++)
+    if (NewNumbers[i] >= 0)
+      Stamps[NewNumbers[i]] = SymbolStamps[i];
+  free(SymbolStamps);
+  SymbolStamps = Stamps;
+  NumSymbolStamps = NewCount;
+  MaxSymbolStamps = NewCount + 1;
+}
+
+//-------------------------------------------------------------------------
+// Call for each source line, just before evaluating it, with the state
+// carried over from the preceding line.  Returns 0 if the line must be
+// evaluated, in which case its dependencies are recorded until
+// ResolveEndLine() is called.  Returns 1 if the line can be skipped, in
+// which case its symbol assignments have been repeated, and State has
+// been replaced by the state following the line.
+int
+ResolveBeginLine(SourceLine_t *Line, int RawTokens, LineState_t *State)
+{
+  ResolveRecord_t *Record;
+  int i;
+
+  // A line whose evaluation was abandoned partway can't be repeated.
+  if (Recording != NULL)
+    Settled = 0;
+  Recording = NULL;
+  CurrentLine++;
+  if (!Enabled || OutOfMemory)
+    {
+      LinesEvaluated++;
+      return (0);
+    }
+
+  if (NextRecord == MaxRecords)
+    {
+      i = MaxRecords ? 2 * MaxRecords : 4096;
+      Record = (ResolveRecord_t *) realloc(Records,
+          i * sizeof(ResolveRecord_t));
+      if (Record == NULL)
+        {
+          NoMemory();
+          LinesEvaluated++;
+          return (0);
+        }
+      Records = Record;
+      MaxRecords = i;
+      memset(&Records[NextRecord], 0,
+          (MaxRecords - NextRecord) * sizeof(ResolveRecord_t));
+    }
+  Record = &Records[NextRecord++];
+  if (NextRecord > NumRecords)
+    NumRecords = NextRecord;
+
+  // Can we get away with not evaluating it?
+  if (Record->Valid && !Record->Volatile && Record->Line == Line
+      && Record->RawTokens == RawTokens
+      && !memcmp(&Record->Before, State, sizeof(LineState_t)))
+    {
+      for (i = 0; i < Record->NumReads; i++)
+        if (SymbolStamps[Record->Reads[i]].Stamp > Record->Clock)
+          break;
+      if (i >= Record->NumReads)
+        {
+          for (i = 0; i < Record->NumReads; i++)
+            SymbolStamps[Record->Reads[i]].ReadPass = PassNumber;
+          for (i = 0; i < Record->NumEdits; i++)
+            EditSymbolNumber(Record->Edits[i].Symbol, &Record->Edits[i].Value,
+                Record->Edits[i].Type, CurrentFilename,
+                Record->Edits[i].LineNumber);
+          *State = Record->After;
+          LinesSkipped++;
+          return (1);
+        }
+    }
+
+  // No, so start recording what it does.
+  Record->Line = Line;
+  Record->RawTokens = RawTokens;
+  Record->Valid = 0;
+  Record->Volatile = 0;
+  Record->Clock = SymbolClock;
+  Record->Before = *State;
+  Record->NumReads = Record->NumEdits = 0;
+  Recording = Record;
+  LinesEvaluated++;
+  return (0);
+}
+
+//-------------------------------------------------------------------------
+// Call after a line has been evaluated (but not after it has been skipped),
+// with the state following the line.
+void
+ResolveEndLine(LineState_t *State)
+{
+  if (Recording == NULL)
+    return;
+  Recording->After = *State;
+  Recording->Valid = 1;
+  Recording = NULL;
+}
+
+//-------------------------------------------------------------------------
+// Called by GetSymbol() whenever a symbol's value is looked up.
+void
+ResolveNoteRead(int Symbol)
+{
+  ResolveRecord_t *Record = Recording;
+  int i;
+
+  if (Record == NULL || GrowStamps(Symbol))
+    return;
+  SymbolStamps[Symbol].ReadPass = PassNumber;
+  for (i = 0; i < Record->NumReads; i++)
+    if (Record->Reads[i] == Symbol)
+      return;
+  if (Record->NumReads == Record->MaxReads)
+    {
+      int *Reads;
+      Reads = (int *) realloc(Record->Reads,
+          (Record->MaxReads + 4) * sizeof(int));
+      if (Reads == NULL)
+        {
+          NoMemory();
+          return;
+        }
+      Record->Reads = Reads;
+      Record->MaxReads += 4;
+    }
+  Record->Reads[Record->NumReads++] = Symbol;
+}
+
+//-------------------------------------------------------------------------
+// Called by EditSymbolNumber() whenever a symbol is assigned.  Changed is
+// non-zero if the symbol's value is different than before.
+void
+ResolveNoteEdit(int Symbol, Address_t *Value, int Type, unsigned LineNumber,
+    int Changed)
+{
+  ResolveRecord_t *Record = Recording;
+  ResolveSymbol_t *Stamps;
+  ResolveEdit_t *Edit;
+
+  if (GrowStamps(Symbol))
+    return;
+  Stamps = &SymbolStamps[Symbol];
+  if (Changed)
+    {
+      // Some line already used the old value, or the symbol has already
+      // been assigned a different value in this pass, so the next pass
+      // will be different.
+      if (Stamps->ReadPass == PassNumber || Stamps->EditPass == PassNumber)
+        Settled = 0;
+      Stamps->Stamp = ++SymbolClock;
+    }
+  Stamps->EditPass = PassNumber;
+
+  if (Record == NULL)
+    return;
+  if (Record->NumEdits == Record->MaxEdits)
+    {
+      Edit = (ResolveEdit_t *) realloc(Record->Edits,
+          (Record->MaxEdits + 2) * sizeof(ResolveEdit_t));
+      if (Edit == NULL)
+        {
+          NoMemory();
+          return;
+        }
+      Record->Edits = Edit;
+      Record->MaxEdits += 2;
+    }
+  Edit = &Record->Edits[Record->NumEdits++];
+  Edit->Symbol = Symbol;
+  Edit->Value = *Value;
+  Edit->Type = Type;
+  Edit->LineNumber = LineNumber;
+}
+
+//-------------------------------------------------------------------------
+// Called for anything that makes a line depend on something other than
+// the symbol table and the state carried from line to line --- the fixed-
+// bank usage counts, or messages printed even in Pass(0).  Such a line is
+// always evaluated.
+void
+ResolveVolatile(void)
+{
+  if (Recording != NULL)
+    Recording->Volatile = 1;
+}
+
+//-------------------------------------------------------------------------
+// Call after a pass.  Returns non-zero if another pass would be the same
+// as this one:  every line would be skipped, and no symbol would change.
+// The usage counts of the fixed banks, which some lines depend upon, must
+// not have changed since the preceding pass either.
+int
+ResolveConverged(void)
+{
+  if (Recording != NULL)
+    Settled = 0;
+  Recording = NULL;
+  return (Enabled && Settled && !OutOfMemory && NextRecord == NumRecords
+      && !BankCountsChanged());
+}
+
+//-------------------------------------------------------------------------
+// Called by FetchSymbolPlusOffset() to get the current line's operand-
+// cache entry.  If *Hit is set on return, the entry was made for the same
+// Operand and Mod1, and is still good.  Otherwise, the entry (if not NULL)
+// is for the caller to fill in.  There is no entry outside of the passes,
+// for a second operand on the same line, or for text too long to keep.
+OperandCache_t *
+ResolveOperandCache(const char *Operand, const char *Mod1, int *Hit)
+{
+  OperandCache_t *Entry;
+  int *Index;
+
+  *Hit = 0;
+  if (OutOfMemory || CurrentLine < 0 || CachedLine == CurrentLine
+      || strlen(Operand) > MAX_LABEL_LENGTH || strlen(Mod1) > MAX_LABEL_LENGTH)
+    return (NULL);
+  CachedLine = CurrentLine;
+
+  if (CurrentLine >= NumOperandIndex)
+    {
+      if (CurrentLine >= MaxOperandIndex)
+        {
+          int NewMax = MaxOperandIndex ? 2 * MaxOperandIndex : 4096;
+          while (CurrentLine >= NewMax)
+            NewMax *= 2;
+          Index = (int *) realloc(OperandIndex, NewMax * sizeof(int));
+          if (Index == NULL)
+            {
+              NoMemory();
+              return (NULL);
+            }
+          OperandIndex = Index;
+          MaxOperandIndex = NewMax;
+        }
+      memset(&OperandIndex[NumOperandIndex], -1,
+          (CurrentLine + 1 - NumOperandIndex) * sizeof(int));
+      NumOperandIndex = CurrentLine + 1;
+    }
+  if (OperandIndex[CurrentLine] < 0)
+    {
+      if (NumOperandCaches == MaxOperandCaches)
+        {
+          int NewMax = MaxOperandCaches ? 2 * MaxOperandCaches : 4096;
+          Entry = (OperandCache_t *) realloc(OperandCaches,
+              NewMax * sizeof(OperandCache_t));
+          if (Entry == NULL)
+            {
+              NoMemory();
+              return (NULL);
+            }
+          OperandCaches = Entry;
+          MaxOperandCaches = NewMax;
+        }
+      memset(&OperandCaches[NumOperandCaches], 0, sizeof(OperandCache_t));
+      OperandIndex[CurrentLine] = NumOperandCaches++;
+    }
+  Entry = &OperandCaches[OperandIndex[CurrentLine]];
+
+  if (Entry->Filled && !strcmp(Entry->Operand, Operand)
+      && !strcmp(Entry->Mod1, Mod1)
+      && (Entry->IsNumber || Entry->Symbol >= NumSymbolStamps
+          || SymbolStamps[Entry->Symbol].Stamp <= Entry->Clock))
+    {
+      OperandHits++;
+      *Hit = 1;
+      return (Entry);
+    }
+  OperandMisses++;
+  strcpy(Entry->Operand, Operand);
+  strcpy(Entry->Mod1, Mod1);
+  Entry->Filled = 0;
+  Entry->Clock = SymbolClock;
+  return (Entry);
+}
+
+//-------------------------------------------------------------------------
+// The number of lines begun so far in this pass, which identifies the
+// next line's operand-cache entry.  When the final pass is split up (see
+// ParallelPass.c), each piece picks up the count where it begins.
+int
+ResolveLineCount(void)
+{
+  return (CurrentLine + 1);
+}
+
+void
+ResolveSetLineCount(int Count)
+{
+  CurrentLine = Count - 1;
+  CachedLine = -1;
+}
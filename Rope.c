@@ -0,0 +1,150 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    Rope.c
+ * Purpose:     Writing the core-rope image (the .bin file).
+ * Mod History: 2026-10-17 AGT  Began.
+ *              2026-10-17 AGT  The parity bits are worked out here, from
+ *                              ObjectCode[] alone.
+ *              2026-10-17 AGT  The image is allocated by RopeStart() and
+ *                              freed by RopeFinish(), rather than being
+ *                              thread-local.
+ *
+ * The banks are packed one after another, in the order RopeAddBank() is
+ * called, into an image held in memory, and RopeFinish() then writes the
+ * whole thing at once.  Each word is stored big-endian, shifted left by
+ * one bit, with the parity bit placed according to the format:
+ *
+ *   ROPE_PLAIN     No parity; bit 0 is 0.
+ *   ROPE_PARITY    Parity in bit 0, as yaAGC expects.
+ *   ROPE_HARDWARE  Parity in bit 15 and the data in bits 14-0, as in
+ *                  the AGC hardware.
+ *
+ * Only the words marked OBJECT_WRITTEN get a parity bit, so unused words
+ * are all 0.  The format is checked once per bank rather than once per
+ * word, so each inner loop is straight-line code the compiler can
+ * vectorize.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#ifdef MSC_VS
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+//-------------------------------------------------------------------------
+// Some global data.
+
+#define ROPE_SIZE (044 * 02000 * 2)
+static ASSEMBLY unsigned char *RopeImage = NULL;
+static ASSEMBLY int RopeLength = 0;
+static ASSEMBLY int RopeFormat = ROPE_PLAIN;
+
+//-------------------------------------------------------------------------
+// Begin a new image, in one of the ROPE_xxx formats.  Returns 0 on
+// success, or non-zero if out of memory.
+int
+RopeStart(int Format)
+{
+  RopeLength = 0;
+  RopeFormat = Format;
+  if (RopeImage == NULL)
+    RopeImage = (unsigned char *) malloc(ROPE_SIZE);
+  if (RopeImage == NULL)
+    {
+      fprintf(LISTING, "Out of memory (12).\n");
+      return (1);
+    }
+  return (0);
+}
+
+//-------------------------------------------------------------------------
+// Append a bank of ObjectCode[] to the image.
+void
+RopeAddBank(int Bank)
+{
+  const uint16_t *Code = ObjectCode[Bank];
+  unsigned char *Out;
+  int Offset, Word, Parity, Value;
+
+  if (RopeImage == NULL || RopeLength + 2 * 02000 > ROPE_SIZE)
+    return;
+  Out = &RopeImage[RopeLength];
+  RopeLength += 2 * 02000;
+
+  switch (RopeFormat)
+    {
+  case ROPE_HARDWARE:
+    for (Offset = 0; Offset < 02000; Offset++)
+      {
+        Word = Code[Offset];
+        Parity = (Word >> 15) & PARITY16(Word & 077777);
+        Value = (Word & 077777) << 1;
+        Value = (Value & 0100000) | (Parity << 14) | ((Value & 077776) >> 1);
+        Out[2 * Offset] = (unsigned char) (Value >> 8);
+        Out[2 * Offset + 1] = (unsigned char) Value;
+      }
+    break;
+  case ROPE_PARITY:
+    for (Offset = 0; Offset < 02000; Offset++)
+      {
+        Word = Code[Offset];
+        Parity = (Word >> 15) & PARITY16(Word & 077777);
+        Value = ((Word & 077777) << 1) | Parity;
+        Out[2 * Offset] = (unsigned char) (Value >> 8);
+        Out[2 * Offset + 1] = (unsigned char) Value;
+      }
+    break;
+  default:
+    for (Offset = 0; Offset < 02000; Offset++)
+      {
+        Value = (Code[Offset] & 077777) << 1;
+        Out[2 * Offset] = (unsigned char) (Value >> 8);
+        Out[2 * Offset + 1] = (unsigned char) Value;
+      }
+    break;
+    }
+}
+
+//-------------------------------------------------------------------------
+// Write the image to Output, which may be stdout or a pipe as well as an
+// ordinary file, and free it.  Returns 0 on success, non-zero on error.
+int
+RopeFinish(FILE *Output)
+{
+  int RetVal = 0;
+
+#ifdef MSC_VS
+  if (Output == stdout)
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+  if (RopeLength > 0
+      && fwrite(RopeImage, 1, RopeLength, Output) != (size_t) RopeLength)
+    RetVal = 1;
+  else if (fflush(Output))
+    RetVal = 1;
+  free(RopeImage);
+  RopeImage = NULL;
+  RopeLength = 0;
+  return (RetVal);
+}
@@ -0,0 +1,567 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    SourceLines.c
+ * Purpose:     An in-memory cache of the source files, so that SymbolPass()
+ *              and the successive calls to Pass() don't have to go back to
+ *              the filesystem, nor repeat the tab-expansion, .yul-card
+ *              conversion, comment-splitting and field-splitting, for every
+ *              line on every pass.
+ * Mod History: 2026-10-17 AGT  Began.
+ *              2026-10-17 AGT  Added ClearSourceFiles().
+ *              2026-10-17 AGT  Files are memory-mapped, and lines are
+ *                              slices of the mapping rather than copies.
+ *              2026-10-17 AGT  Tokenize() finds the comment with strchr()
+ *                              and the fields with a table lookup.
+ *              2026-10-17 AGT  GetSourceFile() returns NULL if memory runs
+ *                              out, rather than exiting.
+ *              2026-10-17 AGT  Added TokenizeSourceLine(), which bypasses
+ *                              the cached tokenizations.
+ *
+ * Each source file (the top-level file or any $-included file) is mapped
+ * into memory the first time some pass asks for it (or simply read, where
+ * mmap() isn't available), and is thereafter described by an array of
+ * SourceLine_t records giving the position and length of each line within
+ * that image.  No line is copied unless the --simulation or .yul "#>"
+ * conversions change it.  A line is everything up to and including the
+ * next '\n', however long; a line longer than MAX_LINE_LENGTH is cut short
+ * only when it's split into fields, and Pass() warns about it.  The
+ * tokenization of a line (i.e., its split into fields) is computed the
+ * first time it is needed, and is reused on every subsequent pass.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#ifndef MSC_VS
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+//-------------------------------------------------------------------------
+// Some global data.
+
+// All of the source files which have been read so far.
+static ASSEMBLY SourceFile_t **SourceFiles = NULL;
+static ASSEMBLY int NumSourceFiles = 0, MaxSourceFiles = 0;
+
+// The characters which separate fields, i.e., those for which isspace() is
+// true in the "C" locale.  Indexed by unsigned char.
+static const unsigned char IsBlank[256] =
+  { ['\t'] = 1, ['\n'] = 1, ['\v'] = 1, ['\f'] = 1, ['\r'] = 1, [' '] = 1 };
+
+//-------------------------------------------------------------------------
+// Get the whole contents of a file into memory, by mapping it if possible.
+// Returns 0 on success, or non-zero if the file can't be read (or memory
+// runs out, in which case OutOfMemory is set).
+static int
+LoadImage(SourceFile_t *File, const char *Filename)
+{
+  FILE *InputFile;
+  char *Image = NULL;
+  size_t Size = 0, MaxSize = 0, n;
+
+#ifndef MSC_VS
+  struct stat Stat;
+  int fd;
+
+  fd = open(Filename, O_RDONLY);
+  if (fd < 0)
+    return (1);
+  if (!fstat(fd, &Stat) && S_ISREG(Stat.st_mode))
+    {
+      void *Map = NULL;
+      if (Stat.st_size > 0)
+        Map = mmap(NULL, Stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (Map != MAP_FAILED)
+        {
+          close(fd);
+          File->Image = (const char *) Map;
+          File->ImageSize = Stat.st_size;
+          File->Mapped = (Map != NULL);
+          return (0);
+        }
+    }
+  close(fd);
+#endif
+
+  // Not a regular file, or no mmap(), so just read it.
+  InputFile = fopen(Filename, "rb");
+  if (InputFile == NULL)
+    return (1);
+  do
+    {
+      if (Size == MaxSize)
+        {
+          char *NewImage;
+
+          MaxSize = MaxSize ? 2 * MaxSize : 65536;
+          NewImage = (char *) realloc(Image, MaxSize);
+          if (NewImage == NULL)
+            {
+              fprintf(LISTING, "Out of memory (4).\n");
+              OutOfMemory = 1;
+              free(Image);
+              fclose(InputFile);
+              return (1);
+            }
+          Image = NewImage;
+        }
+      n = fread(&Image[Size], 1, MaxSize - Size, InputFile);
+      Size += n;
+    }
+  while (n > 0);
+  fclose(InputFile);
+  File->Image = Image;
+  File->ImageSize = Size;
+  File->Mapped = 0;
+  return (0);
+}
+
+// Do the Length characters at Text contain the string Pattern?
+static int
+SliceContains(const char *Text, int Length, const char *Pattern)
+{
+  int i, n = strlen(Pattern);
+
+  for (i = 0; i + n <= Length; i++)
+    if (Text[i] == Pattern[0] && !memcmp(&Text[i], Pattern, n))
+      return (1);
+  return (0);
+}
+
+//-------------------------------------------------------------------------
+// Release a source file, along with everything made from its lines.
+static void
+FreeSourceFile(SourceFile_t *File)
+{
+  SourceLine_t *Line;
+  int j;
+
+  for (j = 0; j < File->NumLines; j++)
+    {
+      Line = &File->Lines[j];
+      if (Line->PreparedTokens != NULL
+          && Line->PreparedTokens != Line->RawTokens)
+        {
+          free(Line->PreparedTokens->Text);
+          free(Line->PreparedTokens);
+        }
+      if (Line->RawTokens != NULL)
+        {
+          free(Line->RawTokens->Text);
+          free(Line->RawTokens);
+        }
+      free(Line->Prepared);
+    }
+#ifndef MSC_VS
+  if (File->Mapped)
+    munmap((void *) File->Image, File->ImageSize);
+  else
+#endif
+    free((void *) File->Image);
+  free(File->Lines);
+  free(File);
+}
+
+//-------------------------------------------------------------------------
+// Read a source file into memory.  Returns NULL if the file can't be read,
+// or if memory runs out (setting OutOfMemory).
+static SourceFile_t *
+ReadSourceFile(const char *Filename)
+{
+  SourceFile_t *File;
+  const char *Next, *End, *Newline;
+  int MaxLines = 0, k;
+
+  File = (SourceFile_t *) calloc(1, sizeof(SourceFile_t));
+  if (File == NULL)
+    goto NoMemory;
+  if (LoadImage(File, Filename))
+    {
+      free(File);
+      return (NULL);
+    }
+  strcpy(File->Filename, Filename);
+  File->yulType = (NULL != strstr(Filename, ".yul"));
+
+  End = File->Image + File->ImageSize;
+  for (Next = File->Image; Next < End;)
+    {
+      SourceLine_t *Line;
+      const char *p;
+      int Length;
+
+      if (File->NumLines == MaxLines)
+        {
+          MaxLines = MaxLines ? 2 * MaxLines : 1024;
+          Line = (SourceLine_t *) realloc(File->Lines,
+              MaxLines * sizeof(SourceLine_t));
+          if (Line == NULL)
+            goto NoMemory;
+          File->Lines = Line;
+        }
+      Line = &File->Lines[File->NumLines++];
+      memset(Line, 0, sizeof(*Line));
+      Newline = (const char *) memchr(Next, '\n', End - Next);
+      Line->Text = p = Next;
+      Line->Length = Length =
+          (Newline != NULL) ? (Newline + 1 - Next) : (End - Next);
+      Next += Length;
+
+      // For --simulation.  Lines marked for the "wrong" mode are converted
+      // to comments.
+      if (p[0] != '#')
+        if ((Simulation && SliceContains(p, Length, "-SIMULATION"))
+            || (!Simulation && SliceContains(p, Length, "+SIMULATION")))
+          {
+            Line->Prepared = (char *) malloc(Length + 2);
+            if (Line->Prepared == NULL)
+              goto NoMemory;
+            Line->Prepared[0] = '#';
+            memcpy(&Line->Prepared[1], p, Length);
+            Line->Prepared[Length + 1] = 0;
+            p = Line->Prepared;
+            Length++;
+          }
+
+      // Classify the line for the purpose of detecting the ## file header.
+      for (k = 0; k < Length && p[k] && isspace(p[k]); k++)
+        ;
+      if (k == Length || p[k] == 0)
+        Line->Blank = 1;
+      else if (Length >= 2 && p[0] == '#' && p[1] == '#')
+        {
+          char Page[32];
+          k = (Length < sizeof(Page)) ? Length : sizeof(Page) - 1;
+          memcpy(Page, p, k);
+          Page[k] = 0;
+          if (1 != sscanf(Page, "## Page%d", &k))
+            Line->PoundPound = 1;
+        }
+
+      // Convert the construct "#>' (column 1) used in .yul files to an
+      // indented ##-style comment.
+      if (File->yulType && Length >= 2 && p[0] == '#' && p[1] == '>')
+        {
+          char *q;
+          q = (char *) malloc(6 + Length + 1);
+          if (q == NULL)
+            goto NoMemory;
+          memset(q, '\t', 6);
+          memcpy(&q[6], p, Length);
+          q[7] = '#';
+          q[6 + Length] = 0;
+          free(Line->Prepared);
+          Line->Prepared = q;
+        }
+    }
+
+  return (File);
+
+  NoMemory:
+  fprintf(LISTING, "Out of memory (4).\n");
+  OutOfMemory = 1;
+  if (File != NULL)
+    FreeSourceFile(File);
+  return (NULL);
+}
+
+//-------------------------------------------------------------------------
+// Find a source file in the cache, reading it if this is the first time
+// it has been asked for.  Returns NULL if the file doesn't exist, or if
+// memory runs out (setting OutOfMemory).
+SourceFile_t *
+GetSourceFile(const char *Filename)
+{
+  SourceFile_t *File;
+  int i;
+
+  for (i = 0; i < NumSourceFiles; i++)
+    if (!strcmp(SourceFiles[i]->Filename, Filename))
+      return (SourceFiles[i]);
+
+  if (strlen(Filename) > MAX_LINE_LENGTH)
+    return (NULL);
+  File = ReadSourceFile(Filename);
+  if (File == NULL)
+    return (NULL);
+
+  if (NumSourceFiles == MaxSourceFiles)
+    {
+      SourceFile_t **NewFiles;
+
+      NewFiles = (SourceFile_t **) realloc(SourceFiles,
+          (MaxSourceFiles + 64) * sizeof(SourceFile_t *));
+      if (NewFiles == NULL)
+        {
+          fprintf(LISTING, "Out of memory (4).\n");
+          OutOfMemory = 1;
+          FreeSourceFile(File);
+          return (NULL);
+        }
+      SourceFiles = NewFiles;
+      MaxSourceFiles += 64;
+    }
+  SourceFiles[NumSourceFiles++] = File;
+  return (File);
+}
+
+//-------------------------------------------------------------------------
+// Throw away all of the source files read so far.
+void
+ClearSourceFiles(void)
+{
+  int i;
+
+  for (i = 0; i < NumSourceFiles; i++)
+    FreeSourceFile(SourceFiles[i]);
+  free(SourceFiles);
+  SourceFiles = NULL;
+  NumSourceFiles = MaxSourceFiles = 0;
+}
+
+//-------------------------------------------------------------------------
+// Position a cursor at the beginning of a source file.  Returns 0 on success,
+// or non-zero if the file doesn't exist.
+int
+OpenSource(SourceCursor_t *Cursor, const char *Filename)
+{
+  Cursor->File = GetSourceFile(Filename);
+  Cursor->Next = 0;
+  return (Cursor->File == NULL);
+}
+
+//-------------------------------------------------------------------------
+// Advance the cursor to the next line of the file, returning a pointer to
+// its record, or NULL at the end of the file.
+SourceLine_t *
+NextSourceLine(SourceCursor_t *Cursor)
+{
+  if (Cursor == NULL || Cursor->File == NULL
+      || Cursor->Next >= Cursor->File->NumLines)
+    return (NULL);
+  return (&Cursor->File->Lines[Cursor->Next++]);
+}
+
+//-------------------------------------------------------------------------
+// Copy the text of a line into a buffer of Size characters, as fgets()
+// would have read it.  If Raw is zero, it's the text after the --simulation
+// and .yul "#>" conversions.  Returns s.
+char *
+SourceText(char *s, int Size, const SourceLine_t *Line, int Raw)
+{
+  const char *Text = Line->Text;
+  int Length = Line->Length;
+
+  if (!Raw && Line->Prepared != NULL)
+    {
+      Text = Line->Prepared;
+      Length = strlen(Text);
+    }
+  if (Length > Size - 1)
+    Length = Size - 1;
+  memcpy(s, Text, Length);
+  s[Length] = 0;
+  return (s);
+}
+
+// The first character of a line, after the --simulation and .yul "#>"
+// conversions, or 0 if the line is empty.
+int
+SourceFirstChar(const SourceLine_t *Line)
+{
+  if (Line->Prepared != NULL)
+    return (Line->Prepared[0]);
+  return (Line->Length > 0 ? Line->Text[0] : 0);
+}
+
+//-------------------------------------------------------------------------
+// A replacement for fgets(), for those places (like HtmlCheck) which want
+// the raw text of the next line.  Size is interpreted as by fgets().
+char *
+SourceGets(char *s, int Size, SourceCursor_t *Cursor)
+{
+  SourceLine_t *Line;
+
+  Line = NextSourceLine(Cursor);
+  if (Line == NULL)
+    return (NULL);
+  return (SourceText(s, Size, Line, 1));
+}
+
+//-------------------------------------------------------------------------
+// Split a line of source code into its fields.  This is what Pass() has
+// always done with each input line:  expand tabs to spaces, convert .yul
+// cards to .agc format, split off the comment, pull out the --block1
+// column-16 prefix (if Column16 is non-zero), and find the whitespace-
+// delimited fields.  The results are stored in a newly-allocated record.
+// Returns NULL if out of memory.
+static SourceTokens_t *
+Tokenize(const char *Text, int Length, int yulType, int Column16)
+{
+  SourceTokens_t *Tokens;
+  Line_t s;
+  const unsigned char *ss;
+  char *Comment;
+  int i, Column, Size, CodeLength;
+
+  Tokens = (SourceTokens_t *) calloc(1, sizeof(SourceTokens_t));
+  if (Tokens == NULL)
+    return (NULL);
+  Tokens->Column8 = ' ';
+
+  // Frankly, tabs and newlines will cause me a lot of problems further down, since
+  // there are actually a couple of things we need to use column alignment to check
+  // out.  So let's just start by expanding all tabs to spaces.  That's done as
+  // the line is copied, by keeping track of the column each character lands in.
+  for (i = Column = 0; i < Length && Text[i] && Text[i] != '\n'; i++)
+    if (Text[i] == '\t')
+      {
+        int tabStop = ((Column + 8) & ~7);
+        for (; Column < tabStop; Column++)
+          if (Column < MAX_LINE_LENGTH)
+            s[Column] = ' ';
+      }
+    else
+      {
+        if (Column < MAX_LINE_LENGTH)
+          s[Column] = Text[i];
+        Column++;
+      }
+  if (Column > MAX_LINE_LENGTH)
+    {
+      Tokens->Truncated = 1;
+      Column = MAX_LINE_LENGTH;
+    }
+  s[Column] = 0;
+
+  if (yulType)
+    yul2agc(s);
+
+  // Find and remove the comment field, if any.
+  Comment = strchr(s, COMMENT_SEPARATOR);
+  if (Comment != NULL)
+    {
+      CodeLength = Tokens->CommentColumn = Comment - s;
+      *Comment++ = 0;
+    }
+  else
+    {
+      CodeLength = strlen(s);
+      Comment = &s[CodeLength];
+    }
+  Tokens->CommentOffset = Comment - s;
+
+  if (Column16 && CodeLength >= 16)
+    {
+      Tokens->Column8 = s[15];
+      s[15] = ' ';
+      Tokens->InversionPending = (Tokens->Column8 == '-');
+    }
+
+  // Find the fields, just as sscanf("%s%s%s%s%s%s") would have, but giving
+  // their columns as well.  The NUL isn't blank, so it stops both loops.
+  for (ss = (const unsigned char *) s, i = 0; i < MAX_SOURCE_FIELDS; i++)
+    {
+      while (IsBlank[*ss])
+        ss++;
+      if (*ss == 0)
+        break;
+      Tokens->FieldStart[i] = (char *) ss - s;
+      while (*ss && !IsBlank[*ss])
+        ss++;
+      Tokens->FieldLength[i] = ((char *) ss - s) - Tokens->FieldStart[i];
+    }
+  Tokens->NumFields = i;
+
+  // Keep the whole buffer, up to the end of the comment.
+  Size = Tokens->CommentOffset + strlen(Comment) + 1;
+  Tokens->Text = (char *) malloc(Size);
+  if (Tokens->Text == NULL)
+    {
+      free(Tokens);
+      return (NULL);
+    }
+  memcpy(Tokens->Text, s, Size);
+  Tokens->TextSize = Size;
+
+  return (Tokens);
+}
+
+//-------------------------------------------------------------------------
+// Get the tokenization of a source line, as used by Pass().  If Raw is
+// non-zero, then it's the tokenization of the line's raw text; otherwise,
+// it's the tokenization of the line's text after the --simulation and
+// .yul "#>" conversions.  Returns NULL if out of memory.
+SourceTokens_t *
+GetSourceTokens(SourceFile_t *File, SourceLine_t *Line, int Raw)
+{
+  if (Raw || Line->Prepared == NULL)
+    {
+      if (Line->RawTokens == NULL)
+        Line->RawTokens = Tokenize(Line->Text, Line->Length, File->yulType,
+            Block1);
+      if (Line->Prepared == NULL)
+        Line->PreparedTokens = Line->RawTokens;
+      return (Line->RawTokens);
+    }
+  if (Line->PreparedTokens == NULL)
+    Line->PreparedTokens = Tokenize(Line->Prepared, strlen(Line->Prepared),
+        File->yulType, Block1);
+  return (Line->PreparedTokens);
+}
+
+//-------------------------------------------------------------------------
+// Tokenize the raw text of a line afresh, ignoring (and not creating) the
+// records cached in the line, with the --block1 column-16 processing if
+// Column16 is non-zero.  The record must be released with
+// FreeSourceTokens().  Returns NULL if out of memory.
+SourceTokens_t *
+TokenizeSourceLine(SourceFile_t *File, SourceLine_t *Line, int Column16)
+{
+  return (Tokenize(Line->Text, Line->Length, File->yulType, Column16));
+}
+
+//-------------------------------------------------------------------------
+// SymbolPass() wants the raw tokenization of a line, but without the --block1
+// column-16 processing.  For anything other than --block1, that's the same
+// as what Pass() will use, so it's cached.  For --block1, a temporary
+// record is created, which must be released with FreeSourceTokens().
+SourceTokens_t *
+GetSymbolTokens(SourceFile_t *File, SourceLine_t *Line)
+{
+  if (!Block1)
+    return (GetSourceTokens(File, Line, 1));
+  return (TokenizeSourceLine(File, Line, 0));
+}
+
+void
+FreeSourceTokens(SourceLine_t *Line, SourceTokens_t *Tokens)
+{
+  if (Tokens == NULL || Tokens == Line->RawTokens
+      || Tokens == Line->PreparedTokens)
+    return;
+  free(Tokens->Text);
+  free(Tokens);
+}
@@ -0,0 +1,307 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    Stats.c
+ * Purpose:     The --stats option, which reports where the time of an
+ *              assembly went, as JSON.
+ * Mod History: 2026-10-17 AGT  Began.
+ *              2026-10-17 AGT  Added passes_saved.
+ *              2026-10-17 AGT  Added operand_hits and operand_misses.
+ *              2026-10-17 AGT  A pass is left out, rather than exiting, if
+ *                              there's no memory to record it.
+ *              2026-10-17 AGT  The worker processes of --processes are
+ *                              counted, and control characters are escaped.
+ *
+ * Assemble() brackets each phase with StatsMark() and StatsPhase() (or
+ * StatsPass(), for the passes), and a few hot spots bump the counters in
+ * StatsCounters.  When the assembly is over, StatsReport() writes
+ * something like
+ *
+ *   {
+ *     "yaYUL_stats": 1,
+ *     "input": "Luminary.agc",
+ *     "target": "BLK2",
+ *     "phases": {
+ *       "symbol_pass": { "wall": 0.0123, "cpu": 0.0120 },
+ *       ...
+ *     },
+ *     "passes": [
+ *       { "pass": 1, "final": false, "wall": 0.0456, "cpu": 0.0450,
+ *         "lines_evaluated": 41000, "lines_skipped": 0,
+ *         "unresolved": 12, "reassigned": 3 },
+ *       ...
+ *     ],
+ *     "counters": { "symbols": 7100, "symbol_lookups": 123456,
+ *                   "symbol_misses": 789, "incpc_calls": 45678,
+ *                   "passes_saved": 1, "operand_hits": 98765,
+ *                   "operand_misses": 4321 },
+ *     "peak_rss_kb": 12345
+ *   }
+ *
+ * Times are in seconds.  CPU time is that of the thread performing the
+ * assembly.  With --processes, the final pass is split among worker
+ * processes, each of which sends back its counters and times (see
+ * StatsChildStart() and so on); their CPU times are added to those of the
+ * final pass, the phases, and the total, and their counters to the
+ * parent's.  Their wall-clock times are not added, since they overlap
+ * the final pass, which already accounts for them.  The "html" phase
+ * covers creating and closing the HTML files and processing HTML inserts,
+ * and so overlaps the passes; the per-line HTML output is counted only as
+ * part of the final pass.  The counters are always maintained, since that
+ * costs next to nothing, but nothing is timed unless --stats was given.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#ifndef MSC_VS
+#include <sys/resource.h>
+#endif
+
+//-------------------------------------------------------------------------
+// Some global data.
+
+ASSEMBLY int StatsEnabled = 0;
+ASSEMBLY StatsCounters_t StatsCounters;
+
+static const char *PhaseNames[STATS_NUM_PHASES] =
+  { "symbol_pass", "sort_symbols", "bugger_words", "write_binary", "html" };
+static ASSEMBLY StatsTime_t Phases[STATS_NUM_PHASES];
+static ASSEMBLY StatsTime_t Started;
+
+typedef struct
+{
+  StatsTime_t Time;
+  int Final, LinesEvaluated, LinesSkipped, Unresolved, Reassigned;
+} StatsPass_t;
+static ASSEMBLY StatsPass_t *Passes = NULL;
+static ASSEMBLY int NumPasses = 0, MaxPasses = 0;
+
+// The CPU time of the worker processes, since the last StatsPass() and
+// altogether.
+static ASSEMBLY double ChildCpu = 0, AllChildCpu = 0;
+
+//-------------------------------------------------------------------------
+// Note the current wall-clock and CPU times.
+void
+StatsMark(StatsTime_t *Mark)
+{
+  if (!StatsEnabled)
+    return;
+#ifdef MSC_VS
+  Mark->Wall = Mark->Cpu = (double) clock() / CLOCKS_PER_SEC;
+#else
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  Mark->Wall = t.tv_sec + t.tv_nsec / 1e9;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+  Mark->Cpu = t.tv_sec + t.tv_nsec / 1e9;
+#endif
+}
+
+// Begin collecting statistics for an assembly.
+void
+StatsStart(void)
+{
+  StatsEnabled = 1;
+  memset(&StatsCounters, 0, sizeof(StatsCounters));
+  memset(Phases, 0, sizeof(Phases));
+  NumPasses = 0;
+  ChildCpu = AllChildCpu = 0;
+  StatsMark(&Started);
+}
+
+// Charge the time since Since (as given by StatsMark()) to a phase.
+void
+StatsPhase(int Phase, const StatsTime_t *Since)
+{
+  StatsTime_t Now;
+
+  if (!StatsEnabled)
+    return;
+  StatsMark(&Now);
+  Phases[Phase].Wall += Now.Wall - Since->Wall;
+  Phases[Phase].Cpu += Now.Cpu - Since->Cpu;
+}
+
+// Record a pass which began at Since.
+void
+StatsPass(const StatsTime_t *Since, int Final, int Unresolved, int Reassigned)
+{
+  StatsPass_t *p;
+  StatsTime_t Now;
+
+  if (!StatsEnabled)
+    return;
+  StatsMark(&Now);
+  if (NumPasses == MaxPasses)
+    {
+      StatsPass_t *NewPasses;
+
+      NewPasses = (StatsPass_t *) realloc(Passes,
+          (MaxPasses + 16) * sizeof(StatsPass_t));
+      if (NewPasses == NULL)
+        {
+          fprintf(LISTING, "Out of memory (10).\n");
+          OutOfMemory = 1;
+          return;
+        }
+      Passes = NewPasses;
+      MaxPasses += 16;
+    }
+  p = &Passes[NumPasses++];
+  p->Time.Wall = Now.Wall - Since->Wall;
+  p->Time.Cpu = Now.Cpu - Since->Cpu + ChildCpu;
+  ChildCpu = 0;
+  p->Final = Final;
+  p->LinesEvaluated = LinesEvaluated;
+  p->LinesSkipped = LinesSkipped;
+  p->Unresolved = Unresolved;
+  p->Reassigned = Reassigned;
+}
+
+//-------------------------------------------------------------------------
+// In a worker process of --processes (see ParallelPass.c), StatsChildStart()
+// is called before its share of the final pass and StatsChildEnd() after,
+// which leaves in Child what that share added.  Child is then sent back to
+// the parent, which gives it to StatsChildAdd().
+void
+StatsChildStart(StatsChild_t *Child)
+{
+  memset(Child, 0, sizeof(StatsChild_t));
+  Child->Counters = StatsCounters;
+  memcpy(Child->Phases, Phases, sizeof(Phases));
+  StatsMark(&Child->Time);
+}
+
+void
+StatsChildEnd(StatsChild_t *Child)
+{
+  StatsTime_t Now;
+  int i;
+
+  memset(&Now, 0, sizeof(Now));
+  StatsMark(&Now);
+  Child->Time.Wall = Now.Wall - Child->Time.Wall;
+  Child->Time.Cpu = Now.Cpu - Child->Time.Cpu;
+  for (i = 0; i < STATS_NUM_PHASES; i++)
+    {
+      Child->Phases[i].Wall = Phases[i].Wall - Child->Phases[i].Wall;
+      Child->Phases[i].Cpu = Phases[i].Cpu - Child->Phases[i].Cpu;
+    }
+  Child->Counters.SymbolLookups = StatsCounters.SymbolLookups
+      - Child->Counters.SymbolLookups;
+  Child->Counters.SymbolMisses = StatsCounters.SymbolMisses
+      - Child->Counters.SymbolMisses;
+  Child->Counters.IncPcCalls = StatsCounters.IncPcCalls
+      - Child->Counters.IncPcCalls;
+  Child->Counters.PassesSaved = StatsCounters.PassesSaved
+      - Child->Counters.PassesSaved;
+}
+
+void
+StatsChildAdd(const StatsChild_t *Child)
+{
+  int i;
+
+  StatsCounters.SymbolLookups += Child->Counters.SymbolLookups;
+  StatsCounters.SymbolMisses += Child->Counters.SymbolMisses;
+  StatsCounters.IncPcCalls += Child->Counters.IncPcCalls;
+  StatsCounters.PassesSaved += Child->Counters.PassesSaved;
+  if (!StatsEnabled)
+    return;
+  for (i = 0; i < STATS_NUM_PHASES; i++)
+    Phases[i].Cpu += Child->Phases[i].Cpu;
+  ChildCpu += Child->Time.Cpu;
+  AllChildCpu += Child->Time.Cpu;
+}
+
+//-------------------------------------------------------------------------
+// Write the JSON report to the file Filename, or if NULL to stderr (or
+// wherever the assembly's errors go; see ERRORS).
+void
+StatsReport(const char *Filename, const char *InputFilename)
+{
+  extern ASSEMBLY int SymbolTableSize;
+  StatsTime_t Now;
+  long PeakRss = 0;
+  const char *s;
+  FILE *fp = ERRORS;
+  int i;
+
+  if (!StatsEnabled)
+    return;
+  StatsMark(&Now);
+  if (Filename != NULL)
+    {
+      fp = fopen(Filename, "w");
+      if (fp == NULL)
+        {
+          fprintf(LISTING, "Cannot create statistics file \"%s\".\n", Filename);
+          return;
+        }
+    }
+#ifndef MSC_VS
+    {
+      struct rusage Usage;
+      if (!getrusage(RUSAGE_SELF, &Usage))
+        PeakRss = Usage.ru_maxrss;
+    }
+#endif
+
+  fprintf(fp, "{\n  \"yaYUL_stats\": 1,\n  \"input\": \"");
+  for (s = (InputFilename != NULL) ? InputFilename : ""; *s; s++)
+    if (*s == '"' || *s == '\\')
+      fprintf(fp, "\\%c", *s);
+    else if ((unsigned char) *s < 040)
+      fprintf(fp, "\\u%04x", (unsigned char) *s);
+    else
+      fputc(*s, fp);
+  fprintf(fp, "\",\n  \"target\": \"%s\",\n", assemblyTarget);
+
+  fprintf(fp, "  \"phases\": {\n");
+  for (i = 0; i < STATS_NUM_PHASES; i++)
+    fprintf(fp, "    \"%s\": { \"wall\": %.6f, \"cpu\": %.6f },\n",
+        PhaseNames[i], Phases[i].Wall, Phases[i].Cpu);
+  fprintf(fp, "    \"total\": { \"wall\": %.6f, \"cpu\": %.6f }\n  },\n",
+      Now.Wall - Started.Wall, Now.Cpu - Started.Cpu + AllChildCpu);
+
+  fprintf(fp, "  \"passes\": [");
+  for (i = 0; i < NumPasses; i++)
+    fprintf(fp, "%s\n    { \"pass\": %d, \"final\": %s, \"wall\": %.6f, "
+        "\"cpu\": %.6f, \"lines_evaluated\": %d, \"lines_skipped\": %d, "
+        "\"unresolved\": %d, \"reassigned\": %d }", i ? "," : "", i + 1,
+        Passes[i].Final ? "true" : "false", Passes[i].Time.Wall,
+        Passes[i].Time.Cpu, Passes[i].LinesEvaluated, Passes[i].LinesSkipped,
+        Passes[i].Unresolved, Passes[i].Reassigned);
+  fprintf(fp, "\n  ],\n");
+
+  fprintf(fp, "  \"counters\": { \"symbols\": %d, \"symbol_lookups\": %lu, "
+      "\"symbol_misses\": %lu, \"incpc_calls\": %lu, \"passes_saved\": %lu, "
+      "\"operand_hits\": %lu, \"operand_misses\": %lu },\n",
+      SymbolTableSize, StatsCounters.SymbolLookups, StatsCounters.SymbolMisses,
+      StatsCounters.IncPcCalls, StatsCounters.PassesSaved, OperandHits,
+      OperandMisses);
+  fprintf(fp, "  \"peak_rss_kb\": %ld\n}\n", PeakRss);
+  if (fp != ERRORS)
+    fclose(fp);
+}
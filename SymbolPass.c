@@ -23,6 +23,12 @@
  *		in column 1, but not beginning with # or $.
  * Mode:	04/17/03 RSB.	Began.
  *		11/11/16 RSB.	Added provision for .yul.
+ *		2026-10-17 AGT	Now works from the in-memory source lines
+ *				shared with Pass(), rather than from the files.
+ *		2026-10-17 AGT	Copies only the label and operator fields.
+ *		2026-10-17 AGT	Split off DiscoverSymbols(), which the first
+ *				Pass() now normally uses instead, so that
+ *				SymbolPass() is needed only for --symbol-pass.
  */
 
 #include "yaYUL.h"
@@ -37,18 +43,58 @@
 // We allow a certain number of levels of include files.  To handle this,
 // we need a stack of input files.
 #define MAX_STACKED_INCLUDES 5
-static int NumStackedIncludes = 0;
+static ASSEMBLY int NumStackedIncludes = 0;
 typedef struct {
-  FILE *InputFile;
+  SourceCursor_t InputFile;
   Line_t InputFilename;
   int CurrentLineInFile;
-  int yulType;
 } StackedInclude_t;
-static StackedInclude_t StackedIncludes[MAX_STACKED_INCLUDES];
+static ASSEMBLY StackedInclude_t StackedIncludes[MAX_STACKED_INCLUDES];
 
 // Some dummy strings for parsing an input line.
-static Line_t Fields[6];
-static int NumFields = 0;
+static ASSEMBLY Line_t Fields[6];
+static ASSEMBLY int NumFields = 0;
+
+//-------------------------------------------------------------------------
+// Define the symbol (if any) which a source line defines.  Returns 0 on
+// success, or non-zero on fatal error.
+
+int
+DiscoverSymbols (SourceFile_t *File, SourceLine_t *Line)
+{
+  char *Label, *Operator;
+  SourceTokens_t *Tokens;
+  int i;
+
+  // Set up appropriate default values for various fields.
+  Label = Operator = "";
+
+  // The line's fields, as already found by the tokenizer (which also
+  // expands tabs, converts .yul cards, and removes the comment).
+  Tokens = GetSymbolTokens (File, Line);
+  if (Tokens == NULL)
+    return (1);
+  // Only a label (a field beginning in column 1) can define a symbol,
+  // and then only the operator matters, so just those are copied.
+  NumFields = Tokens->NumFields;
+  if (NumFields >= 1 && Tokens->FieldStart[0] == 0)
+    {
+      for (i = 0; i < NumFields && i < 2; i++)
+	{
+	  memcpy (Fields[i], &Tokens->Text[Tokens->FieldStart[i]],
+		  Tokens->FieldLength[i]);
+	  Fields[i][Tokens->FieldLength[i]] = 0;
+	}
+      Label = Fields[0];
+      if (NumFields >= 2)
+	Operator = Fields[1];
+    }
+  FreeSourceTokens (Line, Tokens);
+
+  if (*Label != 0 && strcmp(Operator, "MEMORY") && strcmp(Operator, "CHECK="))
+    return (DefineSymbol (Label));
+  return (0);
+}
 
 //-------------------------------------------------------------------------
 
@@ -57,39 +103,34 @@ SymbolPass (const char *InputFilename)
 {
   Line_t CurrentFilename;
   Line_t s;
-  char *Comment, *Label, *FalseLabel, *Operator, *Operand, *Mod1, *Mod2;
-  FILE *InputFile;
-  int CurrentLineAll = 0, CurrentLineInFile = 0, yulType;
+  SourceCursor_t InputFile;
+  SourceLine_t *Line;
+  int CurrentLineAll = 0, CurrentLineInFile = 0;
   int i;				// dummies.
-  char *ss;				// dummies.
   
   // Open the input file.
   strcpy (CurrentFilename, InputFilename);
-  InputFile = fopen (CurrentFilename, "r");
-  if (InputFile == NULL)
+  if (OpenSource (&InputFile, CurrentFilename))
     goto Done;
-  yulType = (NULL != strstr(CurrentFilename, ".yul"));
 
   // Loop on the lines of the input file.  
   s[sizeof (s) - 1] = 0;
   for (;;)
     {
       // Get the next line from the file.
-      ss = fgets (s, sizeof (s) - 1, InputFile);
+      Line = NextSourceLine (&InputFile);
       // At end of the file?
-      if (NULL == ss)
+      if (NULL == Line)
         {
 	  // We've reached the end of this input file.  Need to switch
 	  // files (if we were within an include-file) or to end the pass.
 	  if (NumStackedIncludes)
 	    {
-	      fclose (InputFile);
 	      NumStackedIncludes--;
 	      InputFile = StackedIncludes[NumStackedIncludes].InputFile;
 	      strcpy (CurrentFilename, 
 	              StackedIncludes[NumStackedIncludes].InputFilename);
 	      CurrentLineInFile = StackedIncludes[NumStackedIncludes].CurrentLineInFile; 
-	      yulType = StackedIncludes[NumStackedIncludes].yulType;
 	      continue;
 	    }
 	  else
@@ -105,8 +146,15 @@ SymbolPass (const char *InputFilename)
 	  CurrentLineInFile++;
 	}
 	
-      if (HtmlCheck (0, InputFile, s, sizeof (s), CurrentFilename, &CurrentLineAll, &CurrentLineInFile))
-        continue;
+      SourceText (s, sizeof (s), Line, 1);
+      if (s[0] == '#' || s[0] == '<')
+        {
+	  i = InputFile.Next;
+	  if (HtmlCheck (0, &InputFile, s, sizeof (s), CurrentFilename, &CurrentLineAll, &CurrentLineInFile))
+	    continue;
+	  if (InputFile.Next != i)
+	    Line = &InputFile.File->Lines[InputFile.Next - 1];
+	}
 		
       // Analyze the input line.  Is it an "include" directive?	
       if (s[0] == '$')
@@ -114,116 +162,38 @@ SymbolPass (const char *InputFilename)
 	  // This is a directive to include another file.
 	  if (NumStackedIncludes == MAX_STACKED_INCLUDES)
 	    {
-	      printf ("Too many levels of include-files.\n");
+	      fprintf (LISTING, "Too many levels of include-files.\n");
 	      goto Done;
 	    }
 	  StackedIncludes[NumStackedIncludes].InputFile = InputFile;
 	  strcpy (StackedIncludes[NumStackedIncludes].InputFilename,
 	  	  CurrentFilename);
 	  StackedIncludes[NumStackedIncludes].CurrentLineInFile = CurrentLineInFile;
-	  StackedIncludes[NumStackedIncludes].yulType = yulType;
 	  NumStackedIncludes++;
 	  if (1 != sscanf (s, "$%s", CurrentFilename))
 	    {
-	      printf ("Include-directive has no filename.\n");
+	      fprintf (LISTING, "Include-directive has no filename.\n");
 	      goto Done;
 	    }
 	  CurrentLineInFile = 0;
-	  InputFile = fopen (CurrentFilename, "r");
-	  if (InputFile == NULL)
+	  if (OpenSource (&InputFile, CurrentFilename))
 	    {
-	      printf ("Include-file \"%s\" does not exist.\n", CurrentFilename);
+	      fprintf (LISTING, "Include-file \"%s\" does not exist.\n",
+		       CurrentFilename);
 	      goto Done;
 	    }	    
-	  yulType = (NULL != strstr(CurrentFilename, ".yul"));
 	  continue;
 	} 
     
-      // Frankly, tabs and newlines will cause me a lot of problems further down, since
-      // there are actually a couple of things we need to use column alignment to check
-      // out.  So let's just start by expanding all tabs to spaces.
-      ss = strstr(s, "\n");
-      if (ss != NULL)
-        *ss = 0;
-      s[sizeof(s) - 1] = 0;
-      for (ss = s; *ss;)
-        {
-          if (*ss == '\t')
-            {
-              int pos, tabStop, len;
-              pos = ss - s;
-              tabStop = ((pos + 8) & ~7);
-              len = strlen(ss + 1);
-              if (tabStop + len >= sizeof(s))
-                len = sizeof(s) - tabStop - 1;
-              if (len > 0)
-                memmove(&s[tabStop], &s[pos + 1], len + 1);
-              else
-                s[tabStop] = 0;
-              for (; pos < tabStop && pos < sizeof(s); pos++)
-                s[pos] = ' ';
-              ss = &s[tabStop];
-            }
-          else
-            ss++;
-        }
-      *ss = 0;
-
-      if (yulType)
-	yul2agc(s);
-
-      // Set up appropriate default values for various fields.
-      Label = FalseLabel = Operator = Operand = Mod1 = Mod2 = "";
-    
-      // Find and remove the comment field, if any.
-      for (Comment = s; *Comment && *Comment != COMMENT_SEPARATOR; Comment++);
-      if (*Comment == '#')
+      if (DiscoverSymbols (InputFile.File, Line))
         {
-          *Comment++ = 0;
-	  // Trim the newline at the end:
-	  for (ss = Comment; *ss; ss++)
-	    if (*ss == '\n')
-	      *ss = 0;
-        }
-	
-      // Suck in all other fields.
-      NumFields = sscanf (s, "%s%s%s%s%s%s", Fields[0], Fields[1],
-      			  Fields[2], Fields[3], Fields[4], Fields[5]);	
-      if (NumFields >= 1)
-        {			  
-	  i = 0;
-	  if (*s && !isspace (*s))
-	    Label = Fields[i++];
-	  else if (*Fields[0] == '+' || *Fields[0] == '-')
-	    FalseLabel = Fields[i++];
-	  if (i < NumFields)
-	    Operator = Fields[i++];
-	  if (i < NumFields)
-	    Operand = Fields[i++];
-	  if (i < NumFields)
-	    Mod1 = Fields[i++];
-	  if (i < NumFields)
-	    Mod2 = Fields[i++];
-	}
-	
-      if (*Label != 0 && strcmp(Operator, "MEMORY") && strcmp(Operator, "CHECK="))
-        {
-	  //if (!strcmp (Label, "ATMAGAD"))
-	  //  printf ("***** %s, %d, %d, %s", CurrentFilename, CurrentLineAll, CurrentLineInFile, s);
-	  if (AddSymbol (Label))
-	    {
-	      printf ("Out of memory (2).\n");
-	      goto Done;
-	    }	
+	  fprintf (LISTING, "Out of memory (2).\n");
+	  goto Done;
 	}
     }
 
   // Done with this pass.
 Done:  
-  if (InputFile != NULL)
-    fclose (InputFile);
-  for (i = 0; i < NumStackedIncludes; i++)
-    fclose (StackedIncludes[i].InputFile); 
   NumStackedIncludes = 0; 
 }
 
@@ -102,6 +102,45 @@
  *                              to visually distinguish visited lines in annotations from
  *                              the plain text. And in retrospect, I don't see any way for
  *                              it to really be confused with a comment.
+ *              2026-10-17 AGT  HtmlCheck now reads ahead from the in-memory
+ *                              source lines rather than from a FILE.
+ *              2026-10-17 AGT  GetSymbol now uses a hash index into the
+ *                              symbol table, rather than bsearch.
+ *              2026-10-17 AGT  The symbol table is now a set of parallel
+ *                              arrays, with interned source-file names,
+ *                              rather than an array of Symbol_t.
+ *              2026-10-17 AGT  GetSymbol() and EditSymbolNew() report symbol
+ *                              reads and changes to Resolve.c.  Added
+ *                              EditSymbolNumber().
+ *              2026-10-17 AGT  HTML and symbol-table files are noted for
+ *                              --cache.
+ *              2026-10-17 AGT  The HTML style is kept at file scope, and
+ *                              added HtmlStyleHash().
+ *              2026-10-17 AGT  The state of the assembly is thread-local
+ *                              (ASSEMBLY), and the symbols are listed to
+ *                              the LISTING.
+ *              2026-10-17 AGT  Symbol lookups and the HTML work are counted
+ *                              and timed for --stats.
+ *              2026-10-17 AGT  Added DefineSymbol(), and symbols may be
+ *                              discovered during the first pass (see
+ *                              DiscoveringSymbols).  The table grows by
+ *                              doubling.
+ *              2026-10-17 AGT  Added GetNumberedSymbol().
+ *              2026-10-17 AGT  GetSymbol() no longer adds placeholders for
+ *                              undiscovered symbols; only
+ *                              GetNumberedSymbol() does.
+ *              2026-10-17 AGT  The line table holds interned file names
+ *                              rather than copies of them, and grows by
+ *                              doubling.  Added GetLine().
+ *              2026-10-17 AGT  SortLines() sorts by counting rather than
+ *                              by qsort, and removes the duplicates in a
+ *                              single sweep.
+ *              2026-10-17 AGT  Added WriteSymtab(), for version 2 of the
+ *                              symbol-table file.
+ *              2026-10-17 AGT  The tables keep their contents if they can't
+ *                              be enlarged, and OutOfMemory is set.
+ *              2026-10-17 AGT  WriteSymtab() keeps the Overflow bit of the
+ *                              addresses, now that there's room for it.
  *
  * Concerning the concept of a symbol's namespace.  I had originally
  * intended to implement this, and so many functions had a namespace
@@ -114,6 +153,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <fcntl.h>
 #include <errno.h>
 #ifndef MSC_VS
@@ -136,11 +176,49 @@
 // error messages.  The symbol table is initially empty.  Whenever more 
 // symbols are defined than the table has room for, its space is enlarged.  
 // On the second pass, true values are assigned to the symbols.
-Symbol_t *SymbolTable = NULL;
-int SymbolTableSize = 0, SymbolTableMax = 0;
+//
+// Normally the first pass is also the first of the passes which assign
+// values (see DiscoveringSymbols), in which case a symbol may be referenced
+// before the line defining it has been seen.  It's added to the table
+// anyway, and SymbolDefinitions[] (the number of times the symbol has been
+// defined) tells us at the end of the pass whether it really exists.
+//
+// The table is kept as parallel arrays indexed by symbol number, rather
+// than as an array of Symbol_t, so that the names and values (which are
+// used constantly while operands are being resolved) are packed together,
+// and the debugging data isn't dragged through the cache along with them.
+// Source-file names are stored just once, in SymbolFiles[], and each symbol
+// keeps only an index into it (-1 if none).  Symbol_t is still the format
+// used for the symbol-table file.
+typedef char SymbolName_t[1 + MAX_LABEL_LENGTH];
+static ASSEMBLY SymbolName_t *SymbolNames = NULL;
+static ASSEMBLY Address_t *SymbolValues = NULL;
+static ASSEMBLY int *SymbolTypes = NULL;
+static ASSEMBLY int *SymbolFileIds = NULL;
+static ASSEMBLY unsigned *SymbolLineNumbers = NULL;
+static ASSEMBLY int *SymbolDefinitions = NULL;
+ASSEMBLY int SymbolTableSize = 0, SymbolTableMax = 0;
+
+// Non-zero while the first pass is discovering the symbols.
+ASSEMBLY int DiscoveringSymbols = 0;
+
+// The names of the source files, as interned for both the symbol table
+// and the line table.
+static ASSEMBLY char **SymbolFiles = NULL;
+static ASSEMBLY int NumSymbolFiles = 0, MaxSymbolFiles = 0;
+
+// Symbol lookups are made through a hash index rather than by searching the
+// sorted table, since the table is searched for every operand on every pass.
+// The index is open-addressed, and its size is a power of 2 at least twice
+// SymbolTableMax.  Each slot holds a symbol number (or -1 if the slot is
+// empty) along with the hash of the symbol's name.  Because sorting moves
+// the symbols around, the index is rebuilt after SortSymbols().
+static ASSEMBLY int *SymbolHashIndex = NULL;
+static ASSEMBLY unsigned *SymbolHashValue = NULL;
+static ASSEMBLY int SymbolHashSize = 0;
 
 // Set this variable non-zero to treat "## Page" as "# Page".
-int UnpoundPage = 0;
+ASSEMBLY int UnpoundPage = 0;
 
 //-------------------------------------------------------------------------
 // Here are functions for converting integers in-place between the CPU native
@@ -207,7 +285,7 @@ LittleEndian32(void *Value)
 char *
 NormalizeFilename(char *SourceName)
 {
-  static char HtmlFilename[1025];
+  static ASSEMBLY char HtmlFilename[1025];
   int n;
 
   strcpy(HtmlFilename, SourceName);
@@ -227,14 +305,18 @@ int
 HtmlCreate(char *Filename)
 {
   char *HtmlFilename;
+  StatsTime_t Started;
 
+  StatsMark(&Started);
   HtmlFilename = NormalizeFilename(Filename);
   HtmlOut = fopen(HtmlFilename, "w");
   if (HtmlOut == NULL)
     {
-      printf("Cannot create HTML file \"%s\"\n", HtmlFilename);
+      fprintf(LISTING, "Cannot create HTML file \"%s\"\n", HtmlFilename);
+      StatsPhase(STATS_HTML, &Started);
       return (1);
     }
+  CacheNoteOutput(HtmlFilename);
 
   // Write the HTML header.
   fprintf(HtmlOut, "%s",
@@ -305,6 +387,7 @@ HtmlCreate(char *Filename)
       HTML_STYLE_START
       "<h1>Source Code</h1>\n");
 
+  StatsPhase(STATS_HTML, &Started);
   return (0);
 }
 
@@ -313,11 +396,15 @@ HtmlCreate(char *Filename)
 void
 HtmlClose(void)
 {
+  StatsTime_t Started;
+
   if (HtmlOut == NULL)
     return;
 
+  StatsMark(&Started);
   fprintf(HtmlOut, "%s", HTML_STYLE_END "</body>\n</html>\n");
   fclose(HtmlOut);
+  StatsPhase(STATS_HTML, &Started);
 }
 
 //-------------------------------------------------------------------------
@@ -327,19 +414,60 @@ HtmlClose(void)
 // style and the "##" style.  There is also a default style file which can
 // be used (at assembly-time).
 
-static int StyleInitialized = 0;
-int StyleOnly = 0;
+static ASSEMBLY int StyleInitialized = 0;
+ASSEMBLY int StyleOnly = 0;
+static ASSEMBLY int StyleBox = 0, StyleBoxWidth = 75, StyleUser = 0;
+static ASSEMBLY char StyleUserStart[2049] = "", StyleUserEnd[1025] = "";
 
+// A hash of the current HTML style, so that ParallelPass.c can tell whether
+// it is the same at two points in the assembly.
+unsigned
+HtmlStyleHash(void)
+{
+  unsigned Hash = 2166136261u;
+  const char *ss;
+
+  Hash = (Hash ^ StyleBox) * 16777619u;
+  Hash = (Hash ^ StyleBoxWidth) * 16777619u;
+  Hash = (Hash ^ StyleUser) * 16777619u;
+  for (ss = StyleUserStart; *ss; ss++)
+    Hash = (Hash ^ (unsigned char) *ss) * 16777619u;
+  Hash = (Hash ^ 0377) * 16777619u;
+  for (ss = StyleUserEnd; *ss; ss++)
+    Hash = (Hash ^ (unsigned char) *ss) * 16777619u;
+  return (Hash);
+}
+
+static int
+HtmlCheckLine(int WriteOutput, SourceCursor_t *InputFile, char *s, int sSize,
+    char *CurrentFilename, int *CurrentLineAll, int *CurrentLineInFile);
+
+// With --html, the time spent here is charged to the "html" phase of --stats.
 int
-HtmlCheck(int WriteOutput, FILE *InputFile, char *s, int sSize,
+HtmlCheck(int WriteOutput, SourceCursor_t *InputFile, char *s, int sSize,
+    char *CurrentFilename, int *CurrentLineAll, int *CurrentLineInFile)
+{
+  StatsTime_t Started;
+  int RetVal;
+
+  if (!Html)
+    return (HtmlCheckLine(WriteOutput, InputFile, s, sSize, CurrentFilename,
+        CurrentLineAll, CurrentLineInFile));
+  StatsMark(&Started);
+  RetVal = HtmlCheckLine(WriteOutput, InputFile, s, sSize, CurrentFilename,
+      CurrentLineAll, CurrentLineInFile);
+  StatsPhase(STATS_HTML, &Started);
+  return (RetVal);
+}
+
+static int
+HtmlCheckLine(int WriteOutput, SourceCursor_t *InputFile, char *s, int sSize,
     char *CurrentFilename, int *CurrentLineAll, int *CurrentLineInFile)
 {
-  static int StyleBox = 0, StyleBoxWidth = 75, StyleUser = 0;
-  static char StyleUserStart[2049] = "", StyleUserEnd[1025] = "";
   int Width, Pos = 0;
   int i, j;
   char c = 0, *ss;
-  extern int inHeader;
+  extern ASSEMBLY int inHeader;
 
   //if (WriteOutput)
   //  printf("HTML -> %s", s);
@@ -358,7 +486,7 @@ HtmlCheck(int WriteOutput, FILE *InputFile, char *s, int sSize,
           StyleOnly = 1;
 
           while (NULL != fgets(s, sizeof(s) - 1, Defaults))
-            HtmlCheck(0, Defaults, s, sizeof(s), "", &i, &j);
+            HtmlCheck(0, NULL, s, sizeof(s), "", &i, &j);
 
           StyleOnly = 0;
           fclose(Defaults);
@@ -516,7 +644,7 @@ HtmlCheck(int WriteOutput, FILE *InputFile, char *s, int sSize,
       // Loop on the lines of the insert.
       while (1)
         {
-          ss = fgets(s, sSize - 1, InputFile);
+          ss = SourceGets(s, sSize - 1, InputFile);
           if (ss == NULL)
             break;
           (*CurrentLineAll)++;
@@ -559,11 +687,11 @@ HtmlCheck(int WriteOutput, FILE *InputFile, char *s, int sSize,
       // Loop on the lines of the insert.
       while (1)
         {
-          ss = fgets(s, sSize - 1, InputFile);
+          ss = SourceGets(s, sSize - 1, InputFile);
           if (ss == NULL)
             {
-              printf("Premature end-of-file.\n");
-              fprintf(stderr, "%s:%d: Premature end-of-file.\n",
+              fprintf(LISTING, "Premature end-of-file.\n");
+              fprintf(ERRORS, "%s:%d: Premature end-of-file.\n",
                   CurrentFilename, *CurrentLineInFile);
               goto Done;
             }
@@ -602,7 +730,8 @@ HtmlCheck(int WriteOutput, FILE *InputFile, char *s, int sSize,
 char *
 NormalizeAnchor(char *Name)
 {
-  static char Normalized[17], *EndPoint = &Normalized[sizeof(Normalized) - 1];
+  static ASSEMBLY char Normalized[17];
+  char *EndPoint = &Normalized[sizeof(Normalized) - 1];
   char *s;
 
   for (s = Normalized, *s = 0; *Name != 0 && s < EndPoint; s += 2, Name++)
@@ -620,7 +749,8 @@ NormalizeAnchor(char *Name)
 char *
 NormalizeStringN(char *Input, int PadTo)
 {
-  static char Output[2000], *EndPoint = &Output[sizeof(Output) - 1 - 6];
+  static ASSEMBLY char Output[2000];
+  char *EndPoint = &Output[sizeof(Output) - 1 - 6];
   char *s;
   int Pos = 0;
 
@@ -680,63 +810,290 @@ NormalizeString(char *Input)
 void
 ClearSymbols(void)
 {
-  if (SymbolTable != NULL)
-    free(SymbolTable);
+  int i;
 
-  SymbolTable = NULL;
+  if (SymbolNames != NULL)
+    free(SymbolNames);
+  if (SymbolValues != NULL)
+    free(SymbolValues);
+  if (SymbolTypes != NULL)
+    free(SymbolTypes);
+  if (SymbolFileIds != NULL)
+    free(SymbolFileIds);
+  if (SymbolLineNumbers != NULL)
+    free(SymbolLineNumbers);
+  if (SymbolDefinitions != NULL)
+    free(SymbolDefinitions);
+  if (SymbolHashIndex != NULL)
+    free(SymbolHashIndex);
+  if (SymbolHashValue != NULL)
+    free(SymbolHashValue);
+  for (i = 0; i < NumSymbolFiles; i++)
+    free(SymbolFiles[i]);
+  if (SymbolFiles != NULL)
+    free(SymbolFiles);
+
+  SymbolNames = NULL;
+  SymbolValues = NULL;
+  SymbolTypes = NULL;
+  SymbolFileIds = NULL;
+  SymbolLineNumbers = NULL;
+  SymbolDefinitions = NULL;
   SymbolTableSize = SymbolTableMax = 0;
+  DiscoveringSymbols = 0;
+  SymbolHashIndex = NULL;
+  SymbolHashValue = NULL;
+  SymbolHashSize = 0;
+  SymbolFiles = NULL;
+  NumSymbolFiles = MaxSymbolFiles = 0;
+}
+
+//-------------------------------------------------------------------------
+// Hash a symbol name (FNV-1a).
+static unsigned
+HashSymbolName(const char *Name)
+{
+  unsigned Hash = 2166136261u;
+
+  for (; *Name; Name++)
+    Hash = (Hash ^ (unsigned char) *Name) * 16777619u;
+
+  return (Hash);
+}
+
+//-------------------------------------------------------------------------
+// Find the slot of the hash index which holds the given symbol name, or
+// else the empty slot where it would be inserted.
+static int
+FindSymbolSlot(const char *Name, unsigned Hash)
+{
+  int Mask = SymbolHashSize - 1, i;
+
+  for (i = Hash & Mask; SymbolHashIndex[i] >= 0; i = (i + 1) & Mask)
+    if (SymbolHashValue[i] == Hash
+        && !strcmp(SymbolNames[SymbolHashIndex[i]], Name))
+      break;
+
+  return (i);
+}
+
+//-------------------------------------------------------------------------
+// Rebuild the hash index for the entire symbol table.  If a name appears
+// more than once, only the first is indexed.  Returns 0 on success, or
+// non-zero on fatal error.
+static int
+IndexSymbols(void)
+{
+  int i, Slot;
+  unsigned Hash;
+
+  if (SymbolHashSize < 2 * SymbolTableMax)
+    {
+      if (SymbolHashIndex != NULL)
+        free(SymbolHashIndex);
+      if (SymbolHashValue != NULL)
+        free(SymbolHashValue);
+      for (SymbolHashSize = 1024; SymbolHashSize < 2 * SymbolTableMax;
+          SymbolHashSize *= 2)
+        ;
+      SymbolHashIndex = (int *) malloc(SymbolHashSize * sizeof(int));
+      SymbolHashValue = (unsigned *) malloc(SymbolHashSize * sizeof(unsigned));
+      if (SymbolHashIndex == NULL || SymbolHashValue == NULL)
+        {
+          free(SymbolHashIndex);
+          free(SymbolHashValue);
+          SymbolHashIndex = NULL;
+          SymbolHashValue = NULL;
+          SymbolHashSize = 0;
+          fprintf(LISTING, "Out of memory (3).\n");
+          OutOfMemory = 1;
+          return (1);
+        }
+    }
+
+  for (i = 0; i < SymbolHashSize; i++)
+    SymbolHashIndex[i] = -1;
+
+  for (i = 0; i < SymbolTableSize; i++)
+    {
+      Hash = HashSymbolName(SymbolNames[i]);
+      Slot = FindSymbolSlot(SymbolNames[i], Hash);
+      if (SymbolHashIndex[Slot] < 0)
+        {
+          SymbolHashIndex[Slot] = i;
+          SymbolHashValue[Slot] = Hash;
+        }
+    }
+
+  return (0);
 }
 
 //-------------------------------------------------------------------------
-// Add a symbol to the table.  The newly-added symbol always has the value
-// ILLEGAL_SYMBOL_VALUE.  Returns 0 on success, or non-zero on fatal
+// Enlarge one of the symbol-table arrays, or the like.  Returns 0 on
+// success, or non-zero if out of memory, in which case the array is left
+// as it was.
+static int
+GrowArray(void *Array, size_t Size)
+{
+  void *Grown;
+
+  Grown = realloc(*(void **) Array, Size);
+  if (Grown == NULL)
+    {
+      fprintf(LISTING, "Out of memory (3).\n");
+      OutOfMemory = 1;
+      return (1);
+    }
+  *(void **) Array = Grown;
+  return (0);
+}
+
+//-------------------------------------------------------------------------
+// Enlarge the symbol table.  Returns 0 on success, or non-zero on fatal
 // error.
-int
-AddSymbol(const char *Name)
+static int
+GrowSymbolTable(void)
 {
-  char Namespace = 0;
+  int NewMax;
+
+  // This default size comes from the fact that I know there are about
+  // 7100 symbols in the Luminary131 symbol table. There are far fewer
+  // symbols in yaLEMAP, but that is ok since this isn't much memory
+  // anyhow.  Beyond that the size is doubled, so that the hash index
+  // needn't be rebuilt too often.
+  if (SymbolTableMax == 0)
+    NewMax = 10000;
+  else
+    NewMax = 2 * SymbolTableMax;
+
+  if (GrowArray(&SymbolNames, NewMax * sizeof(SymbolName_t))
+      || GrowArray(&SymbolValues, NewMax * sizeof(Address_t))
+      || GrowArray(&SymbolTypes, NewMax * sizeof(int))
+      || GrowArray(&SymbolFileIds, NewMax * sizeof(int))
+      || GrowArray(&SymbolLineNumbers, NewMax * sizeof(unsigned))
+      || GrowArray(&SymbolDefinitions, NewMax * sizeof(int)))
+    return (1);
+  SymbolTableMax = NewMax;
+
+  return (IndexSymbols());
+}
+
+//-------------------------------------------------------------------------
+// Get the index in SymbolFiles[] of a source-file name, adding it if it's
+// not already there.  The empty name is -1.  Returns -2 on fatal error.
+// The index always fits in a short.
+static int
+InternSymbolFile(const char *FileName)
+{
+  static ASSEMBLY int LastFileId = -1;
+  int i;
+
+  if (*FileName == 0)
+    return (-1);
+
+  // Symbols tend to come in runs from the same file, so check the most-
+  // recently used name first.
+  if (LastFileId >= 0 && LastFileId < NumSymbolFiles
+      && !strcmp(SymbolFiles[LastFileId], FileName))
+    return (LastFileId);
+
+  for (i = 0; i < NumSymbolFiles; i++)
+    if (!strcmp(SymbolFiles[i], FileName))
+      return (LastFileId = i);
+
+  if (NumSymbolFiles == SHRT_MAX)
+    {
+      fprintf(LISTING, "Too many source files.\n");
+      return (-2);
+    }
+  if (NumSymbolFiles == MaxSymbolFiles)
+    {
+      if (GrowArray(&SymbolFiles, (MaxSymbolFiles + 64) * sizeof(char *)))
+        return (-2);
+      MaxSymbolFiles += 64;
+    }
+  SymbolFiles[NumSymbolFiles] = strdup(FileName);
+  if (SymbolFiles[NumSymbolFiles] == NULL)
+    {
+      fprintf(LISTING, "Out of memory (3).\n");
+      OutOfMemory = 1;
+      return (-2);
+    }
+
+  return (LastFileId = NumSymbolFiles++);
+}
+
+//-------------------------------------------------------------------------
+// Add a symbol to the table, as having been defined Definitions times.  The
+// newly-added symbol always has the value ILLEGAL_SYMBOL_VALUE.  Returns 0
+// on success, or non-zero on fatal error.
+static int
+AddSymbolEntry(const char *Name, int Definitions)
+{
+  static const Address_t InvalidValue = INVALID_ADDRESS;
+  unsigned Hash;
+  int Slot;
 
   // A sanity clause.
   if (strlen(Name) > MAX_LABEL_LENGTH)
     {
-      printf("Symbol name \"%s\" is too long.\n", Name);
+      fprintf(LISTING, "Symbol name \"%s\" is too long.\n", Name);
       return (1);
     }
 
-  // If the symbol table is too small, enlarge it.
+  // If the symbol table is too small, enlarge it.  (The index may be
+  // missing if there wasn't memory to rebuild it.)
   if (SymbolTableSize == SymbolTableMax)
     {
-      if (SymbolTable == NULL)
-        {
-          // This default size comes from the fact that I know there are about
-          // 7100 symbols in the Luminary131 symbol table. There are far fewer
-          // symbols in yaLEMAP, but that is ok since this isn't much memory
-          // anyhow.
-          SymbolTableMax = 10000;
-          SymbolTable = (Symbol_t *) calloc(SymbolTableMax, sizeof(Symbol_t));
-        }
-      else
-        {
-          SymbolTableMax += 1000;
-          SymbolTable = (Symbol_t *) realloc(SymbolTable,
-              SymbolTableMax * sizeof(Symbol_t));
-        }
-      if (SymbolTable == NULL)
-        {
-          printf("Out of memory (3).\n");
-          return (1);
-        }
+      if (GrowSymbolTable())
+        return (1);
     }
+  else if (SymbolHashSize == 0 && IndexSymbols())
+    return (1);
 
-  // Now add the symbol.
-  SymbolTable[SymbolTableSize].Namespace = Namespace;
-  SymbolTable[SymbolTableSize].Value.Invalid = 1;
-  strcpy(SymbolTable[SymbolTableSize].Name, Name);
+  // Now add the symbol.  If it's a duplicate, it is left out of the index,
+  // and will be reported (and removed) by SortSymbols.
+  memset(SymbolNames[SymbolTableSize], 0, sizeof(SymbolName_t));
+  strcpy(SymbolNames[SymbolTableSize], Name);
+  SymbolValues[SymbolTableSize] = InvalidValue;
+  SymbolTypes[SymbolTableSize] = 0;
+  SymbolFileIds[SymbolTableSize] = -1;
+  SymbolLineNumbers[SymbolTableSize] = 0;
+  SymbolDefinitions[SymbolTableSize] = Definitions;
+  Hash = HashSymbolName(Name);
+  Slot = FindSymbolSlot(Name, Hash);
+  if (SymbolHashIndex[Slot] < 0)
+    {
+      SymbolHashIndex[Slot] = SymbolTableSize;
+      SymbolHashValue[Slot] = Hash;
+    }
   SymbolTableSize++;
 
   return (0);
 }
 
+// Add a symbol to the table.  Returns 0 on success, or non-zero on fatal
+// error.
+int
+AddSymbol(const char *Name)
+{
+  return (AddSymbolEntry(Name, 1));
+}
+
+// Note the definition of a symbol, adding it to the table if it isn't
+// there already.  Returns 0 on success, or non-zero on fatal error.
+int
+DefineSymbol(const char *Name)
+{
+  int Symbol;
+
+  Symbol = FindSymbol(Name);
+  if (Symbol < 0)
+    return (AddSymbol(Name));
+  SymbolDefinitions[Symbol]++;
+  return (0);
+}
+
 //-------------------------------------------------------------------------
 // JMS: Assign a symbol a new value. Returns 0 on success. This is used for
 // backward compatability to avoid changing lots of existing code. Sets the
@@ -748,73 +1105,212 @@ EditSymbol(const char *Name, Address_t *Value)
 }
 
 //-------------------------------------------------------------------------
-// Compare two symbol-table entries, for comparison purposes.  Both the
-// Namespace and Name fields are used.
+// Compare two symbol numbers by the names of the symbols, for sorting.
 static int
 CompareSymbolName(const void *Raw1, const void *Raw2)
 {
-#define Element1 ((Symbol_t *) Raw1)
-#define Element2 ((Symbol_t *) Raw2)
-  if (Element1->Namespace < Element2->Namespace)
-    return (-1);
+  return (strcmp(SymbolNames[*(const int *) Raw1],
+      SymbolNames[*(const int *) Raw2]));
+}
 
-  if (Element1->Namespace > Element2->Namespace)
-    return (1);
+//-------------------------------------------------------------------------
+// Rearrange one of the symbol-table arrays into the order given by Order[].
+// Returns the rearranged array (the original is freed), or NULL if out of
+// memory.
+static void *
+ReorderSymbolArray(void *Array, size_t Size, const int *Order, int Count)
+{
+  char *Reordered;
+  int i;
 
-  return (strcmp(Element1->Name, Element2->Name));
-#undef Element1
-#undef Element2
+  Reordered = (char *) malloc(SymbolTableMax * Size);
+  if (Reordered == NULL)
+    return (NULL);
+  for (i = 0; i < Count; i++)
+    memcpy(&Reordered[i * Size], (char *) Array + Order[i] * Size, Size);
+  free(Array);
+
+  return (Reordered);
 }
 
 //-------------------------------------------------------------------------
-// Sort the symbol table.  Returns the number of duplicated symbols.
+// Sort the symbol table.  Returns the number of duplicated symbols.  Symbols
+// which were referenced but never defined are removed.
 int
 SortSymbols(void)
 {
-  int i, j, ErrorCount = 0;
+  int i, j, *Order, *NewNumbers, ErrorCount = 0;
 
-  qsort(SymbolTable, SymbolTableSize, sizeof(Symbol_t), CompareSymbolName);
+  if (SymbolTableSize == 0)
+    return (0);
+
+  Order = (int *) malloc((SymbolTableSize + 1) * sizeof(int));
+  NewNumbers = (int *) malloc((SymbolTableSize + 1) * sizeof(int));
+  if (Order == NULL || NewNumbers == NULL)
+    {
+      fprintf(LISTING, "Out of memory (3).\n");
+      OutOfMemory = 1;
+      free(Order);
+      free(NewNumbers);
+      return (1);
+    }
+  for (i = 0; i < SymbolTableSize; i++)
+    {
+      Order[i] = i;
+      NewNumbers[i] = -1;
+    }
+  qsort(Order, SymbolTableSize, sizeof(int), CompareSymbolName);
 
-  // If a symbol is duplicated (in the same namespace), be remove the
-  // duplicates.
-  for (i = 1; i < SymbolTableSize;)
+  // If a symbol is duplicated, remove the duplicates.  (A symbol defined
+  // more than once has either been added more than once or counted in
+  // SymbolDefinitions[], depending on how the symbols were found.)
+  for (i = j = 0; i < SymbolTableSize; i++)
     {
-      if (SymbolTable[i - 1].Namespace == SymbolTable[i].Namespace
-          && !strcmp(SymbolTable[i - 1].Name, SymbolTable[i].Name))
+      int Definitions = SymbolDefinitions[Order[i]];
+      if (Definitions == 0)
+        continue;
+      if (j > 0 && !strcmp(SymbolNames[Order[j - 1]], SymbolNames[Order[i]]))
+        Definitions++;
+      else
+        {
+          NewNumbers[Order[i]] = j;
+          Order[j++] = Order[i];
+        }
+      for (; Definitions > 1; Definitions--)
         {
-          printf("Symbol \"%s\" (%d) is duplicated.\n", SymbolTable[i].Name,
-              SymbolTable[i].Namespace);
+          fprintf(LISTING, "Symbol \"%s\" (0) is duplicated.\n",
+              SymbolNames[Order[i]]);
           ErrorCount++;
-
-          for (j = i; j < SymbolTableSize; j++)
-            SymbolTable[j - 1] = SymbolTable[j];
-
-          SymbolTableSize--;
         }
-      else
-        i++;
     }
 
+  SymbolNames = (SymbolName_t *) ReorderSymbolArray(SymbolNames,
+      sizeof(SymbolName_t), Order, j);
+  SymbolValues = (Address_t *) ReorderSymbolArray(SymbolValues,
+      sizeof(Address_t), Order, j);
+  SymbolTypes = (int *) ReorderSymbolArray(SymbolTypes, sizeof(int), Order, j);
+  SymbolFileIds = (int *) ReorderSymbolArray(SymbolFileIds, sizeof(int), Order,
+      j);
+  SymbolLineNumbers = (unsigned *) ReorderSymbolArray(SymbolLineNumbers,
+      sizeof(unsigned), Order, j);
+  SymbolDefinitions = (int *) ReorderSymbolArray(SymbolDefinitions,
+      sizeof(int), Order, j);
+  free(Order);
+  if (SymbolNames == NULL || SymbolValues == NULL || SymbolTypes == NULL
+      || SymbolFileIds == NULL || SymbolLineNumbers == NULL
+      || SymbolDefinitions == NULL)
+    {
+      // Some of the arrays are gone, so the table is emptied altogether.
+      fprintf(LISTING, "Out of memory (3).\n");
+      OutOfMemory = 1;
+      free(SymbolNames);
+      free(SymbolValues);
+      free(SymbolTypes);
+      free(SymbolFileIds);
+      free(SymbolLineNumbers);
+      free(SymbolDefinitions);
+      free(SymbolHashIndex);
+      free(SymbolHashValue);
+      SymbolNames = NULL;
+      SymbolValues = NULL;
+      SymbolTypes = NULL;
+      SymbolFileIds = NULL;
+      SymbolLineNumbers = NULL;
+      SymbolDefinitions = NULL;
+      SymbolHashIndex = NULL;
+      SymbolHashValue = NULL;
+      SymbolTableSize = SymbolTableMax = SymbolHashSize = 0;
+      free(NewNumbers);
+      return (ErrorCount + 1);
+    }
+  for (i = 0; i < j; i++)
+    SymbolDefinitions[i] = 1;
+
+  // The symbols have moved, so the index must be rebuilt, and anything
+  // Resolve.c knows about them renumbered.
+  ResolveRenumber(NewNumbers, SymbolTableSize, j);
+  free(NewNumbers);
+  SymbolTableSize = j;
+  if (IndexSymbols())
+    ErrorCount++;
+
   return (ErrorCount);
 }
 
 //-------------------------------------------------------------------------
-// Locate a string in the symbol table.  
-// Returns a pointer to the symbol-table entry, or NULL if not found.. 
-Symbol_t *
+// Locate a string in the symbol table.
+// Returns the symbol number, or -1 if not found.
+int
+FindSymbol(const char *Name)
+{
+  int Symbol = -1;
+
+  StatsCounters.SymbolLookups++;
+  if (SymbolHashSize != 0 && strlen(Name) <= MAX_LABEL_LENGTH)
+    Symbol = SymbolHashIndex[FindSymbolSlot(Name, HashSymbolName(Name))];
+  if (Symbol < 0)
+    StatsCounters.SymbolMisses++;
+  return (Symbol);
+}
+
+//-------------------------------------------------------------------------
+// Locate a string in the symbol table.
+// Returns a pointer to the symbol's value, or NULL if not found.  This is
+// for callers which try something else when the name isn't a symbol (such
+// as SETLOC with a Raytheon-style address), so unlike GetNumberedSymbol()
+// it never adds the name to the table.  While the symbols are being
+// discovered, though, the name may yet turn out to be a symbol, so the
+// line has to be evaluated again in the next pass.
+Address_t *
 GetSymbol(const char *Name)
 {
-  char Namespace = 0;
-  Symbol_t Symbol;
+  int Symbol;
 
-  if (strlen(Name) > MAX_LABEL_LENGTH)
-    return (NULL);
+  Symbol = FindSymbol(Name);
+  if (Symbol < 0)
+    {
+      if (DiscoveringSymbols)
+        ResolveVolatile();
+      return (NULL);
+    }
+
+  ResolveNoteRead(Symbol);
+  return (&SymbolValues[Symbol]);
+}
 
-  Symbol.Namespace = Namespace;
-  strcpy(Symbol.Name, Name);
+// The same, but also gives the symbol number.  This is for references to
+// symbols (by FetchSymbolPlusOffset()), so while the symbols are being
+// discovered a name not yet in the table is added as a placeholder.
+Address_t *
+GetNumberedSymbol(const char *Name, int *Number)
+{
+  int Symbol;
 
-  return ((Symbol_t *) bsearch(&Symbol, SymbolTable, SymbolTableSize,
-      sizeof(Symbol_t), CompareSymbolName));
+  Symbol = FindSymbol(Name);
+  if (Symbol < 0)
+    {
+      // While the symbols are being discovered, this may be a symbol whose
+      // definition simply hasn't been reached yet.
+      if (!DiscoveringSymbols || strlen(Name) > MAX_LABEL_LENGTH
+          || AddSymbolEntry(Name, 0))
+        return (NULL);
+      Symbol = SymbolTableSize - 1;
+    }
+
+  ResolveNoteRead(Symbol);
+  *Number = Symbol;
+  return (&SymbolValues[Symbol]);
+}
+
+//-------------------------------------------------------------------------
+// Get the name of the source file in which a symbol (given by its symbol
+// number) was defined, or "" if unknown.
+char *
+GetSymbolFileName(int Symbol)
+{
+  if (SymbolFileIds[Symbol] < 0)
+    return ("");
+  return (SymbolFiles[SymbolFileIds[Symbol]]);
 }
 
 //------------------------------------------------------------------------
@@ -851,33 +1347,33 @@ PrintSymbolsToFile(FILE *fp)
             fprintf(HtmlOut, "\n");
         }
 
-      if (SymbolTable[i].Value.Invalid)
+      if (SymbolValues[i].Invalid)
         status = ",I";
-      else if (SymbolTable[i].Value.Constant)
+      else if (SymbolValues[i].Constant)
         status = ",C";
-      else if (SymbolTable[i].Value.Erasable)
+      else if (SymbolValues[i].Erasable)
         status = ",E";
-      else if (SymbolTable[i].Value.Fixed)
+      else if (SymbolValues[i].Fixed)
         status = ",F";
       else
         status = ",?";
       fprintf(fp, "%6d%s:   %-*s   ", i + 1, status,
-      MAX_LABEL_LENGTH, SymbolTable[i].Name);
+      MAX_LABEL_LENGTH, SymbolNames[i]);
       if (HtmlOut)
         {
           char *normalized;
           int width;
 
           width = MAX_LABEL_LENGTH;
-          normalized = NormalizeString(SymbolTable[i].Name);
+          normalized = NormalizeString(SymbolNames[i]);
           if (NULL != strstr(normalized, "&amp;"))
             width += 4;
 
-          if (SymbolTable[i].FileName[0])
+          if (SymbolFileIds[i] >= 0)
             {
               fprintf(HtmlOut, "%06d%s:   <a href=\"%s.html#%s\">%-*s</a>   ",
-                  i + 1, status, SymbolTable[i].FileName,
-                  NormalizeAnchor(SymbolTable[i].Name), width, normalized);
+                  i + 1, status, GetSymbolFileName(i),
+                  NormalizeAnchor(SymbolNames[i]), width, normalized);
             }
           else
             {
@@ -886,7 +1382,7 @@ PrintSymbolsToFile(FILE *fp)
             }
         }
 
-      AddressPrint(&SymbolTable[i].Value);
+      AddressPrint(&SymbolValues[i]);
       if (3 != (i & 3))
         {
           fprintf(fp, "\t\t");
@@ -903,7 +1399,7 @@ PrintSymbolsToFile(FILE *fp)
 void
 PrintSymbols(void)
 {
-  PrintSymbolsToFile(stdout);
+  PrintSymbolsToFile(LISTING);
 }
 
 //------------------------------------------------------------------------
@@ -914,7 +1410,7 @@ UnresolvedSymbols(void)
   int i, Ret = 0;
 
   for (i = 0; i < SymbolTableSize; i++)
-    if (SymbolTable[i].Value.Invalid)
+    if (SymbolValues[i].Invalid)
       Ret++;
 
   return (Ret);
@@ -930,8 +1426,17 @@ UnresolvedSymbols(void)
 // These holds entries for every single compiled line in the source and
 // its file and line number. This table is needed to print out the source
 // line as we step through code. It is also needed for "break <line #>".
-SymbolLine_t *LineTable = NULL;
-int LineTableSize = 0, LineTableMax = 0, numSymbolsReassigned = 0;
+// It's a SymbolLine_t except that the file name is an index into
+// SymbolFiles[] (-1 for none), since there's an entry for every word of
+// code but only a handful of files.  GetLine() fills in the whole thing.
+typedef struct
+{
+  Address_t CodeAddress;                // Must be first; see SortLines().
+  unsigned int LineNumber;
+  short FileId;
+} LineEntry_t;
+static ASSEMBLY LineEntry_t *LineTable = NULL;
+ASSEMBLY int LineTableSize = 0, LineTableMax = 0, numSymbolsReassigned = 0;
 
 //------------------------------------------------------------------------
 // Assign a symbol a new value including is type, and the file name/line
@@ -942,7 +1447,7 @@ EditSymbolNew(const char *Name, Address_t *Value, int Type, char *FileName,
     unsigned int LineNumber)
 {
   char Namespace = 0;
-  Symbol_t *Symbol;
+  int Symbol;
 
   //if (!strcmp(Name, "VPRED"))
   //  {
@@ -950,34 +1455,46 @@ EditSymbolNew(const char *Name, Address_t *Value, int Type, char *FileName,
   //  }
 
   // Find out where the symbol is located in the symbol table.
-  Symbol = GetSymbol(Name);
-  if (Symbol == NULL)
+  Symbol = FindSymbol(Name);
+  if (Symbol < 0)
     {
-      printf("Implementation error: symbol %d,\"%s\" lost between passes.\n",
+      fprintf(LISTING,
+          "Implementation error: symbol %d,\"%s\" lost between passes.\n",
           Namespace, Name);
+      ResolveVolatile();
       return (1);
     }
 
   // This can't happen, but still ...
-  if (strcmp(Name, Symbol->Name))
-    printf("***** Name mismatch:  %s/%s\n", Name, Symbol->Name);
-
-#if 0
-  // Check to see if the symbol is in a namespace that allows it to be
-  // reassigned.
-  printf("Symbol \"%s\" in namespace %d cannot be reassigned.\n",
-      Symbol->Name, Symbol->Namespace);
-#endif
+  if (strcmp(Name, SymbolNames[Symbol]))
+    fprintf(LISTING, "***** Name mismatch:  %s/%s\n", Name,
+        SymbolNames[Symbol]);
+
+  return (EditSymbolNumber(Symbol, Value, Type, FileName, LineNumber));
+}
+
+//------------------------------------------------------------------------
+// Same as EditSymbolNew(), except that the symbol is given by its symbol
+// number rather than by name.
+int
+EditSymbolNumber(int Symbol, Address_t *Value, int Type, char *FileName,
+    unsigned int LineNumber)
+{
+  int Changed;
 
   // Reassign the value.
-  if (memcmp(&Symbol->Value, Value, sizeof (*Value)))
+  Changed = (0 != memcmp(&SymbolValues[Symbol], Value, sizeof (*Value)));
+  if (Changed)
     numSymbolsReassigned++;
-  Symbol->Value = *Value;
+  SymbolValues[Symbol] = *Value;
+  ResolveNoteEdit(Symbol, Value, Type, LineNumber, Changed);
 
   // Assign the symbol type, file name, and line number
-  Symbol->Type = Type;
-  Symbol->LineNumber = LineNumber;
-  strcpy(Symbol->FileName, FileName);
+  SymbolTypes[Symbol] = Type;
+  SymbolLineNumbers[Symbol] = LineNumber;
+  SymbolFileIds[Symbol] = InternSymbolFile(FileName);
+  if (SymbolFileIds[Symbol] == -2)
+    return (1);
 
   return (0);
 }
@@ -1004,6 +1521,7 @@ WriteSymbolsToFile(char *fname)
 
   // Open the symbol table file
   step = 1;
+  CacheNoteOutput(fname);
 #ifdef MSC_VS
   if ((fd = _sopen_s(&fd, fname, _O_BINARY | _O_WRONLY | _O_CREAT |
               _O_TRUNC, _SH_DENYWR, _S_IREAD | _S_IWRITE)) < 0)
@@ -1030,7 +1548,12 @@ WriteSymbolsToFile(char *fname)
   step = 4;
   for (i = 0; i < SymbolTableSize; i++)
     {
-      memcpy(&symbol, (void *) &SymbolTable[i], sizeof(Symbol_t));
+      memset(&symbol, 0, sizeof(Symbol_t));
+      memcpy(symbol.Name, SymbolNames[i], sizeof(symbol.Name));
+      symbol.Value = SymbolValues[i];
+      symbol.Type = SymbolTypes[i];
+      strcpy(symbol.FileName, GetSymbolFileName(i));
+      symbol.LineNumber = SymbolLineNumbers[i];
       LittleEndian32(&symbol);
       LittleEndian32(&symbol.Value.Value);
       LittleEndian32(&symbol.Type);
@@ -1044,7 +1567,7 @@ WriteSymbolsToFile(char *fname)
   step = 5;
   for (i = 0; i < LineTableSize; i++)
     {
-      memcpy(&Line, (void *) &LineTable[i], sizeof(SymbolLine_t));
+      GetLine(i, &Line);
       LittleEndian32(&Line);
       LittleEndian32(&Line.CodeAddress.Value);
       LittleEndian32(&Line.LineNumber);
@@ -1056,10 +1579,11 @@ WriteSymbolsToFile(char *fname)
       char *s;
       error: ;
       s = strerror(errno);
-      printf("\nFile error (symbol-table write, step %d): %s.\n", step, s);
+      fprintf(LISTING, "\nFile error (symbol-table write, step %d): %s.\n",
+          step, s);
     }
   else
-    printf("\nSymbol-table file written.\n");
+    fprintf(LISTING, "\nSymbol-table file written.\n");
   close(fd);
 }
 
@@ -1083,45 +1607,50 @@ ClearLines(void)
 int
 AddLine(Address_t *Address, const char *FileName, int LineNumber)
 {
+  int FileId, i;
+
   // A sanity clause.
   if (strlen(FileName) > MAX_FILE_LENGTH)
     {
-      printf("File name \"%s\" is too long.\n", FileName);
+      fprintf(LISTING, "File name \"%s\" is too long.\n", FileName);
       return (1);
     }
+  FileId = InternSymbolFile(FileName);
+  if (FileId == -2)
+    return (1);
 
   // If the line table is too small, enlarge it.
   if (LineTableSize == LineTableMax)
     {
-      if (LineTable == NULL)
-        {
-          // This default size comes from the fact that I know there is 32K
-          // of fixed memory in the AGC.
-          LineTableMax = 32768;
-          LineTable = (SymbolLine_t *) calloc(LineTableMax,
-              sizeof(SymbolLine_t));
-        }
-      else
-        {
-          LineTableMax += 1000;
-          LineTable = (SymbolLine_t *) realloc(LineTable,
-              LineTableMax * sizeof(SymbolLine_t));
-        }
-      if (LineTable == NULL)
-        {
-          printf("Out of memory (3).\n");
-          return (1);
-        }
+      // This initial size comes from the fact that I know there is 32K
+      // of fixed memory in the AGC.
+      i = LineTableMax ? 2 * LineTableMax : 32768;
+      if (GrowArray(&LineTable, i * sizeof(LineEntry_t)))
+        return (1);
+      LineTableMax = i;
     }
 
   // Now add the line but adjust for the word inside the instruction.
   LineTable[LineTableSize].CodeAddress = *Address;
-  strcpy(LineTable[LineTableSize].FileName, FileName);
+  LineTable[LineTableSize].FileId = FileId;
   LineTable[LineTableSize].LineNumber = LineNumber;
   LineTableSize++;
   return (0);
 }
 
+//-------------------------------------------------------------------------
+// Fill in a SymbolLine_t, as written to the symbol-table file, from the
+// given entry of the line table.
+void
+GetLine(int Index, SymbolLine_t *Line)
+{
+  memset(Line, 0, sizeof(SymbolLine_t));
+  Line->CodeAddress = LineTable[Index].CodeAddress;
+  if (LineTable[Index].FileId >= 0)
+    strcpy(Line->FileName, SymbolFiles[LineTable[Index].FileId]);
+  Line->LineNumber = LineTable[Index].LineNumber;
+}
+
 //-------------------------------------------------------------------------
 // Compare function for the line table. We must sort the lines in increasing
 // order of physical address. This routine is used for the AGC way of
@@ -1129,8 +1658,8 @@ AddLine(Address_t *Address, const char *FileName, int LineNumber)
 static int
 CompareLineAGC(const void *Raw1, const void *Raw2)
 {
-#define Address1 ((SymbolLine_t *) Raw1)->CodeAddress
-#define Address2 ((SymbolLine_t *) Raw2)->CodeAddress
+#define Address1 ((LineEntry_t *) Raw1)->CodeAddress
+#define Address2 ((LineEntry_t *) Raw2)->CodeAddress
 
   // It is unclear whether we can ever get erasable addresses here, I
   // don't think so, so we'll just pretend there are fixed address
@@ -1173,8 +1702,8 @@ CompareLineAGC(const void *Raw1, const void *Raw2)
 static int
 CompareLineAGS(const void *Raw1, const void *Raw2)
 {
-#define Address1 ((SymbolLine_t *) Raw1)->CodeAddress
-#define Address2 ((SymbolLine_t *) Raw2)->CodeAddress
+#define Address1 ((LineEntry_t *) Raw1)->CodeAddress
+#define Address2 ((LineEntry_t *) Raw2)->CodeAddress
 
   if (Address1.SReg < Address2.SReg)
     return -1;
@@ -1193,8 +1722,8 @@ CompareLineAGS(const void *Raw1, const void *Raw2)
 static int
 CompareLineASM(const void *Raw1, const void *Raw2)
 {
-#define Address1 ((SymbolLine_t *) Raw1)->CodeAddress
-#define Address2 ((SymbolLine_t *) Raw2)->CodeAddress
+#define Address1 ((LineEntry_t *) Raw1)->CodeAddress
+#define Address2 ((LineEntry_t *) Raw2)->CodeAddress
 
   if (Address1.SReg < Address2.SReg)
     return -1;
@@ -1211,12 +1740,68 @@ CompareLineASM(const void *Raw1, const void *Raw2)
 #undef Address2
 }
 
+//-------------------------------------------------------------------------
+// For SORT_YUL and SORT_LEMAP, the order of a line depends only on an
+// 18-bit key, so the line table can be sorted by counting rather than by
+// comparing.  The key for SORT_YUL is the bank (as in CompareLineAGC,
+// which is at most 047) followed by the 12-bit S-register, and for
+// SORT_LEMAP it's just the S-register.
+#define LINE_KEYS (060 << 12)
+
+static int
+LineKey(const Address_t *Address, int Type)
+{
+  int Bank;
+
+  if (Type == SORT_LEMAP)
+    return (Address->SReg);
+  if (Address->Banked && Address->FB >= 020 && Address->Super)
+    Bank = Address->FB + 010;
+  else if (Address->Banked)
+    Bank = Address->FB;
+  else
+    Bank = Address->SReg / 02000;
+  return ((Bank << 12) | Address->SReg);
+}
+
+// Counting sort of the line table.  Like the qsort() it replaces, lines
+// at the same address keep the order in which they were added.  Returns
+// 0 on success, or 1 if out of memory.
+static int
+CountingSortLines(int Type)
+{
+  LineEntry_t *Sorted;
+  int *Counts, i;
+
+  Counts = (int *) calloc(LINE_KEYS + 1, sizeof(int));
+  Sorted = (LineEntry_t *) malloc((LineTableMax ? LineTableMax : 1)
+      * sizeof(LineEntry_t));
+  if (Counts == NULL || Sorted == NULL)
+    {
+      free(Counts);
+      free(Sorted);
+      return (1);
+    }
+
+  for (i = 0; i < LineTableSize; i++)
+    Counts[LineKey(&LineTable[i].CodeAddress, Type) + 1]++;
+  for (i = 1; i <= LINE_KEYS; i++)
+    Counts[i] += Counts[i - 1];
+  for (i = 0; i < LineTableSize; i++)
+    Sorted[Counts[LineKey(&LineTable[i].CodeAddress, Type)]++] = LineTable[i];
+
+  free(Counts);
+  free(LineTable);
+  LineTable = Sorted;
+  return (0);
+}
+
 //-------------------------------------------------------------------------
 // Sort the line table.
 void
 SortLines(int Type)
 {
-  int i, j;
+  int i, j, Same;
   int
   (*Compare)(const void *, const void *);
 
@@ -1229,32 +1814,222 @@ SortLines(int Type)
     Compare = CompareLineASM;
   else
     {
-      printf("Invalid architecture type given.\n");
+      fprintf(LISTING, "Invalid architecture type given.\n");
       return;
     }
 
-  qsort(LineTable, LineTableSize, sizeof(SymbolLine_t), Compare);
+  if (Type == SORT_ASM || CountingSortLines(Type))
+    qsort(LineTable, LineTableSize, sizeof(LineEntry_t), Compare);
 
   // Remove duplicates from the line table. I think this is a completely
   // normal situation because multiple passes are made throug the code
-  // when compiling.
-  printf("Removing the duplicated lines... ");
-  for (i = 1; i < LineTableSize;)
+  // when compiling.  Of each run of lines at the same address, the last
+  // is the one kept.
+  fprintf(LISTING, "Removing the duplicated lines... ");
+  for (i = j = 0; i < LineTableSize; i++)
     {
-      if (!Compare((const void *) &LineTable[i - 1].CodeAddress,
-          (const void *) &LineTable[i].CodeAddress))
-        {
-          AddressPrint(&LineTable[i - 1].CodeAddress);
+      if (i + 1 == LineTableSize)
+        Same = 0;
+      else if (Type == SORT_ASM)
+        Same = !Compare((const void *) &LineTable[i].CodeAddress,
+            (const void *) &LineTable[i + 1].CodeAddress);
+      else
+        Same = (LineKey(&LineTable[i].CodeAddress, Type)
+            == LineKey(&LineTable[i + 1].CodeAddress, Type));
+      if (Same)
+        AddressPrint(&LineTable[i].CodeAddress);
+      else
+        LineTable[j++] = LineTable[i];
+    }
+  LineTableSize = j;
+  fprintf(LISTING, "\n");
+}
 
-          for (j = i; j < LineTableSize; j++)
-            LineTable[j - 1] = LineTable[j];
+//-------------------------------------------------------------------------
+// Store little-endian fields of a version-2 symbol-table file (see
+// SymtabHeader_t), returning where the next field goes.  The records have
+// no padding, so their fields are simply stored one after another.
+static unsigned char *
+PutSymtab32(unsigned char *Out, uint32_t Value)
+{
+  Out[0] = Value & 0xFF;
+  Out[1] = (Value >> 8) & 0xFF;
+  Out[2] = (Value >> 16) & 0xFF;
+  Out[3] = (Value >> 24) & 0xFF;
+  return (Out + 4);
+}
 
-          LineTableSize--;
-        }
-      else
+// The reserved bytes are left alone, since the image starts out zeroed.
+static unsigned char *
+PutSymtabAddress(unsigned char *Out, const Address_t *Address)
+{
+  unsigned Flags;
+
+  Flags = (Address->Invalid ? SYMTAB_INVALID : 0)
+      | (Address->Constant ? SYMTAB_CONSTANT : 0)
+      | (Address->Address ? SYMTAB_ADDRESS : 0)
+      | (Address->Erasable ? SYMTAB_ERASABLE : 0)
+      | (Address->Fixed ? SYMTAB_FIXED : 0)
+      | (Address->Unbanked ? SYMTAB_UNBANKED : 0)
+      | (Address->Banked ? SYMTAB_BANKED : 0)
+      | (Address->Super ? SYMTAB_SUPER : 0)
+      | (Address->Overflow ? SYMTAB_OVERFLOW : 0);
+  Out = PutSymtab32(Out, (uint32_t) Address->Value);
+  Out[0] = Address->SReg & 0xFF;
+  Out[1] = (Address->SReg >> 8) & 0xFF;
+  Out[2] = Flags & 0xFF;
+  Out[3] = (Flags >> 8) & 0xFF;
+  Out[4] = (Address->FB << 3) | Address->EB;
+  return (Out + 8);
+}
+
+// Append a string to the string table, returning its offset.
+static uint32_t
+PutSymtabString(unsigned char *Strings, uint32_t *StringsSize, const char *s)
+{
+  uint32_t Offset = *StringsSize;
+  size_t n = strlen(s) + 1;
+
+  memcpy(&Strings[Offset], s, n);
+  *StringsSize += n;
+  return (Offset);
+}
+
+#define SYMTAB_ALIGN(n) (((n) + 7) & ~7)
+
+//-------------------------------------------------------------------------
+// Writes the symbol table and the line table (which must have been sorted
+// by SortLines(SORT_YUL)) to a file in version 2 of the format.  The whole
+// file is built in memory and written at once.
+void
+WriteSymtab(char *fname)
+{
+  char SourcePath[MAX_PATH_LENGTH];
+  unsigned char *Image = NULL, *Out, *Strings;
+  uint32_t *FileOffsets = NULL, StringsSize, SymbolsOffset, LinesOffset;
+  uint32_t IndexOffset, StringsOffset, FileSize;
+  int *Order = NULL;
+  int i, Bank, fd = -1, step;
+  size_t n;
+
+  // Open the symbol table file
+  step = 1;
+  CacheNoteOutput(fname);
+#ifdef MSC_VS
+  if ((fd = _sopen_s(&fd, fname, _O_BINARY | _O_WRONLY | _O_CREAT |
+              _O_TRUNC, _SH_DENYWR, _S_IREAD | _S_IWRITE)) < 0)
+  goto error;
+#else
+  if ((fd = open(fname, O_BINARY | O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0)
+    goto error;
+#endif
+
+  step = 2;
+  if (NULL == getcwd(SourcePath, MAX_PATH_LENGTH))
+    goto error;
+
+  // Work out where everything goes.
+  step = 3;
+  n = 1 + strlen(SourcePath) + 1;
+  for (i = 0; i < SymbolTableSize; i++)
+    n += strlen(SymbolNames[i]) + 1;
+  for (i = 0; i < NumSymbolFiles; i++)
+    n += strlen(SymbolFiles[i]) + 1;
+  SymbolsOffset = SYMTAB_ALIGN(sizeof(SymtabHeader_t));
+  LinesOffset = SYMTAB_ALIGN(SymbolsOffset
+      + SymbolTableSize * sizeof(SymtabSymbol_t));
+  IndexOffset = SYMTAB_ALIGN(LinesOffset
+      + LineTableSize * sizeof(SymtabLine_t));
+  StringsOffset = SYMTAB_ALIGN(IndexOffset
+      + (SYMTAB_BANKS + 1) * sizeof(uint32_t));
+  FileSize = StringsOffset + n;
+  Image = (unsigned char *) calloc(FileSize, 1);
+  FileOffsets = (uint32_t *) malloc((NumSymbolFiles + 1) * sizeof(uint32_t));
+  Order = (int *) malloc((SymbolTableSize + 1) * sizeof(int));
+  if (Image == NULL || FileOffsets == NULL || Order == NULL)
+    {
+      fprintf(LISTING, "Out of memory (3).\n");
+      OutOfMemory = 1;
+      goto done;
+    }
+
+  // The string table.  The symbol names are stored in the same order as
+  // the symbols.
+  Strings = &Image[StringsOffset];
+  StringsSize = 1;
+  for (i = 0; i < NumSymbolFiles; i++)
+    FileOffsets[i] = PutSymtabString(Strings, &StringsSize, SymbolFiles[i]);
+
+  // The header.
+  Out = Image;
+  memcpy(Out, SYMTAB_MAGIC, 8);
+  Out = PutSymtab32(Out + 8, SYMTAB_VERSION);
+  Out = PutSymtab32(Out, sizeof(SymtabHeader_t));
+  Out = PutSymtab32(Out, FileSize);
+  Out = PutSymtab32(Out, PutSymtabString(Strings, &StringsSize, SourcePath));
+  Out = PutSymtab32(Out, SymbolTableSize);
+  Out = PutSymtab32(Out, SymbolsOffset);
+  Out = PutSymtab32(Out, LineTableSize);
+  Out = PutSymtab32(Out, LinesOffset);
+  Out = PutSymtab32(Out, IndexOffset);
+  Out = PutSymtab32(Out, StringsOffset);
+  Out = PutSymtab32(Out, n);
+
+  // The symbols.  SortSymbols() has normally put them in order already,
+  // but make sure.
+  for (i = 0; i < SymbolTableSize; i++)
+    Order[i] = i;
+  qsort(Order, SymbolTableSize, sizeof(int), CompareSymbolName);
+  Out = &Image[SymbolsOffset];
+  for (i = 0; i < SymbolTableSize; i++)
+    {
+      int Symbol = Order[i];
+
+      Out = PutSymtab32(Out, PutSymtabString(Strings, &StringsSize,
+          SymbolNames[Symbol]));
+      Out = PutSymtab32(Out, SymbolTypes[Symbol]);
+      Out = PutSymtab32(Out, (SymbolFileIds[Symbol] < 0) ? 0
+          : FileOffsets[SymbolFileIds[Symbol]]);
+      Out = PutSymtab32(Out, SymbolLineNumbers[Symbol]);
+      Out = PutSymtabAddress(Out, &SymbolValues[Symbol]);
+    }
+
+  // The lines, and the index of where each bank's lines begin.
+  Out = &Image[LinesOffset];
+  for (i = 0; i < LineTableSize; i++)
+    {
+      Out = PutSymtabAddress(Out, &LineTable[i].CodeAddress);
+      Out = PutSymtab32(Out, (LineTable[i].FileId < 0) ? 0
+          : FileOffsets[LineTable[i].FileId]);
+      Out = PutSymtab32(Out, LineTable[i].LineNumber);
+    }
+  Out = &Image[IndexOffset];
+  for (Bank = i = 0; Bank <= SYMTAB_BANKS; Bank++)
+    {
+      while (i < LineTableSize
+          && (LineKey(&LineTable[i].CodeAddress, SORT_YUL) >> 12) < Bank)
         i++;
+      Out = PutSymtab32(Out, i);
+    }
+
+  step = 4;
+  if (write(fd, (void *) Image, FileSize) != (int) FileSize)
+    goto error;
+  fprintf(LISTING, "\nSymbol-table file written.\n");
+  if (0)
+    {
+      char *s;
+      error: ;
+      s = strerror(errno);
+      fprintf(LISTING, "\nFile error (symbol-table write, step %d): %s.\n",
+          step, s);
     }
-  printf("\n");
+  done: ;
+  free(Image);
+  free(FileOffsets);
+  free(Order);
+  if (fd >= 0)
+    close(fd);
 }
 
 //------------------------------------------------------------------------
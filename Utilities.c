@@ -29,6 +29,8 @@
  *              2017-01-30 MAS  Added a function to calculate parity.
  *              2017-06-17 MAS  Killed the FixSuperbankBits function and
  *                              split up printing of SBanks and EBanks.
+ *              2026-10-17 AGT  CalculateParity() uses PARITY16 rather than
+ *                              a loop over the bits.
  */
 
 #include "yaYUL.h"
@@ -41,50 +43,50 @@
 void
 PrintAddress(const Address_t *address)
 {
-  printf("|");
+  fprintf(LISTING, "|");
   if (address->Invalid)
-    printf("I");
+    fprintf(LISTING, "I");
   else
-    printf(" ");
+    fprintf(LISTING, " ");
   if (address->Constant)
-    printf("C");
+    fprintf(LISTING, "C");
   else
-    printf(" ");
+    fprintf(LISTING, " ");
   if (address->Address)
-    printf("A");
+    fprintf(LISTING, "A");
   else
-    printf(" ");
+    fprintf(LISTING, " ");
   if (address->Erasable)
-    printf("E");
+    fprintf(LISTING, "E");
   else if (address->Fixed)
-    printf("F");
+    fprintf(LISTING, "F");
   else
-    printf(" ");
+    fprintf(LISTING, " ");
   if (address->Banked)
-    printf("B");
+    fprintf(LISTING, "B");
   else
-    printf(" ");
+    fprintf(LISTING, " ");
   if (address->Super)
-    printf("S");
+    fprintf(LISTING, "S");
   else
-    printf(" ");
+    fprintf(LISTING, " ");
   if (address->Overflow)
-    printf("O");
+    fprintf(LISTING, "O");
   else
-    printf(" ");
-  printf("|SREG=%04o|", address->SReg);
+    fprintf(LISTING, " ");
+  fprintf(LISTING, "|SREG=%04o|", address->SReg);
   if (!address->Invalid)
     {
       if (address->Erasable)
-        printf("EB=%03o|", address->EB);
+        fprintf(LISTING, "EB=%03o|", address->EB);
       if (address->Fixed)
-        printf("FB=%03o|", address->FB);
+        fprintf(LISTING, "FB=%03o|", address->FB);
     }
   else
     {
-      printf("      |");
+      fprintf(LISTING, "      |");
     }
-  printf("%06o|", address->Value);
+  fprintf(LISTING, "%06o|", address->Value);
 }
 
 //-------------------------------------------------------------------------
@@ -92,7 +94,7 @@ PrintAddress(const Address_t *address)
 void
 PrintEBank(const EBank_t *bank)
 {
-  printf("|%d", bank->oneshotPending);
+  fprintf(LISTING, "|%d", bank->oneshotPending);
   PrintAddress(&bank->current);
   PrintAddress(&bank->last);
 }
@@ -102,7 +104,8 @@ PrintEBank(const EBank_t *bank)
 void
 PrintSBank(const SBank_t *bank)
 {
-  printf("|%d|%u|%u|", bank->oneshotPending, bank->current, bank->last);
+  fprintf(LISTING, "|%d|%u|%u|", bank->oneshotPending, bank->current,
+      bank->last);
 }
 
 //-------------------------------------------------------------------------
@@ -111,9 +114,9 @@ void
 PrintInputRecord(const ParseInput_t *record)
 {
   PrintAddress(&record->ProgramCounter);
-  printf(" ");
+  fprintf(LISTING, " ");
   PrintEBank(&record->EBank);
-  printf(" ");
+  fprintf(LISTING, " ");
   PrintSBank(&record->SBank);
 }
 
@@ -123,9 +126,9 @@ void
 PrintOutputRecord(const ParseOutput_t *record)
 {
   PrintAddress(&record->ProgramCounter);
-  printf(" ");
+  fprintf(LISTING, " ");
   PrintEBank(&record->EBank);
-  printf(" ");
+  fprintf(LISTING, " ");
   PrintSBank(&record->SBank);
 }
 
@@ -134,14 +137,14 @@ PrintOutputRecord(const ParseOutput_t *record)
 void
 PrintTrace(const ParseInput_t *inRecord, const ParseOutput_t *outRecord)
 {
-  printf(
+  fprintf(LISTING, 
       "---    +--------------PC---------------+ +1S-------------curr-------------EBANK-------------last------------+ +1S-------------curr-------------SBANK-------------last------------+\n");
-  printf("--- in ");
+  fprintf(LISTING, "--- in ");
   PrintInputRecord(inRecord);
-  printf("\n");
-  printf("--- out");
+  fprintf(LISTING, "\n");
+  fprintf(LISTING, "--- out");
   PrintOutputRecord(outRecord);
-  printf("\n");
+  fprintf(LISTING, "\n");
 }
 
 //-------------------------------------------------------------------------
@@ -149,14 +152,7 @@ PrintTrace(const ParseInput_t *inRecord, const ParseOutput_t *outRecord)
 int
 CalculateParity(int Value)
 {
-    int p = 1;
     uint16_t n = Value;
 
-    while (n)
-    {
-        n &= (n - 1);
-        p = !p;
-    }
-
-    return p;
+    return PARITY16(n);
 }
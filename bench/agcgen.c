@@ -0,0 +1,575 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    agcgen.c
+ * Purpose:     Generates synthetic AGC assembly-language programs, for
+ *              benchmarking yaYUL.
+ * Mod History: 2026-10-17 AGT  Began.
+ *
+ * The programs aren't meant to do anything, just to look to the assembler
+ * like the real thing:  erasable variables, code and constants in fixed
+ * banks, interpretive blocks, EQUALS, EBANK= and SBANK=, comments, and
+ * $-includes.  They assemble without errors, and for given options the
+ * output is always the same.  The knobs are:
+ *
+ *   --lines=N      Roughly the number of source lines (default 40000).
+ *   --symbols=N    Roughly the number of symbols (default 8000).
+ *   --forward=P    The percentage of references which are forward
+ *                  references (default 30).
+ *   --depth=N      The depth to which $-includes are nested, 0-5 (default 2).
+ *   --interp=P     The percentage of code lines in interpretive blocks
+ *                  (default 20).
+ *   --churn=N      The number of lines between EBANK=/SBANK= (default 50).
+ *   --raytheon     Start each of fixed banks 04 and up with a Raytheon-style
+ *                  SETLOC CFbb2000, rather than with BANK.
+ *   --seed=N       The seed of the random-number generator (default 1).
+ *   --dir=D        The directory in which to write the files (default .).
+ *
+ * The top-level file is D/main.agc, and the included files are
+ * D/file001.agc and so on.  When the fixed memory is full, the remaining
+ * lines are EQUALS and comments, in place of the labeled code.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//-------------------------------------------------------------------------
+// Some global data.
+
+// The options.
+static int Lines = 40000, Symbols = 8000, Forward = 30, Depth = 2;
+static int Interp = 20, Churn = 50, Raytheon = 0;
+static unsigned long Seed = 1;
+static const char *Dir = ".";
+
+// The source lines are generated into an array of these, and only written
+// out once all of the labels are known, so that references can be made
+// forward as easily as backward.
+enum
+{
+  ITEM_FILE,            // Start of a new source file.
+  ITEM_BANK,            // BANK, or SETLOC when Value is set.
+  ITEM_EBANK,           // EBANK=.
+  ITEM_SBANK,           // SBANK=.
+  ITEM_COMMENT,         // A comment.
+  ITEM_BLANK,           // A blank line.
+  ITEM_ERASABLE,        // CA, AD, TS, ... of an erasable variable.
+  ITEM_TRANSFER,        // TC or TCF to a label in the same bank.
+  ITEM_FETCH,           // CA of a constant in the same bank.
+  ITEM_CONSTANT,        // DEC or OCT.
+  ITEM_INTERP,          // An interpretive block.
+  ITEM_EQUALS           // An EQUALS to a label.
+};
+typedef struct
+{
+  unsigned char Kind;
+  unsigned char Bank;   // The fixed bank, or the EBANK for ITEM_EBANK.
+  int Label;            // The item's label, or -1.
+  int Operand;          // The item (or variable) referenced, or -1.
+  int Value;            // Various.
+} Item_t;
+
+// The interpretive blocks are TC INTPRET, one of these pairs of opcodes
+// with their two operands, a store, and EXIT.  The vector ones use STOVL,
+// which takes a second operand, so that the block is 7 words rather than 6.
+#define NUM_INTERP_PAIRS 5
+static const char *InterpPairs[NUM_INTERP_PAIRS][2] = { { "DLOAD", "DAD" },
+    { "DLOAD", "DSU" }, { "DLOAD", "DMP" }, { "VLOAD", "VAD" },
+    { "VLOAD", "VSU" } };
+#define INTERP_VECTOR(n) ((n) >= 3)
+static Item_t *Items = NULL;
+static int NumItems = 0, MaxItems = 0;
+
+// The erasable variables:  NumUnswitched unswitched ones, and then up to
+// VARS_PER_EBANK in each of NumEbanks banks starting at E3.
+#define MAX_UNSWITCHED 200
+#define FIRST_EBANK 3
+#define MAX_EBANKS 5
+#define VARS_PER_EBANK 250
+static int NumVars = 0, NumUnswitched = 0, NumEbanks = 0;
+
+// The fixed banks used for code, in the order they're filled.  The
+// fixed-fixed banks 2 and 3 come first, and there's no point in going
+// beyond bank 037, since the assembler won't fill the superbanks without
+// being told which SBANK applies.
+#define FIRST_BANK 2
+#define LAST_BANK 037
+#define WORDS_PER_BANK 01740
+
+//-------------------------------------------------------------------------
+// A deterministic random-number generator (the one from the C standard),
+// so that the output doesn't depend on the C library.
+static unsigned long
+Random(void)
+{
+  Seed = (Seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+  return ((Seed >> 16) & 0x7FFF);
+}
+
+// Returns a random number 0 <= n < Limit.
+static int
+RandomBelow(int Limit)
+{
+  return ((int) (((Random() << 15) | Random()) % (unsigned long) Limit));
+}
+
+// Returns non-zero with probability Percent/100.
+static int
+Chance(int Percent)
+{
+  return (RandomBelow(100) < Percent);
+}
+
+//-------------------------------------------------------------------------
+static Item_t *
+AddItem(int Kind, int Bank)
+{
+  Item_t *Item;
+
+  if (NumItems == MaxItems)
+    {
+      MaxItems = MaxItems ? 2 * MaxItems : 65536;
+      Items = (Item_t *) realloc(Items, MaxItems * sizeof(Item_t));
+      if (Items == NULL)
+        {
+          fprintf(stderr, "Out of memory.\n");
+          exit(1);
+        }
+    }
+  Item = &Items[NumItems++];
+  Item->Kind = Kind;
+  Item->Bank = Bank;
+  Item->Label = -1;
+  Item->Operand = -1;
+  Item->Value = 0;
+  return (Item);
+}
+
+// Print the name of erasable variable n.
+static void
+PrintVar(FILE *fp, int n)
+{
+  if (n < NumUnswitched)
+    fprintf(fp, "U%03d", n);
+  else
+    fprintf(fp, "E%oV%03d", FIRST_EBANK + (n - NumUnswitched) / VARS_PER_EBANK,
+        (n - NumUnswitched) % VARS_PER_EBANK);
+}
+
+// Pick an erasable variable accessible under the given EBANK.
+static int
+PickVar(int Ebank)
+{
+  int InBank;
+
+  if (Chance(30))
+    return (RandomBelow(NumUnswitched));
+  InBank = NumVars - NumUnswitched - (Ebank - FIRST_EBANK) * VARS_PER_EBANK;
+  if (InBank > VARS_PER_EBANK)
+    InBank = VARS_PER_EBANK;
+  return (NumUnswitched + (Ebank - FIRST_EBANK) * VARS_PER_EBANK
+      + RandomBelow(InBank));
+}
+
+//-------------------------------------------------------------------------
+// Decide what every line will be.
+static void
+Generate(void)
+{
+  int Files, File = -1, Line, Bank = FIRST_BANK, Words = 0, Full = 0;
+  int Ebank = FIRST_EBANK, Label = 0, LabelPercent, EqualsPercent;
+  int NextChurn = Churn, MaxVars = MAX_UNSWITCHED + MAX_EBANKS * VARS_PER_EBANK;
+
+  // About a tenth of the symbols are variables, a fifth are EQUALS, and
+  // the rest are labels.  A fifth of the variables are unswitched.
+  NumVars = Symbols / 10;
+  if (NumVars < 16)
+    NumVars = 16;
+  if (NumVars > MaxVars)
+    NumVars = MaxVars;
+  NumUnswitched = NumVars / 5;
+  if (NumUnswitched > MAX_UNSWITCHED)
+    NumUnswitched = MAX_UNSWITCHED;
+  NumEbanks = (NumVars - NumUnswitched + VARS_PER_EBANK - 1) / VARS_PER_EBANK;
+  EqualsPercent = (Symbols / 5) * 100 / (Lines > 0 ? Lines : 1);
+  if (EqualsPercent > 30)
+    EqualsPercent = 30;
+  LabelPercent = (Symbols - NumVars - Symbols / 5) * 100 / (Lines > 0 ? Lines : 1);
+  if (LabelPercent > 100)
+    LabelPercent = 100;
+  if (LabelPercent < 1)
+    LabelPercent = 1;
+
+  // A file every few thousand lines, if there are includes at all.
+  Files = (Depth > 0) ? 1 + Lines / 4000 : 1;
+
+  for (Line = 0; Line < Lines;)
+    {
+      Item_t *Item;
+      int Kind, Size = 1, Need = 1, Pair = 0, r;
+
+      if (Line * (long) Files / Lines != File)
+        {
+          File = Line * (long) Files / Lines;
+          AddItem(ITEM_FILE, Bank)->Value = File;
+          if (!Full)
+            AddItem(ITEM_BANK, Bank);
+          AddItem(ITEM_EBANK, Ebank);
+          Line += 2;
+        }
+
+      if (Churn > 0 && Line >= NextChurn)
+        {
+          NextChurn += Churn;
+          Ebank = FIRST_EBANK + RandomBelow(NumEbanks);
+          AddItem(ITEM_EBANK, Ebank);
+          Line++;
+          if (Chance(50))
+            {
+              AddItem(ITEM_SBANK, Bank)->Value = RandomBelow(4);
+              Line++;
+            }
+          continue;
+        }
+
+      r = RandomBelow(100);
+      if (r < 12)
+        Kind = ITEM_COMMENT;
+      else if (r < 15)
+        Kind = ITEM_BLANK;
+      else if (r < 15 + EqualsPercent)
+        Kind = ITEM_EQUALS;
+      else if (Full)
+        Kind = Chance(LabelPercent) ? ITEM_EQUALS : ITEM_COMMENT;
+      else if (Chance(Interp))
+        {
+          Kind = ITEM_INTERP;
+          Pair = RandomBelow(NUM_INTERP_PAIRS);
+          Size = Need = INTERP_VECTOR(Pair) ? 7 : 6;
+        }
+      else if ((r = RandomBelow(100)) < 50)
+        Kind = ITEM_ERASABLE;
+      else if (r < 70)
+        Kind = ITEM_TRANSFER;
+      else if (r < 80)
+        Kind = ITEM_FETCH;
+      else
+        Kind = ITEM_CONSTANT;
+
+      if (Kind >= ITEM_ERASABLE && Kind <= ITEM_INTERP
+          && Words + Need > WORDS_PER_BANK)
+        {
+          // On to the next bank, if there is one.
+          Words = 0;
+          if (Bank == LAST_BANK)
+            {
+              Full = 1;
+              continue;
+            }
+          Bank++;
+          AddItem(ITEM_BANK, Bank)->Value = Raytheon && Bank >= 04;
+          Line++;
+        }
+
+      Item = AddItem(Kind, Bank);
+      if (Kind >= ITEM_ERASABLE && Kind <= ITEM_INTERP)
+        {
+          Words += Need;
+          if (Kind == ITEM_CONSTANT || Chance(LabelPercent))
+            Item->Label = Label++;
+        }
+      if (Kind == ITEM_ERASABLE || Kind == ITEM_INTERP)
+        {
+          Item->Operand = PickVar(Ebank);
+          Item->Value = PickVar(Ebank) * NUM_INTERP_PAIRS + Pair;
+        }
+      else if (Kind == ITEM_EQUALS)
+        Item->Label = Label++;
+      Line += Size;
+    }
+}
+
+// Fill in the operands of the TC, TCF, CA and EQUALS lines.  The targets of
+// TC, TCF, and CA are in the same bank as the instruction; EQUALS can refer
+// to labels anywhere.
+static void
+Link(void)
+{
+  int *Labeled, NumLabeled = 0, i, j, Start, End;
+
+  Labeled = (int *) malloc((NumItems + 1) * sizeof(int));
+  if (Labeled == NULL)
+    {
+      fprintf(stderr, "Out of memory.\n");
+      exit(1);
+    }
+  for (i = 0; i < NumItems; i++)
+    if (Items[i].Label >= 0 && Items[i].Kind != ITEM_EQUALS)
+      Labeled[NumLabeled++] = i;
+
+  // Labeled[] is in bank order, so the labels of any bank are contiguous.
+  for (Start = 0; Start < NumLabeled; Start = End)
+    {
+      int Bank = Items[Labeled[Start]].Bank;
+      for (End = Start; End < NumLabeled && Items[Labeled[End]].Bank == Bank;
+          End++)
+        ;
+      for (i = Labeled[Start]; i < (End < NumLabeled ? Labeled[End] : NumItems);
+          i++)
+        {
+          Item_t *Item = &Items[i];
+          int Before, After, Kind = Item->Kind;
+          if ((Kind != ITEM_TRANSFER && Kind != ITEM_FETCH) || Item->Bank != Bank)
+            continue;
+          // The labels before and after this item.
+          for (Before = Start; Before < End && Labeled[Before] < i; Before++)
+            ;
+          After = (Before < End && Labeled[Before] == i) ? Before + 1 : Before;
+          if (After < End && (Before == Start || Chance(Forward)))
+            j = After + RandomBelow(End - After);
+          else if (Before > Start)
+            j = Start + RandomBelow(Before - Start);
+          else
+            j = -1;
+          Item->Operand = (j < 0) ? -1 : Labeled[j];
+        }
+    }
+
+  for (i = 0, j = 0; i < NumItems; i++)
+    {
+      // j is the number of labeled code items before item i.
+      while (j < NumLabeled && Labeled[j] < i)
+        j++;
+      if (Items[i].Kind != ITEM_EQUALS || NumLabeled == 0)
+        continue;
+      if (j < NumLabeled && (j == 0 || Chance(Forward)))
+        Items[i].Operand = Labeled[j + RandomBelow(NumLabeled - j)];
+      else
+        Items[i].Operand = Labeled[RandomBelow(j)];
+      Items[i].Value = RandomBelow(8);
+    }
+  free(Labeled);
+}
+
+//-------------------------------------------------------------------------
+// Write out the files.
+
+static void
+PrintLabel(FILE *fp, const Item_t *Item)
+{
+  if (Item->Kind == ITEM_EQUALS)
+    fprintf(fp, "S%05d", Item->Label);
+  else
+    fprintf(fp, "B%02oL%05d", Item->Bank, Item->Label);
+}
+
+static FILE *
+OpenFile(int File)
+{
+  char Filename[1024];
+  FILE *fp;
+
+  if (File == 0)
+    snprintf(Filename, sizeof(Filename), "%s/main.agc", Dir);
+  else
+    snprintf(Filename, sizeof(Filename), "%s/file%03d.agc", Dir, File);
+  fp = fopen(Filename, "w");
+  if (fp == NULL)
+    {
+      fprintf(stderr, "Cannot create %s.\n", Filename);
+      exit(1);
+    }
+  fprintf(fp, "# Generated by agcgen --lines=%d --symbols=%d --forward=%d "
+      "--depth=%d --interp=%d --churn=%d\n", Lines, Symbols, Forward, Depth,
+      Interp, Churn);
+  return (fp);
+}
+
+static void
+Write(void)
+{
+  static const char *ErasableOps[] = { "CA", "CS", "AD", "TS", "XCH", "INCR",
+      "MASK", "ADS" };
+  static const char *Comments[] = { "# ARBITRARY COMMENT TEXT FOR THE BENCHMARK.",
+      "# INITIALIZE THE FLAGWORDS AND RESTART THE INTERPRETER.",
+      "## Page 123", "#          (THIS SPACE INTENTIONALLY LEFT BLANK)" };
+  FILE *Stack[8], *fp = NULL;
+  int Sp = 0, i, n;
+
+  for (i = 0; i < NumItems; i++)
+    {
+      Item_t *Item = &Items[i];
+      const Item_t *Target =
+          (Item->Operand >= 0 && Item->Kind != ITEM_ERASABLE
+              && Item->Kind != ITEM_INTERP) ? &Items[Item->Operand] : NULL;
+
+      if (Item->Label >= 0)
+        PrintLabel(fp, Item);
+      switch (Item->Kind)
+        {
+      case ITEM_FILE:
+        n = Item->Value;
+        if (n == 0)
+          {
+            // The erasable variables, and a stand-in for the interpreter.
+            fp = OpenFile(0);
+            fprintf(fp, "\t\tSETLOC\t1000\n");
+            for (n = 0; n < NumVars; n++)
+              {
+                if (n >= NumUnswitched && (n - NumUnswitched) % VARS_PER_EBANK == 0)
+                  fprintf(fp, "\t\tSETLOC\t%o\n", 0400 * (FIRST_EBANK
+                      + (n - NumUnswitched) / VARS_PER_EBANK));
+                PrintVar(fp, n);
+                fprintf(fp, "\t\tERASE\n");
+              }
+            fprintf(fp, "Q\t\tEQUALS\t2\nINTPRET\t\tEQUALS\t4000\n");
+            Stack[Sp++] = fp;
+            break;
+          }
+        // Files are nested Depth deep:  file n is at level (n - 1) % Depth + 1,
+        // and is included by the file at the level above it (main.agc being
+        // at level 0).  Close any files below that one, and include it.
+        while (Sp > (n - 1) % Depth + 1)
+          fclose(Stack[--Sp]);
+        fprintf(Stack[Sp - 1], "$file%03d.agc\n", n);
+        fp = Stack[Sp++] = OpenFile(n);
+        break;
+      case ITEM_BANK:
+        if (Item->Value)
+          fprintf(fp, "\t\tSETLOC\tCF%02o2000\n", Item->Bank);
+        else
+          fprintf(fp, "\t\tBANK\t%o\n", Item->Bank);
+        break;
+      case ITEM_EBANK:
+        fprintf(fp, "\t\tEBANK=\tE%oV000\n", Item->Bank);
+        break;
+      case ITEM_SBANK:
+        fprintf(fp, "\t\tSBANK=\t%o\n", 070000 + 02000 * Item->Value);
+        break;
+      case ITEM_COMMENT:
+        fprintf(fp, "%s\n", Comments[RandomBelow(4)]);
+        break;
+      case ITEM_BLANK:
+        fprintf(fp, "\n");
+        break;
+      case ITEM_ERASABLE:
+        fprintf(fp, "\t\t%s\t", ErasableOps[RandomBelow(8)]);
+        PrintVar(fp, Item->Operand);
+        fprintf(fp, "\n");
+        break;
+      case ITEM_TRANSFER:
+      case ITEM_FETCH:
+        // With no label to go to, it's just a return.
+        if (Target == NULL)
+          fprintf(fp, "\t\t%s\tQ\n", Item->Kind == ITEM_FETCH ? "CA" : "TC");
+        else
+          {
+            fprintf(fp, "\t\t%s\t", Item->Kind == ITEM_FETCH ? "CA"
+                : Chance(50) ? "TC" : "TCF");
+            PrintLabel(fp, Target);
+            fprintf(fp, "\n");
+          }
+        break;
+      case ITEM_CONSTANT:
+        if (Chance(50))
+          fprintf(fp, "\t\tDEC\t%d\n", RandomBelow(16384));
+        else
+          fprintf(fp, "\t\tOCT\t%05o\n", RandomBelow(32768));
+        break;
+      case ITEM_INTERP:
+        n = Item->Value % NUM_INTERP_PAIRS;
+        fprintf(fp, "\t\tTC\tINTPRET\n\t\t%s\t%s\n\t\t\t", InterpPairs[n][0],
+            InterpPairs[n][1]);
+        PrintVar(fp, Item->Operand);
+        fprintf(fp, "\n\t\t\t");
+        PrintVar(fp, Item->Value / NUM_INTERP_PAIRS);
+        fprintf(fp, "\n\t\t%s\t", INTERP_VECTOR(n) ? "STOVL" : "STORE");
+        PrintVar(fp, Item->Operand);
+        if (INTERP_VECTOR(n))
+          {
+            fprintf(fp, "\n\t\t\t");
+            PrintVar(fp, Item->Value / NUM_INTERP_PAIRS);
+          }
+        fprintf(fp, "\n\t\tEXIT\n");
+        break;
+      case ITEM_EQUALS:
+        fprintf(fp, "\t\tEQUALS\t");
+        if (Target == NULL)
+          fprintf(fp, "INTPRET\n");
+        else
+          {
+            PrintLabel(fp, Target);
+            fprintf(fp, " +%d\n", Item->Value);
+          }
+        break;
+        }
+    }
+  while (Sp > 0)
+    fclose(Stack[--Sp]);
+}
+
+//-------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+  int i;
+
+  for (i = 1; i < argc; i++)
+    {
+      if (1 == sscanf(argv[i], "--lines=%d", &Lines))
+        ;
+      else if (1 == sscanf(argv[i], "--symbols=%d", &Symbols))
+        ;
+      else if (1 == sscanf(argv[i], "--forward=%d", &Forward))
+        ;
+      else if (1 == sscanf(argv[i], "--depth=%d", &Depth))
+        ;
+      else if (1 == sscanf(argv[i], "--interp=%d", &Interp))
+        ;
+      else if (1 == sscanf(argv[i], "--churn=%d", &Churn))
+        ;
+      else if (1 == sscanf(argv[i], "--seed=%lu", &Seed))
+        ;
+      else if (!strcmp(argv[i], "--raytheon"))
+        Raytheon = 1;
+      else if (!strncmp(argv[i], "--dir=", 6))
+        Dir = &argv[i][6];
+      else
+        {
+          fprintf(stderr, "Usage:\n"
+              "\tagcgen [--lines=N] [--symbols=N] [--forward=P] [--depth=N]\n"
+              "\t       [--interp=P] [--churn=N] [--raytheon] [--seed=N]\n"
+              "\t       [--dir=D]\n");
+          return (1);
+        }
+    }
+  if (Lines < 100)
+    Lines = 100;
+  if (Depth < 0 || Depth > 5)
+    {
+      fprintf(stderr, "The include depth must be 0-5.\n");
+      return (1);
+    }
+
+  Generate();
+  Link();
+  Write();
+  return (0);
+}
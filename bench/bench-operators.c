@@ -0,0 +1,144 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    bench-operators.c
+ * Purpose:     A microbenchmark of operator dispatch:  the perfect hash
+ *              table of Pass.c against the bsearch() it replaced.
+ * Mod History: 2026-10-17 AGT  Began.
+ *
+ * The operators are taken from the source file given on the command line
+ * (normally test.agc), in order, so that the mix of basic, interpretive
+ * and pseudo-ops, and of the numbers used as operators and the words
+ * which aren't operators at all, is that of a real program.  The operator
+ * is the first field of a line, or the second if there's a label in
+ * column 1; comments and $-includes are skipped.  The whole list is
+ * looked up over and over, --lines=N lines in all (default 10000000), by
+ * LookUpOperator(), first through the hash table and then by bsearch(),
+ * and the time per line of each is listed.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double
+Now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (t.tv_sec + t.tv_nsec / 1E9);
+}
+
+//-------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+  char (*Operators)[1 + MAX_LABEL_LENGTH] = NULL, s[1 + MAX_LINE_LENGTH];
+  char *Field;
+  const char *Filename = NULL;
+  int NumOperators = 0, MaxOperators = 0, Lines = 10000000, i, j;
+  long Found, OldFound;
+  double Start, New, Old;
+  FILE *fp;
+
+  for (i = 1; i < argc; i++)
+    {
+      if (1 == sscanf(argv[i], "--lines=%d", &Lines) && Lines > 0)
+        ;
+      else if (argv[i][0] != '-' && Filename == NULL)
+        Filename = argv[i];
+      else
+        break;
+    }
+  if (i < argc || Filename == NULL)
+    {
+      fprintf(stderr, "Usage:\n\tbench-operators [--lines=N] SOURCEFILE\n");
+      return (1);
+    }
+
+  fp = fopen(Filename, "r");
+  if (fp == NULL)
+    {
+      printf("Cannot open %s.\n", Filename);
+      return (1);
+    }
+  while (fgets(s, sizeof(s), fp) != NULL)
+    {
+      if (s[0] == '#' || s[0] == '$')
+        continue;
+      Field = strtok(s, " \t\r\n");
+      if (Field != NULL && s[0] != ' ' && s[0] != '\t')
+        Field = strtok(NULL, " \t\r\n");
+      if (Field == NULL || Field[0] == '#')
+        continue;
+      if (NumOperators == MaxOperators)
+        {
+          MaxOperators = MaxOperators ? 2 * MaxOperators : 4096;
+          Operators = realloc(Operators, MaxOperators * sizeof(*Operators));
+          if (Operators == NULL)
+            {
+              printf("Out of memory.\n");
+              return (1);
+            }
+        }
+      strncpy(Operators[NumOperators], Field, MAX_LABEL_LENGTH);
+      Operators[NumOperators++][MAX_LABEL_LENGTH] = 0;
+    }
+  fclose(fp);
+  if (NumOperators == 0)
+    {
+      printf("No operators in %s.\n", Filename);
+      return (1);
+    }
+
+  // Once to build the tables, which isn't what's being timed.
+  LookUpOperator(Operators[0], 0);
+
+  Start = Now();
+  for (i = j = 0, Found = 0; i < Lines; i++)
+    {
+      Found += LookUpOperator(Operators[j], 0);
+      if (++j == NumOperators)
+        j = 0;
+    }
+  New = Now() - Start;
+
+  Start = Now();
+  for (i = j = 0, OldFound = 0; i < Lines; i++)
+    {
+      OldFound += LookUpOperator(Operators[j], 1);
+      if (++j == NumOperators)
+        j = 0;
+    }
+  Old = Now() - Start;
+
+  if (Found != OldFound)
+    {
+      printf("The lookups disagree:  %ld found, but %ld by bsearch.\n", Found,
+          OldFound);
+      return (1);
+    }
+  printf("%d operators from %s, %d lines:  "
+      "hash table %.1f ns, bsearch %.1f ns per line\n", NumOperators,
+      Filename, Lines, New * 1E9 / Lines, Old * 1E9 / Lines);
+  return (0);
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    bench-symbols.c
+ * Purpose:     A microbenchmark of symbol lookups:  FindSymbol()'s hash
+ *              index against the bsearch() it replaced.
+ * Mod History: 2026-10-17 AGT  Began.
+ *
+ * The symbol table is filled with --symbols=N (default 8000) names made
+ * the way agcgen makes them, in the same proportions:  a tenth are
+ * erasable variables (U000, E3V000, ...), a fifth are EQUALS (S00000, ...),
+ * and the rest are labels in the fixed banks (B02L00000, ...).  The
+ * symbols are sorted, as after the first pass, and then looked up
+ * --lookups=N times (default 10000000) in a random order, --misses=P
+ * percent of the time (default 10) for a name which isn't there, as
+ * happens with the interpretive opcodes.
+ *
+ * The same lookups are then made with bsearch() over an array of Symbol_t
+ * sorted by name, the way GetSymbol() used to work, and the time per
+ * lookup of each is listed.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static unsigned long Seed = 1;
+
+//-------------------------------------------------------------------------
+// The deterministic random-number generator of agcgen.
+static unsigned long
+Random(void)
+{
+  Seed = (Seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+  return ((Seed >> 16) & 0x7FFF);
+}
+
+static int
+RandomBelow(int Limit)
+{
+  return ((int) (((Random() << 15) | Random()) % (unsigned long) Limit));
+}
+
+static double
+Now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (t.tv_sec + t.tv_nsec / 1E9);
+}
+
+// The comparison GetSymbol() used to give bsearch().
+static int
+CompareSymbols(const void *Raw1, const void *Raw2)
+{
+  return (strcmp(((const Symbol_t *) Raw1)->Name,
+      ((const Symbol_t *) Raw2)->Name));
+}
+
+//-------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+  int Symbols = 8000, Lookups = 10000000, Misses = 10;
+  int NumVars, NumEquals, i, Found, OldFound;
+  char (*Names)[1 + MAX_LABEL_LENGTH];
+  const char **Order;
+  Symbol_t *Table, Key;
+  double Start, New, Old;
+
+  for (i = 1; i < argc; i++)
+    {
+      if (1 == sscanf(argv[i], "--symbols=%d", &Symbols) && Symbols > 0)
+        ;
+      else if (1 == sscanf(argv[i], "--lookups=%d", &Lookups) && Lookups > 0)
+        ;
+      else if (1 == sscanf(argv[i], "--misses=%d", &Misses))
+        ;
+      else
+        {
+          fprintf(stderr, "Usage:\n\tbench-symbols [--symbols=N] "
+              "[--lookups=N] [--misses=P]\n");
+          return (1);
+        }
+    }
+
+  // The names, and the ones which aren't symbols.
+  Names = malloc((Symbols + 1000) * sizeof(*Names));
+  Table = calloc(Symbols, sizeof(Symbol_t));
+  Order = malloc(Lookups * sizeof(char *));
+  if (Names == NULL || Table == NULL || Order == NULL)
+    {
+      printf("Out of memory.\n");
+      return (1);
+    }
+  NumVars = Symbols / 10;
+  NumEquals = Symbols / 5;
+  for (i = 0; i < Symbols; i++)
+    if (i < NumVars / 5)
+      sprintf(Names[i], "U%03d", i);
+    else if (i < NumVars)
+      sprintf(Names[i], "E%oV%03d", 3 + (i - NumVars / 5) / 250,
+          (i - NumVars / 5) % 250);
+    else if (i < NumVars + NumEquals)
+      sprintf(Names[i], "S%05d", i);
+    else
+      sprintf(Names[i], "B%02oL%05d", 2 + (i - NumVars - NumEquals) * 036
+          / (Symbols - NumVars - NumEquals + 1), i);
+  for (i = 0; i < 1000; i++)
+    sprintf(Names[Symbols + i], "X%05d", i);
+
+  // Into the symbol table.
+  for (i = 0; i < Symbols; i++)
+    {
+      if (AddSymbol(Names[i]))
+        return (1);
+      strcpy(Table[i].Name, Names[i]);
+    }
+  if (SortSymbols())
+    return (1);
+  qsort(Table, Symbols, sizeof(Symbol_t), CompareSymbols);
+
+  for (i = 0; i < Lookups; i++)
+    Order[i] = Names[RandomBelow(100) < Misses ? Symbols + RandomBelow(1000)
+        : RandomBelow(Symbols)];
+
+  Start = Now();
+  for (i = Found = 0; i < Lookups; i++)
+    Found += (FindSymbol(Order[i]) >= 0);
+  New = Now() - Start;
+
+  Start = Now();
+  for (i = OldFound = 0; i < Lookups; i++)
+    {
+      strcpy(Key.Name, Order[i]);
+      OldFound += (bsearch(&Key, Table, Symbols, sizeof(Symbol_t),
+          CompareSymbols) != NULL);
+    }
+  Old = Now() - Start;
+
+  if (Found != OldFound)
+    {
+      printf("The lookups disagree:  %d found, but %d by bsearch.\n", Found,
+          OldFound);
+      return (1);
+    }
+  printf("%d symbols, %d lookups (%d found):  "
+      "hash index %.1f ns, bsearch %.1f ns per lookup\n", Symbols,
+      Lookups, Found, New * 1E9 / Lookups, Old * 1E9 / Lookups);
+  return (0);
+}
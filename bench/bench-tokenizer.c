@@ -0,0 +1,241 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    bench-tokenizer.c
+ * Purpose:     A microbenchmark of the source-line tokenizer:  Tokenize()
+ *              in SourceLines.c against the sscanf() it replaced.
+ * Mod History: 2026-10-17 AGT  Began.
+ *              2026-10-17 AGT  The old sscanf() code is timed as well, over
+ *                              any number of files, and the cached
+ *                              tokenizations are bypassed explicitly.
+ *
+ * The source files given on the command line are read once with
+ * GetSourceFile(), and their lines, taken together in order as a single
+ * corpus, are then tokenized over and over, --lines=N lines in all
+ * (default 1000000).  "make microbenchmark" gives it test.agc along with a
+ * large program generated by agcgen, so that the corpus is big enough not
+ * to fit in the cache.
+ *
+ * Each line is tokenized twice.  The first way is Pass()'s code as it was
+ * before SourceLines.c:  the tab expansion by memmove(), the comment search
+ * a character at a time, the six-way sscanf(), and the strstr() for the
+ * column of the first field.  The second way is TokenizeSourceLine(),
+ * which always calls Tokenize() rather than reusing the tokenization
+ * cached in the line, followed by FreeSourceTokens(); so it's timed along
+ * with its allocations, as in the first pass.  With --block1, both do the
+ * column-16 processing.  The two must find the same fields in the same
+ * columns (lines longer than MAX_LINE_LENGTH, which the old code split
+ * and the new one truncates, aren't compared), and the time per line of
+ * each is listed.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double
+Now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (t.tv_sec + t.tv_nsec / 1E9);
+}
+
+//-------------------------------------------------------------------------
+// The code being replaced:  Pass()'s handling of an input line, from the
+// tab expansion through the splitting into fields.  Returns the number of
+// fields, and the column of the first in *Column.
+static int
+OldTokenize(const SourceFile_t *File, const SourceLine_t *Line, int Column16,
+    Line_t Fields[MAX_SOURCE_FIELDS], int *Column)
+{
+  Line_t s;
+  char *ss, *Comment;
+  int NumFields;
+
+  NumFields = (Line->Length < MAX_LINE_LENGTH) ? Line->Length
+      : MAX_LINE_LENGTH;
+  memcpy(s, Line->Text, NumFields);
+  s[NumFields] = 0;
+
+  ss = strstr(s, "\n");
+  if (ss != NULL)
+    *ss = 0;
+  s[sizeof(s) - 1] = 0;
+  for (ss = s; *ss;)
+    {
+      if (*ss == '\t')
+        {
+          int pos, tabStop, len;
+          pos = ss - s;
+          tabStop = ((pos + 8) & ~7);
+          len = strlen(ss + 1);
+          if (tabStop + len >= sizeof(s))
+            len = sizeof(s) - tabStop - 1;
+          if (len > 0)
+            memmove(&s[tabStop], &s[pos + 1], len + 1);
+          else
+            s[tabStop] = 0;
+          for (; pos < tabStop && pos < sizeof(s); pos++)
+            s[pos] = ' ';
+          ss = &s[tabStop];
+        }
+      else
+        ss++;
+    }
+  *ss = 0;
+
+  if (File->yulType)
+    yul2agc(s);
+
+  for (Comment = s; *Comment && *Comment != COMMENT_SEPARATOR; Comment++)
+    ;
+  if (*Comment == COMMENT_SEPARATOR)
+    *Comment++ = 0;
+
+  if (Column16 && strlen(s) >= 16)
+    s[15] = ' ';
+
+  NumFields = sscanf(s, "%s%s%s%s%s%s", Fields[0], Fields[1], Fields[2],
+      Fields[3], Fields[4], Fields[5]);
+  if (NumFields < 1)
+    return (0);
+  *Column = strstr(s, Fields[0]) - s;
+  return (NumFields);
+}
+
+//-------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+  SourceFile_t **Files;
+  SourceTokens_t *Tokens;
+  Line_t Fields[MAX_SOURCE_FIELDS];
+  int NumFiles = 0, Lines = 1000000, Column16 = 0, Done, Column, i, j, k, n;
+  long NumLines = 0, Bytes = 0, Fields1 = 0, Fields2 = 0, Compared = 0;
+  double Start, Old, New;
+
+  Files = (SourceFile_t **) calloc(argc, sizeof(SourceFile_t *));
+  if (Files == NULL)
+    {
+      printf("Out of memory.\n");
+      return (1);
+    }
+  for (i = 1; i < argc; i++)
+    {
+      if (1 == sscanf(argv[i], "--lines=%d", &Lines) && Lines > 0)
+        ;
+      else if (!strcmp(argv[i], "--block1"))
+        Column16 = 1;
+      else if (argv[i][0] != '-')
+        {
+          Files[NumFiles] = GetSourceFile(argv[i]);
+          if (Files[NumFiles] == NULL)
+            {
+              printf("Cannot read %s.\n", argv[i]);
+              return (1);
+            }
+          NumLines += Files[NumFiles]->NumLines;
+          NumFiles++;
+        }
+      else
+        break;
+    }
+  if (i < argc || NumFiles == 0)
+    {
+      fprintf(stderr, "Usage:\n\tbench-tokenizer [--lines=N] [--block1] "
+          "SOURCEFILE ...\n");
+      return (1);
+    }
+  if (NumLines == 0)
+    {
+      printf("There are no lines to tokenize.\n");
+      return (1);
+    }
+
+  // Check that the two agree, once through the corpus.
+  for (i = 0; i < NumFiles; i++)
+    for (j = 0; j < Files[i]->NumLines; j++)
+      {
+        Tokens = TokenizeSourceLine(Files[i], &Files[i]->Lines[j], Column16);
+        if (Tokens == NULL)
+          {
+            printf("Out of memory.\n");
+            return (1);
+          }
+        if (!Tokens->Truncated)
+          {
+            Compared++;
+            n = OldTokenize(Files[i], &Files[i]->Lines[j], Column16, Fields,
+                &Column);
+            if (n != Tokens->NumFields
+                || (n > 0 && Column != Tokens->FieldStart[0]))
+              n = -1;
+            for (k = 0; k < n; k++)
+              if (strlen(Fields[k]) != Tokens->FieldLength[k]
+                  || memcmp(Fields[k], &Tokens->Text[Tokens->FieldStart[k]],
+                      Tokens->FieldLength[k]))
+                n = -1;
+            if (n < 0)
+              {
+                printf("The tokenizers disagree at %s:%d.\n",
+                    Files[i]->Filename, j + 1);
+                return (1);
+              }
+          }
+        FreeSourceTokens(&Files[i]->Lines[j], Tokens);
+      }
+
+  Start = Now();
+  for (Done = 0; Done < Lines;)
+    for (i = 0; i < NumFiles && Done < Lines; i++)
+      for (j = 0; j < Files[i]->NumLines && Done < Lines; j++, Done++)
+        {
+          Fields1 += OldTokenize(Files[i], &Files[i]->Lines[j], Column16,
+              Fields, &Column);
+          Bytes += Files[i]->Lines[j].Length;
+        }
+  Old = Now() - Start;
+
+  Start = Now();
+  for (Done = 0; Done < Lines;)
+    for (i = 0; i < NumFiles && Done < Lines; i++)
+      for (j = 0; j < Files[i]->NumLines && Done < Lines; j++, Done++)
+        {
+          Tokens = TokenizeSourceLine(Files[i], &Files[i]->Lines[j],
+              Column16);
+          if (Tokens == NULL)
+            {
+              printf("Out of memory.\n");
+              return (1);
+            }
+          Fields2 += Tokens->NumFields;
+          FreeSourceTokens(&Files[i]->Lines[j], Tokens);
+        }
+  New = Now() - Start;
+
+  printf("%d lines from a corpus of %ld (%ld compared), %ld fields "
+      "(%ld by sscanf), %ld bytes:  sscanf %.1f ns, Tokenize %.1f ns per "
+      "line\n", Done, NumLines, Compared, Fields2, Fields1, Bytes,
+      Old * 1E9 / Done, New * 1E9 / Done);
+  return (0);
+}
@@ -0,0 +1,415 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    check-addresses.c
+ * Purpose:     Checks the table-driven IncPc(), PseudoToStruct() and
+ *              PseudoToEBanked() against the code they replaced.
+ * Mod History: 2026-10-17 AGT  Began.
+ *
+ * IncPc() (in IncPc.c) and PseudoToStruct() and PseudoToEBanked() (in
+ * PseudoToSegmented.c) take most of their results from tables of memory
+ * regions and segments, and are supposed to give exactly the Address_t
+ * that the old step-by-step code did, padding aside.  Reference copies of
+ * the old code are kept here, and both are run, with and without --block1,
+ * on:
+ *
+ *   - every pseudo-address from -100 to 0117777+100,
+ *   - increments from -020000 to 020000 (every --stride=N'th one, default
+ *     1, so all of them) applied to each valid pseudo-address, as
+ *     converted by both PseudoToStruct() and PseudoToEBanked(), and to the
+ *     same addresses when overflowed or invalid,
+ *   - constants from -3000 to 0120000, with a spread of increments,
+ *   - all 16 combinations of the Erasable, Fixed, Banked and Unbanked
+ *     flags, with a spread of S-registers, banks and increments.
+ *
+ * The results are compared as whole structures, so both sides start from
+ * the same garbage.  Any difference is listed (the first 20 of them), and
+ * the exit code is non-zero if there were any.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static long Tests = 0, Failures = 0;
+
+//-------------------------------------------------------------------------
+// The code being replaced.
+
+// IncPc() as it was.
+static void
+OldIncPc(Address_t *OldPc, int Increment, Address_t *NewPc)
+{
+  int i, Max, Min, BankIncrement;
+
+  if (Increment >= 0)
+    {
+      BankIncrement = 7 & (Increment >> 12);
+      Increment &= 07777;
+    }
+  else
+    {
+      Increment = -Increment;
+      BankIncrement = -(7 & (Increment >> 12));
+      Increment = -(07777 & Increment);
+    }
+
+  *NewPc = *OldPc;
+  if (NewPc->Invalid)
+    return;
+
+  if (NewPc->Constant)
+    {
+      if (NewPc->Value < 0)
+        return;
+      else if (NewPc->Value < 01400)
+        {
+          NewPc->Constant = 0;
+          NewPc->Address = 1;
+          NewPc->Erasable = 1;
+          NewPc->Fixed = 0;
+          NewPc->Banked = 0;
+          NewPc->Unbanked = 1;
+          NewPc->EB = 0;
+          NewPc->FB = 0;
+          NewPc->Super = 0;
+          NewPc->SReg = NewPc->Value;
+        }
+      else
+        return;
+    }
+
+  if (NewPc->Overflow)
+    return;
+
+  i = NewPc->SReg + Increment;
+  NewPc->SReg = i;
+  if (NewPc->Erasable && NewPc->Banked)
+    NewPc->EB += BankIncrement;
+  else if (NewPc->Fixed && NewPc->Banked)
+    NewPc->FB += BankIncrement;
+
+  if (NewPc->Fixed && BankIncrement != 0 && NewPc->FB == 0)
+    {
+      NewPc->Constant = 0;
+      NewPc->Address = 1;
+      NewPc->Erasable = 1;
+      NewPc->Fixed = 0;
+      NewPc->Banked = 0;
+      NewPc->Unbanked = 1;
+      NewPc->EB = 0;
+      NewPc->FB = 0;
+      NewPc->Super = 0;
+    }
+
+  if (NewPc->Erasable)
+    {
+      if (NewPc->Unbanked)
+        {
+          Min = 0;
+          Max = Block1 ? 01777 : 01377;
+        }
+      else if (!Block1 && NewPc->Banked)
+        {
+          Min = 01400;
+          Max = 01777;
+          NewPc->EB += BankIncrement;
+        }
+      else
+        goto ImplementationError;
+    }
+  else if (NewPc->Fixed)
+    {
+      if (NewPc->Banked)
+        {
+          Min = Block1 ? 06000 : 02000;
+          Max = Block1 ? 07777 : 03777;
+          NewPc->FB += BankIncrement;
+        }
+      else if (NewPc->Unbanked)
+        {
+          Min = Block1 ? 02000 : 04000;
+          Max = 07777;
+        }
+      else
+        goto ImplementationError;
+    }
+  else
+    goto ImplementationError;
+
+  if (i < Min)
+    {
+      NewPc->Overflow = 1;
+      NewPc->SReg = Min;
+    }
+  else if (i > Max)
+    {
+      NewPc->Overflow = 1;
+      NewPc->SReg = Max;
+    }
+
+  if (NewPc->Unbanked)
+    NewPc->Value = NewPc->SReg;
+  else if (NewPc->Erasable)
+    NewPc->Value = (NewPc->SReg - 01400) + 0400 * NewPc->EB;
+  else if (NewPc->Fixed)
+    {
+      NewPc->Value = 010000 + (NewPc->SReg - 02000) + 02000 * NewPc->FB;
+      if (NewPc->Super && NewPc->FB >= 030)
+        NewPc->Value += 010 * 02000;
+    }
+  else
+    goto ImplementationError;
+  return;
+
+  ImplementationError:
+  NewPc->Invalid = 1;
+}
+
+// PseudoToEBanked() as it was.
+static void
+OldPseudoToEBanked(int Value, ParseOutput_t *OutRecord)
+{
+  OutRecord->ProgramCounter = (const Address_t) { 0 };
+
+  if (Value < 0 || Value > 0117777)
+    {
+      strcpy(OutRecord->ErrorMessage, "Addresses must be between 0 and 0117777.");
+      OutRecord->Fatal = 1;
+      OutRecord->ProgramCounter.Invalid = 1;
+      return;
+    }
+
+  if (Value <= 03777)
+    {
+      OutRecord->ProgramCounter.Address = 1;
+      OutRecord->ProgramCounter.Erasable = 1;
+      OutRecord->ProgramCounter.Banked = 1;
+      OutRecord->ProgramCounter.SReg = 01400 + (Value & 0377);
+      OutRecord->ProgramCounter.EB = Value / 0400;
+    }
+  else if (Value <= 07777)
+    {
+      OutRecord->ProgramCounter.Address = 1;
+      OutRecord->ProgramCounter.Fixed = 1;
+      OutRecord->ProgramCounter.Unbanked = 1;
+      OutRecord->ProgramCounter.SReg = Value;
+    }
+  else
+    {
+      OutRecord->ProgramCounter.Address = 1;
+      OutRecord->ProgramCounter.Fixed = 1;
+      OutRecord->ProgramCounter.Banked = 1;
+      OutRecord->ProgramCounter.SReg = 02000 + (Value & 01777);
+      if (Value < 0110000)
+        OutRecord->ProgramCounter.FB = (Value - 010000) / 02000;
+      else
+        {
+          OutRecord->ProgramCounter.Super = 1;
+          OutRecord->ProgramCounter.FB = (Value - 030000) / 02000;
+        }
+    }
+
+  OutRecord->ProgramCounter.Value = Value;
+}
+
+// PseudoToStruct() as it was.
+static int
+OldPseudoToStruct(int Value, Address_t *Address)
+{
+  *Address = VALID_ADDRESS;
+
+  if (Value < 0 || Value > 0117777)
+    {
+      Address->Invalid = 1;
+      return (1);
+    }
+
+  if ((Block1 && Value <= 01777) || Value <= 01377)
+    {
+      Address->Address = 1;
+      Address->Erasable = 1;
+      Address->Unbanked = 1;
+      Address->SReg = Value;
+    }
+  else if (!Block1 && Value <= 03777)
+    {
+      Address->Address = 1;
+      Address->Erasable = 1;
+      Address->Banked = 1;
+      Address->SReg = 01400 + (Value & 0377);
+      Address->EB = Value / 0400;
+    }
+  else if ((!Block1 && Value <= 07777) || (Block1 && Value <= 05777))
+    {
+      Address->Address = 1;
+      Address->Fixed = 1;
+      Address->Unbanked = 1;
+      Address->SReg = Value;
+    }
+  else
+    {
+      Address->Address = 1;
+      Address->Fixed = 1;
+      Address->Banked = 1;
+      Address->SReg = Block1 ? (06000 + (Value & 01777)) : (02000 + (Value & 01777));
+      if (Block1)
+        Address->FB = 3 + (Value - 06000) / 02000;
+      else if (Value < 0110000)
+        Address->FB = (Value - 010000) / 02000;
+      else
+        {
+          Address->Super = 1;
+          Address->FB = (Value - 030000) / 02000;
+        }
+    }
+
+  Address->Value = Value;
+  return (0);
+}
+
+//-------------------------------------------------------------------------
+
+static void
+Fail(const char *What, int Value, int Increment, const Address_t *Old,
+    const Address_t *New)
+{
+  if (Failures++ < 20)
+    printf("%s, --block1=%d, value %o, increment %o:  "
+        "was value %o, S-reg %o, EB %o, FB %o; "
+        "now value %o, S-reg %o, EB %o, FB %o\n", What, Block1, Value,
+        Increment, Old->Value, Old->SReg, Old->EB, Old->FB, New->Value,
+        New->SReg, New->EB, New->FB);
+}
+
+static void
+CheckIncPc(Address_t *Pc, int Increment)
+{
+  Address_t Old, New;
+
+  Tests++;
+  memset(&Old, 0x55, sizeof(Address_t));
+  memset(&New, 0x55, sizeof(Address_t));
+  OldIncPc(Pc, Increment, &Old);
+  IncPc(Pc, Increment, &New);
+  if (memcmp(&Old, &New, sizeof(Address_t)))
+    Fail("IncPc", Pc->Value, Increment, &Old, &New);
+}
+
+//-------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+  static const int Increments[] = { 0, 1, -1, 7, -7, 0377, -0377, 01777,
+      -01777, 04000, -04000, 07777, -07777, 010000, -010000, 012345,
+      -012345, 0177777, -0177777 };
+  int Stride = 1, Value, Increment, Flags, SReg, EB, FB, Super, i;
+
+  for (i = 1; i < argc; i++)
+    {
+      if (1 == sscanf(argv[i], "--stride=%d", &Stride) && Stride > 0)
+        ;
+      else
+        {
+          fprintf(stderr, "Usage:\n\tcheck-addresses [--stride=N]\n");
+          return (1);
+        }
+    }
+
+  for (Block1 = 0; Block1 < 2; Block1++)
+    {
+      for (Value = -100; Value <= 0117777 + 100; Value++)
+        {
+          Address_t Old, New, Pc;
+          ParseOutput_t OldRecord, NewRecord;
+          int OldResult, NewResult;
+
+          Tests++;
+          memset(&Old, 0x33, sizeof(Address_t));
+          memset(&New, 0x33, sizeof(Address_t));
+          OldResult = OldPseudoToStruct(Value, &Old);
+          NewResult = PseudoToStruct(Value, &New);
+          if (OldResult != NewResult || memcmp(&Old, &New, sizeof(Address_t)))
+            Fail("PseudoToStruct", Value, 0, &Old, &New);
+
+          Tests++;
+          memset(&OldRecord, 0, sizeof(ParseOutput_t));
+          memset(&NewRecord, 0, sizeof(ParseOutput_t));
+          OldPseudoToEBanked(Value, &OldRecord);
+          PseudoToEBanked(Value, &NewRecord);
+          if (memcmp(&OldRecord, &NewRecord, sizeof(ParseOutput_t)))
+            Fail("PseudoToEBanked", Value, 0, &OldRecord.ProgramCounter,
+                &NewRecord.ProgramCounter);
+
+          if (Value < 0 || Value > 0117777)
+            continue;
+          for (Increment = -020000; Increment <= 020000; Increment += Stride)
+            {
+              CheckIncPc(&Old, Increment);
+              CheckIncPc(&OldRecord.ProgramCounter, Increment);
+            }
+          Pc = Old;
+          Pc.Overflow = 1;
+          CheckIncPc(&Pc, 5);
+          Pc = Old;
+          Pc.Invalid = 1;
+          CheckIncPc(&Pc, 5);
+        }
+
+      // Constants.
+      for (Value = -3000; Value <= 0120000; Value++)
+        {
+          Address_t Pc = { 0 };
+          Pc.Constant = 1;
+          Pc.Value = Value;
+          for (Increment = -02000; Increment <= 02000; Increment += 17)
+            CheckIncPc(&Pc, Increment);
+          CheckIncPc(&Pc, 0);
+          CheckIncPc(&Pc, -1);
+          CheckIncPc(&Pc, 1);
+        }
+
+      // Every combination of the memory-type flags, whether it makes sense
+      // or not.
+      for (Flags = 0; Flags < 16; Flags++)
+        for (SReg = 0; SReg < 010000; SReg += 3)
+          for (EB = 0; EB < 8; EB++)
+            for (FB = 0; FB < 040; FB += 3)
+              for (Super = 0; Super < 2; Super++)
+                {
+                  Address_t Pc = { 0 };
+                  Pc.Erasable = Flags & 1;
+                  Pc.Fixed = !!(Flags & 2);
+                  Pc.Banked = !!(Flags & 4);
+                  Pc.Unbanked = !!(Flags & 8);
+                  Pc.Address = 1;
+                  Pc.SReg = SReg;
+                  Pc.EB = EB;
+                  Pc.FB = FB;
+                  Pc.Super = Super;
+                  Pc.Value = 3 * SReg;
+                  for (i = 0; i < sizeof(Increments) / sizeof(Increments[0]); i++)
+                    CheckIncPc(&Pc, Increments[i]);
+                }
+    }
+
+  printf("%ld tests, %ld failures\n", Tests, Failures);
+  return (Failures != 0);
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    check-checksums.c
+ * Purpose:     Checks the bank checksums of ChecksumBanks() against
+ *              repeated calls of Add(), which is how they used to be found.
+ * Mod History: 2026-10-17 AGT  Began.
+ *
+ * ChecksumBanks() (in Checksum.c) sums all of the banks at once, without
+ * branches, and is supposed to give exactly what summing each bank a word
+ * at a time with Add() (in yaYUL.c) gave, including which of +0 and -0 a
+ * sum comes to, since that decides the bugger word.  Both are run on
+ * --random=N (default 2000) sets of 044 banks, from --seed=N, each bank
+ * of a random length from 0 to 02000 and with OBJECT_WRITTEN set at
+ * random.  The words are drawn, a quarter of the sets each, from:
+ *
+ *   - all 15-bit words,
+ *   - words near +0 and -0,
+ *   - words near the largest positive and negative values, so that the
+ *     sums wrap as often as possible,
+ *   - mostly +0 and -0, with the rest anything.
+ *
+ * Any difference is listed (the first 20 of them), and the exit code is
+ * non-zero if there were any.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static long Tests = 0, Failures = 0;
+static unsigned long long Seed = 1;
+
+//-------------------------------------------------------------------------
+// A deterministic random-number generator, so that a failure can be
+// reproduced with the same --seed.
+static unsigned
+RandomBelow(unsigned Limit)
+{
+  Seed = Seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return ((unsigned) (Seed >> 33) % Limit);
+}
+
+// A word for set number Set.
+static int
+RandomWord(long Set)
+{
+  switch (Set % 4)
+    {
+    case 0:
+      return (RandomBelow(0100000));
+    case 1:
+      return (RandomBelow(2) ? RandomBelow(64) : 077777 - RandomBelow(64));
+    case 2:
+      return (RandomBelow(2) ? 037777 - RandomBelow(8) : 040000
+          + RandomBelow(8));
+    default:
+      if (RandomBelow(3) == 0)
+        return (077777);
+      if (RandomBelow(2) == 0)
+        return (0);
+      return (RandomBelow(0100000));
+    }
+}
+
+//-------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+  int Lengths[044], Bank, Offset, Sum;
+  uint16_t Sums[044];
+  long Random = 2000, Set;
+
+  for (Bank = 1; Bank < argc; Bank++)
+    {
+      if (1 == sscanf(argv[Bank], "--random=%ld", &Random))
+        ;
+      else if (1 == sscanf(argv[Bank], "--seed=%llu", &Seed))
+        ;
+      else
+        {
+          fprintf(stderr,
+              "Usage:\n\tcheck-checksums [--random=N] [--seed=N]\n");
+          return (1);
+        }
+    }
+  if (ClearObjectCode())
+    return (1);
+
+  for (Set = 0; Set < Random; Set++)
+    {
+      for (Bank = 0; Bank < 044; Bank++)
+        {
+          Lengths[Bank] = RandomBelow(5) ? RandomBelow(02001) : 0;
+          for (Offset = 0; Offset < 02000; Offset++)
+            ObjectCode[Bank][Offset] = RandomWord(Set)
+                | (RandomBelow(2) ? OBJECT_WRITTEN : 0);
+        }
+      ChecksumBanks(Lengths, Sums);
+      for (Bank = 0; Bank < 044; Bank++)
+        {
+          Tests++;
+          for (Sum = Offset = 0; Offset < Lengths[Bank]; Offset++)
+            Sum = Add(Sum, ObjectCode[Bank][Offset] & 077777);
+          if (Sum != Sums[Bank] && Failures++ < 20)
+            printf("Set %ld, bank %02o (%d words):  was %05o, now %05o\n",
+                Set, Bank, Lengths[Bank], Sum, Sums[Bank]);
+        }
+    }
+
+  printf("%ld tests, %ld failures\n", Tests, Failures);
+  return (Failures != 0);
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    check-numbers.c
+ * Purpose:     Checks the numeric-operand readers, GetNumber(),
+ *              ScaleFactor() and GetDecimal(), against the library
+ *              functions they replaced.
+ * Mod History: 2026-10-17 AGT  Began.
+ *
+ * GetNumber() (in GetOctOrDec.c) and GetDecimal() and ScaleFactor() (in
+ * Parse2DEC.c) are supposed to give exactly what sscanf(), strtod(), atoi()
+ * and pow() gave before, bit for bit, so that no binary changes.  Reference
+ * copies of the old code are kept here, and both are run on:
+ *
+ *   - every string of up to 5 characters drawn from the characters that
+ *     can matter, "0123456789+-D.Ex ",
+ *   - every E and B scale factor from -400 to 400, with and without an
+ *     explicit sign, and a few malformed ones,
+ *   - --random=N (default 1000000) random octal, decimal and
+ *     floating-point operands of up to 25 digits, from --seed=N.
+ *
+ * Any difference is listed (the first 20 of them), and the exit code is
+ * non-zero if there were any.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static long Tests = 0, Failures = 0;
+static unsigned long long Seed = 1;
+
+//-------------------------------------------------------------------------
+// The code being replaced.
+
+// GetOctOrDec() as it was, with two scans and sscanf().
+static int
+OldGetOctOrDec(const char *s, int *Value)
+{
+  const char *ss;
+  int has_8_or_9 = 0;
+
+  ss = s;
+  if (*ss == '+' || *ss == '-')
+    ss++;
+  for (; *ss; ss++)
+    if (*ss < '0' || *ss > '7')
+      break;
+  if (!*ss && ss != s)
+    {
+      sscanf(s, "%o", Value);
+      return (0);
+    }
+
+  ss = s;
+  if (*ss == '+' || *ss == '-')
+    ss++;
+  for (; *ss; ss++)
+    if (*ss == '8' || *ss == '9')
+      has_8_or_9 = 1;
+    else if (*ss < '0' || *ss > '9')
+      break;
+  if ((*ss == 'D' && ss[1] == 0 && ss != s) || (has_8_or_9 && ss[0] == 0))
+    {
+      sscanf(s, "%d", Value);
+      return (0);
+    }
+  return (1);
+}
+
+// ScaleFactor() as it was, with atoi() and pow().
+static double
+OldScaleFactor(const char *s)
+{
+  if (*s == 'E')
+    return (pow(10.0, atoi(s + 1)));
+  if (*s == 'B')
+    return (pow(2.0, atoi(s + 1)));
+  return (1.0);
+}
+
+//-------------------------------------------------------------------------
+// A deterministic random-number generator, so that a failure can be
+// reproduced with the same --seed.
+static unsigned
+RandomBelow(unsigned Limit)
+{
+  Seed = Seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return ((unsigned) (Seed >> 33) % Limit);
+}
+
+static void
+Fail(const char *What, const char *s, const char *Old, const char *New)
+{
+  if (Failures++ < 20)
+    printf("%s(\"%s\"):  was %s, now %s\n", What, s, Old, New);
+}
+
+// The doubles are compared bit for bit, so that -0 and the NaNs count.
+static void
+CheckDecimal(const char *s)
+{
+  double Old, New;
+  char OldText[64], NewText[64];
+
+  Tests++;
+  Old = strtod(s, NULL);
+  New = GetDecimal(s);
+  if (memcmp(&Old, &New, sizeof(double)))
+    {
+      sprintf(OldText, "%.17g", Old);
+      sprintf(NewText, "%.17g", New);
+      Fail("GetDecimal", s, OldText, NewText);
+    }
+}
+
+static void
+CheckScale(const char *s)
+{
+  double Old, New;
+  char OldText[64], NewText[64];
+
+  Tests++;
+  Old = OldScaleFactor(s);
+  New = ScaleFactor((char *) s);
+  if (memcmp(&Old, &New, sizeof(double)))
+    {
+      sprintf(OldText, "%.17g", Old);
+      sprintf(NewText, "%.17g", New);
+      Fail("ScaleFactor", s, OldText, NewText);
+    }
+}
+
+// A lone sign leaves the value alone, so both start out the same.
+static void
+CheckNumber(const char *s)
+{
+  int Old = 0x5A5A5A5A, New = 0x5A5A5A5A, OldResult, NewResult, Radix;
+  char OldText[64], NewText[64];
+
+  Tests++;
+  OldResult = OldGetOctOrDec(s, &Old);
+  NewResult = GetNumber(s, &New, &Radix);
+  if (OldResult != NewResult || Old != New)
+    {
+      sprintf(OldText, "%d (%d)", Old, OldResult);
+      sprintf(NewText, "%d (%d)", New, NewResult);
+      Fail("GetNumber", s, OldText, NewText);
+    }
+}
+
+//-------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+  static const char Alphabet[] = "0123456789+-D.Ex ";
+  static const char *Malformed[] = { "", "E", "B", "X3", "E+-3", "E--3", "E 3",
+      "E- 3", "B99999999999", "E-", "B+", "E3 ", NULL };
+  char s[64];
+  long Random = 1000000, Count, c, t;
+  int Length, Letters = sizeof(Alphabet) - 1, Radix, i, j, k, n, Point;
+
+  for (i = 1; i < argc; i++)
+    {
+      if (1 == sscanf(argv[i], "--random=%ld", &Random))
+        ;
+      else if (1 == sscanf(argv[i], "--seed=%llu", &Seed))
+        ;
+      else
+        {
+          fprintf(stderr, "Usage:\n\tcheck-numbers [--random=N] [--seed=N]\n");
+          return (1);
+        }
+    }
+
+  // Everything short.
+  for (Length = 0, Count = 1; Length <= 5; Length++, Count *= Letters)
+    for (c = 0; c < Count; c++)
+      {
+        for (i = 0, t = c; i < Length; i++, t /= Letters)
+          s[i] = Alphabet[t % Letters];
+        s[Length] = 0;
+        CheckNumber(s);
+        CheckDecimal(s);
+      }
+
+  // The scale factors.
+  for (i = -400; i <= 400; i++)
+    {
+      sprintf(s, "E%d", i);
+      CheckScale(s);
+      sprintf(s, "B%d", i);
+      CheckScale(s);
+      sprintf(s, "E%+d", i);
+      CheckScale(s);
+      sprintf(s, "B%+d", i);
+      CheckScale(s);
+    }
+  for (i = 0; Malformed[i] != NULL; i++)
+    CheckScale(Malformed[i]);
+
+  // Random operands, long enough to overflow.
+  for (c = 0; c < Random; c++)
+    {
+      n = 1 + RandomBelow(22);
+      Point = RandomBelow(n + 2);
+      k = 0;
+      if (RandomBelow(3) == 0)
+        s[k++] = "+-"[RandomBelow(2)];
+      for (j = 0; j < n; j++)
+        {
+          if (j == Point && RandomBelow(2))
+            s[k++] = '.';
+          s[k++] = '0' + RandomBelow(10);
+        }
+      if (RandomBelow(4) == 0)
+        {
+          s[k++] = 'E';
+          if (RandomBelow(2))
+            s[k++] = "+-"[RandomBelow(2)];
+          k += sprintf(&s[k], "%u", RandomBelow(40));
+        }
+      s[k] = 0;
+      CheckDecimal(s);
+
+      n = 1 + RandomBelow(25);
+      Radix = RandomBelow(2) ? 8 : 10;
+      k = 0;
+      if (RandomBelow(3) == 0)
+        s[k++] = "+-"[RandomBelow(2)];
+      for (j = 0; j < n; j++)
+        s[k++] = '0' + RandomBelow(Radix);
+      if (RandomBelow(3) == 0)
+        s[k++] = 'D';
+      s[k] = 0;
+      CheckNumber(s);
+    }
+
+  printf("%ld tests, %ld failures\n", Tests, Failures);
+  return (Failures != 0);
+}
@@ -0,0 +1,294 @@
+/*
+ * Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+ *
+ * This file is part of yaAGC.
+ *
+ * yaAGC is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * yaAGC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yaAGC; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Filename:    check-symtab.c
+ * Purpose:     Checks that version 2 of the symbol-table file (WriteSymtab())
+ *              holds everything that the original format
+ *              (WriteSymbolsToFile()) does.
+ * Mod History: 2026-10-17 AGT  Began.
+ *
+ * The source file given on the command line is assembled twice through
+ * yaYULAssembleJob(), in the current directory, along with any other
+ * switches given, and with the listing and the error messages thrown away:
+ * first with --symtab-v1, whose InputFile.symtab is then renamed to
+ * InputFile.symtab-v1, and then without.  Warnings are fine, but the
+ * assemblies must succeed.  The two files must then have
+ * the same source path, and the same symbols and lines in the same order,
+ * with every field of every address the same (Syllable, which version 2
+ * leaves out, must be 0).  Version 2 is read a byte at a time, as any
+ * program reading it would, rather than through SymtabHeader_t and so on.
+ * Its symbols must be in strcmp() order, its address index must agree
+ * with its lines, and the reserved fields must be 0.
+ *
+ * Any difference is listed (the first 20 of them), and the exit code is
+ * non-zero if there were any.
+ */
+
+#include "yaYUL.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static long Failures = 0;
+
+static void
+Fail(const char *What, long Index, const char *Name)
+{
+  if (Failures++ < 20)
+    printf("%s %ld (%s) differs.\n", What, Index, Name);
+}
+
+//-------------------------------------------------------------------------
+// Reading version 2.
+
+static const unsigned char *Image;
+static long ImageSize;
+
+static uint32_t
+Get32(long Offset)
+{
+  if (Offset < 0 || Offset + 4 > ImageSize)
+    return (0xFFFFFFFF);
+  return (Image[Offset] | (Image[Offset + 1] << 8) | (Image[Offset + 2] << 16)
+      | ((uint32_t) Image[Offset + 3] << 24));
+}
+
+// A string, given its offset in the string table.
+static const char *
+GetString(uint32_t StringsOffset, uint32_t StringsSize, uint32_t Offset)
+{
+  const char *s;
+
+  if (Offset >= StringsSize)
+    return (NULL);
+  s = (const char *) &Image[StringsOffset + Offset];
+  if (memchr(s, 0, StringsSize - Offset) == NULL)
+    return (NULL);
+  return (s);
+}
+
+// Compare the SymtabAddress_t at Offset with an Address_t.  Returns 0 if
+// they're the same.
+static int
+CompareAddress(long Offset, const Address_t *Address)
+{
+  unsigned Flags;
+
+  if (Offset + 12 > ImageSize)
+    return (1);
+  Flags = Image[Offset + 6] | (Image[Offset + 7] << 8);
+  return ((int32_t) Get32(Offset) != Address->Value
+      || (Image[Offset + 4] | (Image[Offset + 5] << 8)) != Address->SReg
+      || !(Flags & SYMTAB_INVALID) != !Address->Invalid
+      || !(Flags & SYMTAB_CONSTANT) != !Address->Constant
+      || !(Flags & SYMTAB_ADDRESS) != !Address->Address
+      || !(Flags & SYMTAB_ERASABLE) != !Address->Erasable
+      || !(Flags & SYMTAB_FIXED) != !Address->Fixed
+      || !(Flags & SYMTAB_UNBANKED) != !Address->Unbanked
+      || !(Flags & SYMTAB_BANKED) != !Address->Banked
+      || !(Flags & SYMTAB_SUPER) != !Address->Super
+      || !(Flags & SYMTAB_OVERFLOW) != !Address->Overflow
+      || (Flags & ~0x01FF) != 0
+      || Image[Offset + 8] != ((Address->FB << 3) | Address->EB)
+      || Image[Offset + 9] || Image[Offset + 10] || Image[Offset + 11]
+      || Address->Syllable != 0);
+}
+
+// The bank of an address, as the address index has it.
+static int
+IndexBank(const Address_t *Address)
+{
+  if (Address->Banked && Address->Super && Address->FB >= 020)
+    return (Address->FB + 010);
+  if (Address->Banked)
+    return (Address->FB);
+  return (Address->SReg / 02000);
+}
+
+//-------------------------------------------------------------------------
+// Assemble, with "--symtab-v1" or not.  Returns 0 on success.
+static int
+RunAssembly(int argc, char *argv[], int Legacy)
+{
+  yaYULJob_t Job;
+  char **Args;
+  int i, n = 0, RetVal;
+
+  memset(&Job, 0, sizeof(Job));
+  Args = (char **) calloc(argc + 2, sizeof(char *));
+  Job.Listing = Job.Errors = tmpfile();
+  if (Args == NULL || Job.Listing == NULL)
+    {
+      printf("Out of memory.\n");
+      return (1);
+    }
+  Args[n++] = "yaYUL";
+  if (Legacy)
+    Args[n++] = "--symtab-v1";
+  for (i = 1; i < argc; i++)
+    Args[n++] = argv[i];
+  RetVal = yaYULAssembleJob(n, Args, &Job);
+  if (RetVal)
+    printf("The assembly%s failed.\n", Legacy ? " with --symtab-v1" : "");
+  fclose(Job.Listing);
+  free(Args);
+  return (RetVal);
+}
+
+//-------------------------------------------------------------------------
+int
+main(int argc, char *argv[])
+{
+  const char *InputFilename = NULL, *Previous = NULL, *s;
+  char v1Name[MAX_PATH_LENGTH], v2Name[MAX_PATH_LENGTH];
+  SymbolFile_t Header;
+  Symbol_t Symbol;
+  SymbolLine_t Line;
+  uint32_t NumSymbols, SymbolsOffset, NumLines, LinesOffset, IndexOffset;
+  uint32_t StringsOffset, StringsSize, Index[SYMTAB_BANKS + 1];
+  long i, Offset, v1Size;
+  int Bank;
+  FILE *fp;
+
+  for (i = 1; i < argc; i++)
+    if (argv[i][0] != '-')
+      InputFilename = argv[i];
+  if (InputFilename == NULL || strlen(InputFilename) + 12 > MAX_PATH_LENGTH)
+    {
+      fprintf(stderr, "Usage:\n\tcheck-symtab [SWITCHES] SOURCEFILE\n");
+      return (1);
+    }
+  sprintf(v1Name, "%s.symtab-v1", InputFilename);
+  sprintf(v2Name, "%s.symtab", InputFilename);
+  if (RunAssembly(argc, argv, 1))
+    return (1);
+  if (rename(v2Name, v1Name))
+    {
+      printf("Cannot rename %s.\n", v2Name);
+      return (1);
+    }
+  if (RunAssembly(argc, argv, 0))
+    return (1);
+
+  // Read all of version 2.
+  fp = fopen(v2Name, "rb");
+  if (fp == NULL)
+    {
+      printf("Cannot open %s.\n", v2Name);
+      return (1);
+    }
+  fseek(fp, 0, SEEK_END);
+  ImageSize = ftell(fp);
+  rewind(fp);
+  Image = (unsigned char *) malloc(ImageSize + 1);
+  if (Image == NULL || ImageSize != fread((void *) Image, 1, ImageSize, fp))
+    {
+      printf("Cannot read %s.\n", v2Name);
+      return (1);
+    }
+  fclose(fp);
+
+  // The headers.
+  fp = fopen(v1Name, "rb");
+  if (fp == NULL || 1 != fread(&Header, sizeof(Header), 1, fp))
+    {
+      printf("Cannot read %s.\n", v1Name);
+      return (1);
+    }
+  NumSymbols = Get32(24);
+  SymbolsOffset = Get32(28);
+  NumLines = Get32(32);
+  LinesOffset = Get32(36);
+  IndexOffset = Get32(40);
+  StringsOffset = Get32(44);
+  StringsSize = Get32(48);
+  if (ImageSize < (long) sizeof(SymtabHeader_t)
+      || memcmp(Image, SYMTAB_MAGIC, 8) || Get32(8) != SYMTAB_VERSION
+      || Get32(12) != sizeof(SymtabHeader_t) || Get32(16) != ImageSize
+      || Get32(52) != 0
+      || StringsOffset + (long) StringsSize != ImageSize
+      || SymbolsOffset + 28L * NumSymbols > LinesOffset
+      || LinesOffset + 20L * NumLines > IndexOffset
+      || IndexOffset + 4L * (SYMTAB_BANKS + 1) > StringsOffset)
+    {
+      printf("The header of %s is wrong.\n", v2Name);
+      return (1);
+    }
+  s = GetString(StringsOffset, StringsSize, Get32(20));
+  if (s == NULL || strcmp(s, Header.SourcePath))
+    Fail("The source path", 0, Header.SourcePath);
+  if (NumSymbols != Header.NumberSymbols || NumLines != Header.NumberLines)
+    {
+      printf("There are %d symbols and %d lines, but %u and %u in "
+          "version 2.\n", Header.NumberSymbols, Header.NumberLines,
+          NumSymbols, NumLines);
+      return (1);
+    }
+
+  // The symbols.
+  for (i = 0; i < NumSymbols; i++)
+    {
+      if (1 != fread(&Symbol, sizeof(Symbol), 1, fp))
+        {
+          printf("Cannot read %s.\n", v1Name);
+          return (1);
+        }
+      Offset = SymbolsOffset + 28 * i;
+      s = GetString(StringsOffset, StringsSize, Get32(Offset));
+      if (s == NULL || strcmp(s, Symbol.Name)
+          || (Previous != NULL && strcmp(Previous, s) >= 0)
+          || Get32(Offset + 4) != Symbol.Type
+          || (s = GetString(StringsOffset, StringsSize, Get32(Offset + 8)))
+              == NULL || strcmp(s, Symbol.FileName)
+          || Get32(Offset + 12) != Symbol.LineNumber
+          || CompareAddress(Offset + 16, &Symbol.Value))
+        Fail("Symbol", i, Symbol.Name);
+      Previous = GetString(StringsOffset, StringsSize, Get32(Offset));
+    }
+
+  // The lines, and the address index.
+  for (Bank = 0; Bank <= SYMTAB_BANKS; Bank++)
+    Index[Bank] = Get32(IndexOffset + 4 * Bank);
+  if (Index[0] != 0 || Index[SYMTAB_BANKS] != NumLines)
+    Fail("The address index", 0, "ends");
+  for (i = 0; i < NumLines; i++)
+    {
+      if (1 != fread(&Line, sizeof(Line), 1, fp))
+        {
+          printf("Cannot read %s.\n", v1Name);
+          return (1);
+        }
+      Offset = LinesOffset + 20 * i;
+      Bank = IndexBank(&Line.CodeAddress);
+      if (CompareAddress(Offset, &Line.CodeAddress)
+          || (s = GetString(StringsOffset, StringsSize, Get32(Offset + 12)))
+              == NULL || strcmp(s, Line.FileName)
+          || Get32(Offset + 16) != Line.LineNumber
+          || Bank >= SYMTAB_BANKS || i < Index[Bank] || i >= Index[Bank + 1])
+        Fail("Line", i, Line.FileName);
+    }
+  v1Size = ftell(fp);
+  if (fgetc(fp) != EOF)
+    Fail("The end", v1Size, v1Name);
+  fclose(fp);
+
+  printf("%u symbols, %u lines:  version 1 %ld bytes, version 2 %ld bytes, "
+      "%ld differences\n", NumSymbols, NumLines, v1Size, ImageSize, Failures);
+  return (Failures != 0);
+}
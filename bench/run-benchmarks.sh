@@ -0,0 +1,198 @@
+#!/bin/sh
+# Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+#
+# This file is part of yaAGC.
+#
+# yaAGC is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# Filename:    run-benchmarks.sh
+# Purpose:     Runs yaYUL over the synthetic programs of bench/cases.txt,
+#              and compares the results with those of a baseline build and
+#              with bench/baselines.txt.
+# Mod History: 2026-10-17 AGT  Began.
+#              2026-10-17 AGT  Speeds are compared with a baseline build
+#                              run alongside, as ratios, rather than with
+#                              numbers recorded on some other machine.
+#
+# Usage:
+#       run-benchmarks.sh [--update] [--baseline=OLDYAYUL] YAYUL AGCGEN BENCHDIR
+#
+# For each case, agcgen generates the source files and yaYUL --stats
+# assembles them RUNS times (default 3).  The best wall time gives the
+# lines per second, and the number of passes and the peak RSS come from
+# the same report.
+#
+# Speed and memory depend on the machine, so they're never judged by
+# absolute numbers.  Instead, with --baseline, the same cases are also
+# assembled by OLDYAYUL (normally a build of the commit before, which must
+# know --stats), with its runs alternating with those of YAYUL so that
+# both see the same machine.  A case fails if its speed is less than
+# (100 - TOLERANCE) percent of the baseline's, or its peak RSS more than
+# (100 + TOLERANCE) percent, where TOLERANCE defaults to 25.  Without
+# --baseline, the speeds and sizes are only listed.
+#
+# The number of passes, on the other hand, is the same on any machine, so
+# bench/baselines.txt records it for each case, and a case also fails if
+# it needs more passes than that.  With --update, bench/baselines.txt is
+# replaced by the new results instead.  The exit code is the number of
+# failures.
+#
+# Everything happens in the directory bench-work under the current
+# directory.
+
+Update=no
+Baseline=
+while :
+do
+        case "$1" in
+        --update)
+                Update=yes
+                shift
+                ;;
+        --baseline=*)
+                Baseline=`echo "$1" | sed 's/^--baseline=//'`
+                shift
+                ;;
+        *)
+                break
+                ;;
+        esac
+done
+if [ $# -ne 3 ]
+then
+        echo "Usage: $0 [--update] [--baseline=OLDYAYUL] YAYUL AGCGEN BENCHDIR" >&2
+        exit 1
+fi
+Yayul=$1
+Agcgen=$2
+Cases=$3/cases.txt
+Baselines=$3/baselines.txt
+Runs=${RUNS:-3}
+Tolerance=${TOLERANCE:-25}
+
+Work=`pwd`/bench-work
+rm -rf "$Work"
+mkdir -p "$Work" || exit 1
+Results=$Work/results.txt
+: > "$Results"
+
+# Assemble a case with yaYUL $1, giving $2.lst and $2.json.
+Assemble() {
+        ( cd "$Work/$Name" && "$1" --stats="$2.json" main.agc > "$2.lst" 2>&1 )
+        if ! grep -q "^Fatal errors:  0" "$Work/$Name/$2.lst"
+        then
+                echo "$Name: assembly failed; see $Work/$Name/$2.lst" >&2
+                exit 1
+        fi
+        if ! grep -q '"total"' "$Work/$Name/$2.json"
+        then
+                echo "$Name: no statistics from $1" >&2
+                exit 1
+        fi
+}
+
+# The best of $1 and $2, either of which may be empty.
+Best() {
+        echo "$1 $2" | awk '{ print ($2 == "" || ($1 != "" && $1 < $2)) ? $1 : $2 }'
+}
+
+Wall() {
+        sed -n 's/.*"total": { "wall": \([0-9.]*\).*/\1/p' "$Work/$Name/$1.json"
+}
+
+Rss() {
+        sed -n 's/.*"peak_rss_kb": \([0-9]*\).*/\1/p' "$Work/$Name/$1.json"
+}
+
+if [ -n "$Baseline" ]
+then
+        printf "%-12s %8s %7s %12s %10s %12s %10s\n" case lines passes lines/sec peak-kB \
+                base-l/sec base-kB
+else
+        printf "%-12s %8s %7s %12s %10s\n" case lines passes lines/sec peak-kB
+fi
+grep -v '^#' "$Cases" | while read Name Options
+do
+        [ -z "$Name" ] && continue
+        mkdir -p "$Work/$Name"
+        "$Agcgen" --dir="$Work/$Name" $Options || exit 1
+        Lines=`cat "$Work/$Name"/*.agc | wc -l`
+        BestNew=
+        BestOld=
+        Run=0
+        while [ $Run -lt $Runs ]
+        do
+                Assemble "$Yayul" new
+                Wall=`Wall new`
+                BestNew=`Best "$BestNew" "$Wall"`
+                if [ -n "$Baseline" ]
+                then
+                        Assemble "$Baseline" old
+                        Wall=`Wall old`
+                        BestOld=`Best "$BestOld" "$Wall"`
+                fi
+                Run=`expr $Run + 1`
+        done
+        Passes=`grep -c '"pass":' "$Work/$Name/new.json"`
+        Speed=`echo "$Lines $BestNew" | awk '{ printf "%d", ($2 > 0) ? $1 / $2 : 0 }'`
+        Rss=`Rss new`
+        if [ -n "$Baseline" ]
+        then
+                OldSpeed=`echo "$Lines $BestOld" | awk '{ printf "%d", ($2 > 0) ? $1 / $2 : 0 }'`
+                OldRss=`Rss old`
+                printf "%-12s %8d %7d %12d %10d %12d %10d\n" $Name $Lines $Passes $Speed $Rss \
+                        $OldSpeed $OldRss
+        else
+                OldSpeed=-
+                OldRss=-
+                printf "%-12s %8d %7d %12d %10d\n" $Name $Lines $Passes $Speed $Rss
+        fi
+        echo "$Name $Passes $Speed $Rss $OldSpeed $OldRss" >> "$Results"
+done || exit 1
+
+if [ $Update = yes ]
+then
+        {
+                echo "# Recorded by run-benchmarks.sh --update, `date +%Y-%m-%d`."
+                echo "# case passes"
+                awk '{ print $1, $2 }' "$Results"
+        } > "$Baselines"
+        echo "Baselines updated."
+        exit 0
+fi
+
+# Compare against the baseline build and the recorded passes.
+awk -v Tolerance=$Tolerance '
+        FNR == NR {
+                if ($1 !~ /^#/ && NF >= 2)
+                        Passes[$1] = $2
+                next
+        }
+        {
+                if (!($1 in Passes))
+                        printf "%s: no recorded passes\n", $1
+                else if ($2 > Passes[$1]) {
+                        printf "%s: FAIL, %d passes where the baseline is %d\n", $1, $2, Passes[$1]
+                        Failures++
+                }
+                if ($5 == "-" || $5 <= 0 || $6 <= 0)
+                        next
+                if ($3 < $5 * (100 - Tolerance) / 100) {
+                        printf "%s: FAIL, %.0f%% of the baseline build'"'"'s speed\n", $1, 100 * $3 / $5
+                        Failures++
+                }
+                if ($4 > $6 * (100 + Tolerance) / 100) {
+                        printf "%s: FAIL, %.0f%% of the baseline build'"'"'s peak RSS\n", $1, 100 * $4 / $6
+                        Failures++
+                }
+        }
+        END {
+                if (Failures)
+                        printf "%d regression(s).\n", Failures
+                else
+                        print "No regressions."
+                exit Failures
+        }' "$Baselines" "$Results"
@@ -106,6 +106,40 @@
  *                            	builds with "--hardware --parity" was giving hardware-
  *                            	incompatible binaries).
  *             	2018-10-12 RSB  Added stuff associated with --simulation.
+ *              2026-10-17 AGT  Report how many lines were actually evaluated
+ *                              in each symbol-resolution pass.
+ *              2026-10-17 AGT  Added --cache.
+ *              2026-10-17 AGT  Added --threads.
+ *              2026-10-17 AGT  Added --batch.  What used to be main() is
+ *                              now Assemble().
+ *              2026-10-17 AGT  The state of the assembly is thread-local
+ *                              (ASSEMBLY), and main() is left out of the
+ *                              library build (YAYUL_LIBRARY).
+ *              2026-10-17 AGT  The rope is built in memory and written all
+ *                              at once (Rope.c).  Added --output.
+ *              2026-10-17 AGT  Added --stats.
+ *              2026-10-17 AGT  When a pass reaches a fixed point, the pass
+ *                              which would merely confirm it is skipped.
+ *              2026-10-17 AGT  The symbols are found during the first pass
+ *                              rather than by a separate SymbolPass(), unless
+ *                              --symbol-pass is used.
+ *              2026-10-17 AGT  The operand-cache counts are listed.
+ *              2026-10-17 AGT  The symbol-table file is written in version
+ *                              2 of its format, unless --symtab-v1.
+ *              2026-10-17 AGT  The bugger and padding words are marked as
+ *                              OBJECT_WRITTEN rather than given parities.
+ *              2026-10-17 AGT  The banks are summed all at once, by
+ *                              ChecksumBanks().  Added --verify-checksums.
+ *              2026-10-17 AGT  The listing is written by fprintf(LISTING, ...)
+ *                              rather than by printf().
+ *              2026-10-17 AGT  Added OutOfMemory, which fails the assembly.
+ *              2026-10-17 AGT  Added ErrorFile, for yaYULAssembleJob().
+ *              2026-10-17 AGT  --threads is now --processes, since that's
+ *                              what it starts.
+ *              2026-10-17 AGT  A warning is given when --output=- or a batch
+ *                              turns off --cache or --processes.
+ *              2026-10-17 AGT  --help says where duplicated symbols are
+ *                              listed, with and without --symbol-pass.
  */
 
 #include "yaYUL.h"
@@ -119,30 +153,35 @@
 //-------------------------------------------------------------------------
 // Some global data.
 
-int debugLevel = 0;
-int debugPass = 0;
-int debugLine = 0;
-char *debugLineString = "";
+ASSEMBLY int debugLevel = 0;
+ASSEMBLY int debugPass = 0;
+ASSEMBLY int debugLine = 0;
+ASSEMBLY char *debugLineString = "";
 void
 debugPrint(char *msg)
 {
-  printf("Debug (%d,%d) %s: %s\n", debugPass, debugLine, msg, debugLineString);
+  fprintf(LISTING, "Debug (%d,%d) %s: %s\n", debugPass, debugLine, msg,
+      debugLineString);
 }
 
-int formatOnly = 0;
-int toYulOnly = 0, toYulOnlySequenceNumber;
-Line_t toYulOnlyLogSection;
-int syntaxOnly = 0;
-int Force = 0;
-char *InputFilename = NULL, *OutputFilename = NULL;
+ASSEMBLY int formatOnly = 0;
+ASSEMBLY int toYulOnly = 0, toYulOnlySequenceNumber;
+ASSEMBLY Line_t toYulOnlyLogSection;
+ASSEMBLY int syntaxOnly = 0;
+ASSEMBLY int Force = 0;
+ASSEMBLY char *InputFilename = NULL, *OutputFilename = NULL;
 //FILE *InputFile = NULL;
-FILE *OutputFile = NULL;
-static int NoChecksums = 0;
-static int Parity = 0;
-static int Hardware = 0;
-int posChecksums = 0;
-int asYUL = 0, trace = 0;
-int Simulation = 0;
+ASSEMBLY FILE *OutputFile = NULL;
+static ASSEMBLY int NoChecksums = 0;
+static ASSEMBLY int Parity = 0;
+static ASSEMBLY int Hardware = 0;
+ASSEMBLY int posChecksums = 0;
+ASSEMBLY int asYUL = 0, trace = 0;
+ASSEMBLY int Simulation = 0;
+ASSEMBLY int Processes = 1;
+ASSEMBLY int OutOfMemory = 0;
+ASSEMBLY FILE *ListingFile = NULL;
+ASSEMBLY FILE *ErrorFile = NULL;
 
 static Address_t RegEB = REG(03);
 static Address_t RegFB = REG(04);
@@ -200,19 +239,44 @@ Add(int n1, int n2)
 }
 
 //-------------------------------------------------------------------------
-// The main program.
+// The main program.  With --batch, it's Batch.c that does the work.
 
+#ifndef YAYUL_LIBRARY
 int
 main(int argc, char *argv[])
+{
+  int i;
+
+  for (i = 1; i < argc; i++)
+    if (!strncmp(argv[i], "--batch=", 8))
+      return (Batch(argc, argv));
+  return (Assemble(argc, argv));
+}
+#endif
+
+//-------------------------------------------------------------------------
+// Assemble a single program, given the command line.  Returns the exit
+// code.
+
+int
+Assemble(int argc, char *argv[])
 {
   int MaxPasses = 10;
-  int RetVal = 1, i, j, k, LastUnresolved, Fatals = 0, Warnings = 0;
-  extern int UnpoundPage;
+  int RetVal = 1, i, j, k, LastUnresolved, Final, Fatals = 0, Warnings = 0;
+  extern ASSEMBLY int UnpoundPage;
+  extern ASSEMBLY int SymbolTableSize;
 
   // JMS: OutputSymbols = 1 to output a symbol table to SymbolFile.
   // RSB: Jordan made this an option, but I think it should be the default.
   int OutputSymbols = 1;	// 0;
+  int LegacySymtab = 0;
+  char *VerifyFilename = NULL;
   char *SymbolFile = NULL;
+  char *CacheDirectory = NULL;
+  char *StatsFilename = NULL;
+  int WantStats = 0;
+  int SeparateSymbolPass = 0, NumValid;
+  StatsTime_t Mark;
 
   // Parse the command-line options.
   for (i = 1; i < argc; i++)
@@ -279,52 +343,132 @@ main(int argc, char *argv[])
         }
       else if (!strcmp(argv[i], "--simulation"))
 	Simulation = 1;
+      else if (!strncmp(argv[i], "--cache=", 8) && argv[i][8])
+        CacheDirectory = &argv[i][8];
+      else if (1 == sscanf(argv[i], "--processes=%d", &j))
+        Processes = j;
+      else if (!strcmp(argv[i], "--stats"))
+        WantStats = 1;
+      else if (!strncmp(argv[i], "--stats=", 8) && argv[i][8])
+        {
+          WantStats = 1;
+          StatsFilename = &argv[i][8];
+        }
+      else if (!strncmp(argv[i], "--output=", 9) && argv[i][9])
+        OutputFilename = &argv[i][9];
+      else if (!strcmp(argv[i], "--symbol-pass"))
+        SeparateSymbolPass = 1;
+      else if (!strcmp(argv[i], "--symtab-v1"))
+        LegacySymtab = 1;
+      else if (!strncmp(argv[i], "--verify-checksums=", 19) && argv[i][19])
+        VerifyFilename = &argv[i][19];
       else if (*argv[i] == '-' || *argv[i] == '/')
         {
-          printf("Unknown switch \"%s\".\n", argv[i]);
+          fprintf(LISTING, "Unknown switch \"%s\".\n", argv[i]);
           goto Done;
         }
       else if (InputFilename == NULL)
         {
           InputFilename = argv[i];
-          OutputFilename = (char *) malloc(5 + strlen(InputFilename));
-          if (OutputFilename == NULL)
-            {
-              printf("Out of memory (1).\n");
-              goto Done;
-            }
-          sprintf(OutputFilename, "%s.bin", InputFilename);
           //InputFile = fopen (InputFilename, "r");
           //if (InputFile == NULL)
           //  {
           //    printf ("Input file does not exist.\n");
           //    goto Done;
           //  }
-          OutputFile = fopen(OutputFilename, "wb");
-          if (OutputFile == NULL)
+        }
+      else
+        {
+          fprintf(LISTING, "Two input files defined.\n");
+          goto Done;
+        }
+    }
+
+  // Just checking an existing rope?
+  if (VerifyFilename != NULL)
+    return (VerifyChecksums(VerifyFilename,
+        Hardware ? ROPE_HARDWARE : (Parity ? ROPE_PARITY : ROPE_PLAIN),
+        posChecksums) != 0);
+
+  // Create the output file, which is the input file with .bin appended
+  // unless --output says otherwise.  With --output=-, the rope goes to
+  // stdout, and so the listing goes to stderr instead.
+  if (InputFilename != NULL)
+    {
+      if (OutputFilename == NULL)
+        {
+          OutputFilename = (char *) malloc(5 + strlen(InputFilename));
+          if (OutputFilename == NULL)
             {
-              printf("Cannot create output file.\n");
+              fprintf(LISTING, "Out of memory (1).\n");
               goto Done;
             }
-
+          sprintf(OutputFilename, "%s.bin", InputFilename);
+        }
+      if (!strcmp(OutputFilename, "-"))
+        {
+          OutputFile = stdout;
+          if (ListingFile == NULL)
+            ListingFile = stderr;
         }
       else
+        OutputFile = fopen(OutputFilename, "wb");
+      if (OutputFile == NULL)
         {
-          printf("Two input files defined.\n");
+          fprintf(LISTING, "Cannot create output file.\n");
           goto Done;
         }
     }
 
+  // With a listing file of its own (see Library.c), this may be just one of
+  // several assemblies in the process, so it mustn't touch stdout.  Neither
+  // --cache nor --processes can work that way, so they're turned off, and
+  // the same goes for --output=-, where the listing has been moved to
+  // stderr.  Either way, say so rather than quietly ignoring them.
+  if (ListingFile != NULL)
+    {
+      if (CacheDirectory != NULL)
+        fprintf(ERRORS, "Warning: --cache is ignored %s.\n",
+            OutputFile == stdout ? "with --output=-"
+                : "under --batch or yaYULAssemble()");
+      if (Processes > 1)
+        fprintf(ERRORS, "Warning: --processes is ignored %s.\n",
+            OutputFile == stdout ? "with --output=-"
+                : "under --batch or yaYULAssemble()");
+      CacheDirectory = NULL;
+      Processes = 1;
+    }
+
   if (formatOnly || toYulOnly)
     {
       Pass(0, InputFilename, NULL, &Fatals, &Warnings);
       return (0);
     }
 
-  printf("Apollo Guidance Computer (AGC) assembler, version " NVER
+  // If this exact assembly has been done before, just reproduce it.
+  if (CacheDirectory != NULL && InputFilename != NULL && OutputFile != NULL)
+    {
+      i = CacheLookup(CacheDirectory, InputFilename, argc, argv);
+      if (i)
+        {
+          fclose(OutputFile);
+          if (i < 0)
+            {
+              remove(OutputFilename);
+              return (1);
+            }
+          return (CacheRestore());
+        }
+      CacheNoteOutput(OutputFilename);
+    }
+
+  if (WantStats)
+    StatsStart();
+
+  fprintf(LISTING, "Apollo Guidance Computer (AGC) assembler, version " NVER
   ", built " __DATE__ ", target %s\n", assemblyTarget);
-  printf("(c)2003-2005,2009-2010,2016-2018 Ronald S. Burkey\n");
-  printf(
+  fprintf(LISTING, "(c)2003-2005,2009-2010,2016-2018 Ronald S. Burkey\n");
+  fprintf(LISTING, 
       "Refer to http://www.ibiblio.org/apollo/index.html for more information.\n");
 
   if (InputFilename == NULL || OutputFile == NULL)
@@ -335,29 +479,42 @@ main(int argc, char *argv[])
         goto Done;
     }
 
-  // Perform a preliminary pass, whose sole purpose is to identify
-  // all symbols defined in the program.
-  SymbolPass(InputFilename);
+  // With --symbol-pass, perform a preliminary pass, whose sole purpose is
+  // to identify all symbols defined in the program.  Otherwise, the first
+  // of the passes below does that as it goes.  The only visible difference
+  // is in the listing:  duplicated symbols are found when the symbols are
+  // sorted, which is now after "Pass #1" rather than before it.
+  if (SeparateSymbolPass)
+    {
+      StatsMark(&Mark);
+      SymbolPass(InputFilename);
+      StatsPhase(STATS_SYMBOL_PASS, &Mark);
+    }
   // Also, define all register names.
   // ... Later:  It turns out that the Luminary or Colossus source code
   // defines any registers it needs, so this step isn't required.
   // I use the following symbols, which I don't allow the source to define.
-  AddSymbol("$3");
-  AddSymbol("$4");
-  AddSymbol("$5");
-  AddSymbol("$6");
-  AddSymbol("$7");
-  AddSymbol("$17");
+  DefineSymbol("$3");
+  DefineSymbol("$4");
+  DefineSymbol("$5");
+  DefineSymbol("$6");
+  DefineSymbol("$7");
+  DefineSymbol("$17");
   if (Block1)
     {
-      AddSymbol("$16");
-      AddSymbol("$25");
-      AddSymbol("$5777");
+      DefineSymbol("$16");
+      DefineSymbol("$25");
+      DefineSymbol("$5777");
     }
 
-  // Sort the symbol table, or else we won't be able to locate the
-  // symbols later.
-  Fatals += SortSymbols();
+  // Sort the symbol table.  (The symbols can be found without it, but
+  // they're listed in sorted order, and duplicates are caught this way.)
+  if (SeparateSymbolPass)
+    {
+      StatsMark(&Mark);
+      Fatals += SortSymbols();
+      StatsPhase(STATS_SORT_SYMBOLS, &Mark);
+    }
 
   // Assign the registers their proper addresses.
   if (!Block1)
@@ -400,44 +557,84 @@ main(int argc, char *argv[])
   // but it's not worth the effort to figure it out.
 
   LastUnresolved = UnresolvedSymbols();
+  NumValid = SymbolTableSize - LastUnresolved;
 
   for (i = 1; i <= MaxPasses; i++)
     {
       debugPass = i;
-      printf("Pass #%d\n", i);
+      fprintf(LISTING, "Pass #%d\n", i);
+      StatsMark(&Mark);
+      DiscoveringSymbols = (i == 1 && !SeparateSymbolPass);
       j = Pass(0, InputFilename, OutputFile, &Fatals, &Warnings);
-      k = UnresolvedSymbols();
-      if (j == -1)
+      if (DiscoveringSymbols)
         {
-          printf("Unrecoverable error.\n");
+          // Now that all of the symbols are known, sort them.  Until the
+          // pass began, all but the registers were unresolved.
+          DiscoveringSymbols = 0;
+          StatsPass(&Mark, 0, UnresolvedSymbols(), numSymbolsReassigned);
+          StatsMark(&Mark);
+          Fatals += SortSymbols();
+          StatsPhase(STATS_SORT_SYMBOLS, &Mark);
+          LastUnresolved = SymbolTableSize - NumValid;
+          k = UnresolvedSymbols();
+        }
+      else
+        {
+          k = UnresolvedSymbols();
+          StatsPass(&Mark, 0, k, numSymbolsReassigned);
+        }
+      fprintf(LISTING, "Lines evaluated:  %d (%d unchanged lines skipped)\n",
+          LinesEvaluated, LinesSkipped);
+      if (j == -1 || OutOfMemory)
+        {
+          fprintf(LISTING, "Unrecoverable error.\n");
           break;
         }
-      if ((k == 0 || k >= LastUnresolved) && numSymbolsReassigned == 0)
+      Final = ((k == 0 || k >= LastUnresolved) && numSymbolsReassigned == 0);
+      // If another pass would simply repeat this one, then it's the pass
+      // that would pass the test above, so we may as well skip it.
+      if (!Final && i < MaxPasses && ResolveConverged())
+        {
+          fprintf(LISTING,
+              "Fixed point reached, so pass #%d is unnecessary.\n", i + 1);
+          StatsCounters.PassesSaved++;
+          Final = 1;
+        }
+      if (Final)
         {
 	  debugPass++;
-          printf("Pass #%d\n", i + 1);
-          Pass(1, InputFilename, OutputFile, &Fatals, &Warnings);
+          fprintf(LISTING, "Pass #%d\n", i + 1);
+          StatsMark(&Mark);
+          if (ParallelPass(InputFilename, OutputFile, &Fatals, &Warnings))
+            Pass(1, InputFilename, OutputFile, &Fatals, &Warnings);
+          StatsPass(&Mark, 1, UnresolvedSymbols(), numSymbolsReassigned);
           break;
         }
       LastUnresolved = k;
       //PrintSymbols ();
     }
 
+  if (OutOfMemory)
+    Fatals++;
+
   if (syntaxOnly)
     {
-      printf("Fatal errors:  %d\n", Fatals);
-      printf("Warnings:  %d\n", Warnings);
-      return (Fatals);
+      fprintf(LISTING, "Fatal errors:  %d\n", Fatals);
+      fprintf(LISTING, "Warnings:  %d\n", Warnings);
+      StatsReport(StatsFilename, InputFilename);
+      return (CacheStore(Fatals));
     }
 
   // Print the symbol table.
-  printf("\n\n");
+  fprintf(LISTING, "\n\n");
   PrintBankCounts();
-  printf("\n\n");
+  fprintf(LISTING, "\n\n");
   PrintSymbols();
-  printf("\nUnresolved symbols:  %d\n", UnresolvedSymbols());
-  printf("Fatal errors:  %d\n", Fatals);
-  printf("Warnings:  %d\n", Warnings);
+  fprintf(LISTING, "\nUnresolved symbols:  %d\n", UnresolvedSymbols());
+  fprintf(LISTING, "Operand cache:  %lu hits, %lu misses\n", OperandHits,
+      OperandMisses);
+  fprintf(LISTING, "Fatal errors:  %d\n", Fatals);
+  fprintf(LISTING, "Warnings:  %d\n", Warnings);
   if (HtmlOut != NULL)
     {
       fprintf(HtmlOut, "\n");
@@ -460,20 +657,37 @@ main(int argc, char *argv[])
       SymbolFile = (char *) malloc(8 + strlen(InputFilename));
       if (SymbolFile == NULL)
         {
-          printf("Out of memory (2).\n");
+          fprintf(LISTING, "Out of memory (2).\n");
           goto Done;
         }
       sprintf(SymbolFile, "%s.symtab", InputFilename);
-      WriteSymbolsToFile(SymbolFile);
+      if (LegacySymtab)
+        WriteSymbolsToFile(SymbolFile);
+      else
+        WriteSymtab(SymbolFile);
     }
 
-  // Output the executable object code.
-  if (Fatals == 0 || Force)
+  // Output the executable object code.  If the passes never got as far as
+  // the final one, there isn't any, but the bugger words are still added.
+  if (ObjectCode == NULL && ClearObjectCode())
+    Fatals++;
+  if ((Fatals == 0 || Force) && ObjectCode != NULL)
     {
-      int BankRaw, Bank, Offset, Value;
-      uint16_t Bugger, GuessBugger;
-
-      printf("\n");
+      int BankRaw, Bank, Offset, Value, Lengths[044];
+      uint16_t Bugger, GuessBugger, Sums[044];
+
+      fprintf(LISTING, "\n");
+      // The parity bits are added if requested.  The AGC hardware used
+      // bit 15 for parity, while yaAGC uses bit position 1.
+      if (RopeStart(Hardware ? ROPE_HARDWARE
+          : (Parity ? ROPE_PARITY : ROPE_PLAIN)))
+        Fatals++;
+
+      // Pad the banks, and work out how many words of each the bugger word
+      // will follow (or 0 if there won't be one).  Then sum all of those
+      // at once.
+      StatsMark(&Mark);
+      memset(Lengths, 0, sizeof(Lengths));
       for (BankRaw = (Block1 ? 1 : 0); BankRaw < (Block1 ? 035 : 044);
           BankRaw++)
         {
@@ -481,7 +695,6 @@ main(int argc, char *argv[])
           Bank = BankRaw;
           if (Bank < 4 && !Hardware && !Block1)	// flip-flop 0,1 with 2,3 when not building for hardware targets
             Bank ^= 2;
-          // Add bugger info to the bank.
           if (!NoChecksums)
             {
               if (Block1)
@@ -509,55 +722,59 @@ main(int argc, char *argv[])
                     {
                       if (Value < 01776)
                         {
-                          ObjectCode[Bank][Value] = Value + Offset;
-                          Parities[Bank][Value] = CalculateParity(Value + Offset);
+                          ObjectCode[Bank][Value] = (Value + Offset) | OBJECT_WRITTEN;
                           Value++;
                         }
                       if (Value < 01777)
                         {
-                          ObjectCode[Bank][Value] = Value + Offset;
-                          Parities[Bank][Value] = CalculateParity(Value + Offset);
+                          ObjectCode[Bank][Value] = (Value + Offset) | OBJECT_WRITTEN;
                           Value++;
                         }
                     }
                   if (Value < 02000)
-                    {
-                      for (Bugger = Offset = 0; Offset < Value; Offset++) {
-                        Bugger = Add(Bugger, ObjectCode[Bank][Offset]);
-                      }
-                      if ((0 == (040000 & Bugger)) || posChecksums)
-                        GuessBugger = Add(Bank, 077777 & ~Bugger);
-                      else
-                        GuessBugger = Add(077777 & ~Bank, 077777 & ~Bugger);
-                      ObjectCode[Bank][Value] = GuessBugger;
-                      Parities[Bank][Value] = CalculateParity(GuessBugger);
-                      printf("Bugger word %05o at %02o,%04o.\n", GuessBugger, Bank,
-                          (Block1 ? 06000 : 02000) + Value);
-                      if (HtmlOut != NULL)
-                        fprintf(HtmlOut, "Bugger word %05o at %02o,%04o.\n",
-                            GuessBugger, Bank, (Block1 ? 06000 : 02000) + Value);
-                    }
+                    Lengths[Bank] = Value;
                 }
             }
-          // Output the binary data.
-          for (Offset = 0; Offset < 02000; Offset++)
+        }
+      ChecksumBanks(Lengths, Sums);
+      StatsPhase(STATS_BUGGER_WORDS, &Mark);
+
+      for (BankRaw = (Block1 ? 1 : 0); BankRaw < (Block1 ? 035 : 044);
+          BankRaw++)
+        {
+          Bank = BankRaw;
+          if (Bank < 4 && !Hardware && !Block1)
+            Bank ^= 2;
+          // Add bugger info to the bank.
+          StatsMark(&Mark);
+          Value = Lengths[Bank];
+          if (Value > 0)
             {
-              Value = ObjectCode[Bank][Offset] << 1;
-
-              // Add in the parity bits if requested
-              if (Hardware)
-                // The AGC hardware used bit 15 for parity
-                Value = (Value & 0100000)  |
-                        (Parities[Bank][Offset] << 14) |
-                        ((Value & 077776) >> 1);
-              else if (Parity)
-                // yaAGC uses bit position 1 for parity
-                Value |= Parities[Bank][Offset];
-
-              fputc(Value >> 8, OutputFile);
-              fputc(Value, OutputFile);
+              Bugger = Sums[Bank];
+              if ((0 == (040000 & Bugger)) || posChecksums)
+                GuessBugger = Add(Bank, 077777 & ~Bugger);
+              else
+                GuessBugger = Add(077777 & ~Bank, 077777 & ~Bugger);
+              ObjectCode[Bank][Value] = GuessBugger | OBJECT_WRITTEN;
+              fprintf(LISTING, "Bugger word %05o at %02o,%04o.\n",
+                  GuessBugger, Bank, (Block1 ? 06000 : 02000) + Value);
+              if (HtmlOut != NULL)
+                fprintf(HtmlOut, "Bugger word %05o at %02o,%04o.\n",
+                    GuessBugger, Bank, (Block1 ? 06000 : 02000) + Value);
             }
+          StatsPhase(STATS_BUGGER_WORDS, &Mark);
+          // Output the binary data.
+          StatsMark(&Mark);
+          RopeAddBank(Bank);
+          StatsPhase(STATS_WRITE_BINARY, &Mark);
+        }
+      StatsMark(&Mark);
+      if (RopeFinish(OutputFile))
+        {
+          fprintf(LISTING, "Cannot write output file.\n");
+          Fatals++;
         }
+      StatsPhase(STATS_WRITE_BINARY, &Mark);
     }
 
   // All done!
@@ -565,12 +782,12 @@ main(int argc, char *argv[])
   Done:
   //if (InputFile != NULL)
   //  fclose (InputFile);
-  if (OutputFile != NULL)
+  if (OutputFile != NULL && OutputFile != stdout)
     fclose(OutputFile);
   HtmlClose();
   if (RetVal)
     {
-      printf("USAGE:\n"
+      fprintf(LISTING, "USAGE:\n"
           "\tyaYUL [OPTIONS] InputFile\n"
           "The output (binary executable) always has the same name\n"
           "as the assembly-language input file, except that .bin is \n"
@@ -581,16 +798,16 @@ main(int argc, char *argv[])
           "The assembly listing, including symbol table and any error\n"
           "messages appear on the standard output.\n\n"
           "OPTIONS:\n");
-      printf("--help or /?     Display this message.\n");
-      printf("--max-passes=n   By default, the assembler makes at most\n"
+      fprintf(LISTING, "--help or /?     Display this message.\n");
+      fprintf(LISTING, "--max-passes=n   By default, the assembler makes at most\n"
           "                 %d passes trying to resolve addresses.\n"
           "                 This switch changes that value.\n", MaxPasses);
-      printf("--force          Force creation of core-rope image. (By\n"
+      fprintf(LISTING, "--force          Force creation of core-rope image. (By\n"
           "                 default, the core-rope is not created if\n"
           "                 there were fatal errors during assembly.\n");
       //printf ("--g              Output the binary symbol table to the file\n"
       //        "                 InputFile.symtab\n");
-      printf("--html           Causes an HTML file to be created, which is \n"
+      fprintf(LISTING, "--html           Causes an HTML file to be created, which is \n"
           "                 the same as the output listing except that it\n"
           "                 if a lot more convenient to use. It has syntax\n"
           "                 highlighting and hyperlinks from where each\n"
@@ -601,67 +818,100 @@ main(int argc, char *argv[])
           "                 files are produced for all source files included\n"
           "                 with the $ directive, and links between the files\n"
           "                 are provided.\n");
-      printf("--unpound-page   Bypass --html processing for \"## Page\".\n");
-      printf(
+      fprintf(LISTING, "--unpound-page   Bypass --html processing for \"## Page\".\n");
+      fprintf(LISTING, 
           "--block1         Assembles Block 1 code.  The default is Block 2.\n");
-      printf(
+      fprintf(LISTING, 
           "--blk2           For the early version of Block 2 code, such as\n");
-      printf(
+      fprintf(LISTING, 
           "                 in the AURORA program.  Not used for Block 2 in\n");
-      printf(
+      fprintf(LISTING, 
           "                 general, though, and not for any flown missions.\n");
-      printf(
+      fprintf(LISTING, 
           "                 The default (omitting both --block1 and --blk2)\n");
-      printf(
+      fprintf(LISTING, 
           "                 is correct for almost all surviving AGC software.\n");
-      printf(
+      fprintf(LISTING, 
           "                 Implies --pos-checksums.\n");
-      printf(
+      fprintf(LISTING, 
           "--pos-checksums  Calculate checksums using BLK2 style, in which all\n");
-      printf(
+      fprintf(LISTING, 
           "                 checksums must be equal to the positive bank number.\n");
-      printf(
+      fprintf(LISTING, 
           "                 This is implied by --blk2, but is also needed for\n");
-      printf(
+      fprintf(LISTING, 
           "                 early AGC programs (Sunburst 116 and earlier).\n");
-      printf(
+      fprintf(LISTING, 
           "--early-sbank    Assembles the code using the original (pre-1967)\n");
-      printf(
+      fprintf(LISTING, 
           "                 YUL superbank behavior.\n");
-      printf(
+      fprintf(LISTING, 
           "--raytheon       Assembles Raytheon-style code.  The default is MIT.\n");
-      printf("--no-checksums   Don't emit bank checksums. For use with Retread 44.\n");
-      printf("--parity         Enable parity bit calculation.\n");
-      printf("--hardware       Emit binary with hardware bank order. Also implies\n"
+      fprintf(LISTING, "--no-checksums   Don't emit bank checksums. For use with Retread 44.\n");
+      fprintf(LISTING, "--parity         Enable parity bit calculation.\n");
+      fprintf(LISTING, "--hardware       Emit binary with hardware bank order. Also implies\n"
           "                 --parity.\n");
-      printf(
+      fprintf(LISTING, 
           "--format         Just reformat the file and re-output. Don't assemble.\n");
-      printf(
+      fprintf(LISTING, 
           "--syntax         Perform syntax-checking only, no symbol resolution.\n");
-      printf(
+      fprintf(LISTING, 
           "--max-passes     Set the max number of assembler passes (default: 10).\n");
-      printf(
+      fprintf(LISTING, 
           "                 words\" that lead to bank checksums equal to B (where B\n");
-      printf(
+      fprintf(LISTING, 
           "                 is the fixed-bank number, in octal).  However, bank checksums\n");
-      printf(
+      fprintf(LISTING, 
           "                 equal to -B (in 1's complement) are also valid.  This option\n");
-      printf(
+      fprintf(LISTING, 
           "                 is used to instruct yaYUL to use the -B bugger word for bank B.\n");
-      printf("                 Multiple --flip options can be used.\n");
-      printf("--yul            Assemble as YUL rather than GAP.  Has no effect at present.\n");
-      printf("--trace          Trace some of yaYUL's internal activity, for debugging.\n");
-      printf("--to-yul=S,L     Processes a single input file in .agc format, outputting\n");
-      printf("                 an equivalent .yul file on stdout.  S (a decimal number\n");
-      printf("                 is the initial card-sequence number.  L (a string) is the\n");
-      printf("                 name of the log section to use as a P-card.\n");
-      printf("--simulation     Reacts to the string -SIMULATION and +SIMULATION in comments.\n");
+      fprintf(LISTING, "                 Multiple --flip options can be used.\n");
+      fprintf(LISTING, "--yul            Assemble as YUL rather than GAP.  Has no effect at present.\n");
+      fprintf(LISTING, "--trace          Trace some of yaYUL's internal activity, for debugging.\n");
+      fprintf(LISTING, "--to-yul=S,L     Processes a single input file in .agc format, outputting\n");
+      fprintf(LISTING, "                 an equivalent .yul file on stdout.  S (a decimal number\n");
+      fprintf(LISTING, "                 is the initial card-sequence number.  L (a string) is the\n");
+      fprintf(LISTING, "                 name of the log section to use as a P-card.\n");
+      fprintf(LISTING, "--simulation     Reacts to the string -SIMULATION and +SIMULATION in comments.\n");
+      fprintf(LISTING, "--cache=D        Keep the results of each assembly in the directory D,\n");
+      fprintf(LISTING, "                 and if the same source files are later assembled with\n");
+      fprintf(LISTING, "                 the same options, reproduce them without reassembling.\n");
+      fprintf(LISTING, "                 Ignored with --output=- or --batch.\n");
+      fprintf(LISTING, "--processes=N    Split the final pass among as many as N child\n");
+      fprintf(LISTING, "                 processes, at the $ directives of InputFile.\n");
+      fprintf(LISTING, "                 The output is the same as with the default (1).\n");
+      fprintf(LISTING, "                 Ignored with --output=- or --batch.\n");
+      fprintf(LISTING, "--output=F       Write the core-rope image to the file F rather than\n");
+      fprintf(LISTING, "                 to InputFile.bin.  With --output=-, it is written\n");
+      fprintf(LISTING, "                 to stdout (e.g., into a pipe), and the listing\n");
+      fprintf(LISTING, "                 goes to stderr instead.  --cache and --processes\n");
+      fprintf(LISTING, "                 are then ignored, with a warning.\n");
+      fprintf(LISTING, "--batch=F        Perform all of the assemblies listed in the file F,\n");
+      fprintf(LISTING, "                 one per line, each as a directory to assemble in,\n");
+      fprintf(LISTING, "                 a file to receive the listing, and the switches\n");
+      fprintf(LISTING, "                 and input file.  With --threads=N, N assemblies\n");
+      fprintf(LISTING, "                 are run at once (by default, one per CPU).\n");
+      fprintf(LISTING, "--stats[=F]      At the end, write timings and other statistics of\n");
+      fprintf(LISTING, "                 the assembly as JSON, to the file F or else to\n");
+      fprintf(LISTING, "                 stderr.\n");
+      fprintf(LISTING, "--symbol-pass    Find the symbols in a separate pass before the\n");
+      fprintf(LISTING, "                 others, rather than during the first of them.\n");
+      fprintf(LISTING, "                 The results are the same, but it's slower, and\n");
+      fprintf(LISTING, "                 duplicated symbols are listed before \"Pass #1\"\n");
+      fprintf(LISTING, "                 rather than after it.\n");
+      fprintf(LISTING, "--symtab-v1      Write InputFile.symtab in the original format,\n");
+      fprintf(LISTING, "                 rather than in version 2 (see yaYUL.h).\n");
+      fprintf(LISTING, "--verify-checksums=F\n");
+      fprintf(LISTING, "                 Rather than assembling anything, check the bank\n");
+      fprintf(LISTING, "                 checksums of the core-rope image F.  Use the same\n");
+      fprintf(LISTING, "                 --block1, --hardware and --pos-checksums switches\n");
+      fprintf(LISTING, "                 as when F was made.\n");
     }
-  if ((RetVal || Fatals) && !Force)
+  if ((RetVal || Fatals) && !Force && OutputFile != stdout)
     remove(OutputFilename);
   if (RetVal == 0)
-    return (Fatals);
-  else
-    return (RetVal);
+    RetVal = Fatals;
+  StatsReport(StatsFilename, InputFilename);
+  return (CacheStore(RetVal));
 }
 
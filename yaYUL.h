@@ -77,11 +77,31 @@
 #define INCLUDED_YAYUL_H
 
 #include <stdio.h>
+#include <stdint.h>
 
 #if defined(WIN32) && defined(_MSC_VER )
 #define MSC_VS
 #endif
 
+// The state of an assembly is kept in global variables, but each thread
+// has its own copy of those declared with ASSEMBLY, so that separate
+// threads can perform separate assemblies (see Library.c).
+#ifdef MSC_VS
+#define ASSEMBLY __declspec(thread)
+#else
+#define ASSEMBLY __thread
+#endif
+
+// Where the assembly listing is written.  Normally that's stdout, but when
+// yaYUL is used as a library, each assembly can have its own, so everything
+// which is part of the listing is written by fprintf(LISTING, ...).
+extern ASSEMBLY FILE *ListingFile;
+#define LISTING (ListingFile != NULL ? ListingFile : stdout)
+
+// Likewise, the error messages written to stderr by a normal assembly.
+extern ASSEMBLY FILE *ErrorFile;
+#define ERRORS (ErrorFile != NULL ? ErrorFile : stderr)
+
 //-------------------------------------------------------------------------
 // Constants.
 
@@ -253,8 +273,9 @@ typedef struct
   int NumberLines;                     // # of SymbolLine_t structs
 } SymbolFile_t;
 
-// The Symbol_t structure represents a symbol within the symbol table
-// This structure has been added to for the purposes of debugging. Recent
+// The Symbol_t structure represents a symbol within the symbol table file.
+// (In memory, the symbol table is kept as separate arrays; see
+// SymbolTable.c.)  This structure has been added to for the purposes of debugging. Recent
 // modifications include adding a "type" to distinguish between symbols
 // which are labels in the code and symbols which are variable names, and
 // the source file from which the symbol came from and its line number
@@ -285,7 +306,8 @@ typedef struct
 // source file in which it can be found and its line number in the source
 // file. The location of the line of code is given by an Address_t struct
 // although typically these should only contain addresses of fixed memory
-// locations.
+// locations.  (In memory, the line table holds the index of an interned
+// file name rather than the name itself; see SymbolTable.c.)
 typedef struct
 {
   Address_t CodeAddress;              // The fixed memory location of the code
@@ -299,18 +321,99 @@ typedef struct
 #define SORT_LEMAP             (31)
 #define SORT_ASM               (32)
 
+// Version 2 of the symbol-table file, which is what's written unless
+// --symtab-v1 is used, is meant to be used in place, say after mmap(),
+// rather than read piece by piece.  Every field is a little-endian
+// integer of the size given, every record is naturally aligned, and every
+// section begins at a multiple of 8 bytes from the start of the file.
+// Strings (names and paths) are given as offsets into the string table,
+// which is a series of NUL-terminated strings beginning with the empty
+// one, so 0 means "".  The sections are:
+//
+// SymtabHeader_t
+// SymtabSymbol_t (NumSymbols), sorted by name (strcmp order)
+// SymtabLine_t (NumLines), sorted by address as by SortLines(SORT_YUL)
+// uint32_t (SYMTAB_BANKS + 1), the address index:  the lines whose bank
+//      is B are the entries AddressIndex[B] through AddressIndex[B+1]-1,
+//      in increasing order of S-register.  The bank of an address is FB,
+//      or FB+010 if Super is set and FB >= 020, or for an unbanked
+//      address the S-register divided by 02000.
+// The string table (StringsSize bytes).
+//
+// A file of the original format, which has no magic number, begins with
+// the source path instead.
+#define SYMTAB_MAGIC           "yaYULsym"
+#define SYMTAB_VERSION         (2)
+#define SYMTAB_BANKS           (060)
+typedef struct
+{
+  char Magic[8];                        // SYMTAB_MAGIC, without the NUL
+  uint32_t Version;                     // SYMTAB_VERSION
+  uint32_t HeaderSize;                  // sizeof(SymtabHeader_t)
+  uint32_t FileSize;                    // Size of the whole file
+  uint32_t SourcePath;                  // Base path for all source
+  uint32_t NumSymbols, SymbolsOffset;
+  uint32_t NumLines, LinesOffset;
+  uint32_t AddressIndexOffset;
+  uint32_t StringsOffset, StringsSize;
+  uint32_t Reserved;                    // 0
+} SymtabHeader_t;
+
+// An Address_t, without the compiler-dependent bitfields.  Every field is
+// kept but Syllable, which is always 0 for the AGC.
+typedef struct
+{
+  int32_t Value;                        // Constant or full pseudo-address
+  uint16_t SReg;                        // S-register part of the address
+  uint16_t Flags;                       // SYMTAB_xxx below
+  uint8_t Banks;                        // FB in bits 7-3, EB in bits 2-0
+  uint8_t Reserved[3];                  // 0
+} SymtabAddress_t;
+#define SYMTAB_INVALID         (0x0001)
+#define SYMTAB_CONSTANT        (0x0002)
+#define SYMTAB_ADDRESS         (0x0004)
+#define SYMTAB_ERASABLE        (0x0008)
+#define SYMTAB_FIXED           (0x0010)
+#define SYMTAB_UNBANKED        (0x0020)
+#define SYMTAB_BANKED          (0x0040)
+#define SYMTAB_SUPER           (0x0080)
+#define SYMTAB_OVERFLOW        (0x0100)
+
+typedef struct
+{
+  uint32_t Name;                        // String offset
+  uint32_t Type;                        // SYMBOL_xxx
+  uint32_t FileName;                    // String offset
+  uint32_t LineNumber;
+  SymtabAddress_t Value;
+} SymtabSymbol_t;
+
+typedef struct
+{
+  SymtabAddress_t CodeAddress;
+  uint32_t FileName;                    // String offset
+  uint32_t LineNumber;
+} SymtabLine_t;
+
 // Edit a symbol in the table, but include symbol debugging information
 // such as the symbol's type, and the source file/line number from which
 // it came.
 int
 EditSymbolNew(const char *Name, Address_t *Value, int Type, char *FileName,
     unsigned int LineNumber);
+int
+EditSymbolNumber(int Symbol, Address_t *Value, int Type, char *FileName,
+    unsigned int LineNumber);
 
 // Writes the symbol table to a file in binary format. See yaYUL.h for
 // more information about the format. Takes the name of the symbol file.
 void
 WriteSymbolsToFile(char *fname);
 
+// Same, but in version 2 of the format (see SymtabHeader_t).
+void
+WriteSymtab(char *fname);
+
 // JMS: 07.28
 //-------------------------------------------------------------------------
 // Delete the line table.
@@ -325,6 +428,12 @@ ClearLines(void);
 int
 AddLine(Address_t *Address, const char *FileName, int LineNumber);
 
+//-------------------------------------------------------------------------
+// Fill in a SymbolLine_t, as written to the symbol-table file, from the
+// given entry of the line table.
+void
+GetLine(int Index, SymbolLine_t *Line);
+
 //-------------------------------------------------------------------------
 // Sort the line table. Takes which assembler we are using (SORT_YUL or
 // SORT_LEMAP) to use the proper sorting function for the addressing scheme.
@@ -354,6 +463,56 @@ typedef struct
 // A string type guaranteed to contain in input line.
 typedef char Line_t[1 + MAX_LINE_LENGTH];
 
+// Source files are read into memory just once (see SourceLines.c), and
+// each pass then works from the in-memory copy.  A SourceTokens_t is the
+// result of splitting a line into fields:  Text is the line after tab-
+// expansion, .yul-to-.agc conversion, and so on, with a NUL where the comment
+// separator was, and the fields are given as offsets into Text.
+#define MAX_SOURCE_FIELDS 6
+typedef struct
+{
+  char *Text;
+  int TextSize;                         // Including the comment and NULs.
+  int CommentOffset;                    // Offset of the comment in Text.
+  int CommentColumn;                    // Column of '#', or 0 if none.
+  char Column8;                         // Block 1 only, as in ParseInput_t.
+  int InversionPending;
+  int NumFields;
+  short FieldStart[MAX_SOURCE_FIELDS];
+  short FieldLength[MAX_SOURCE_FIELDS];
+  int Truncated;                        // Line was over MAX_LINE_LENGTH.
+} SourceTokens_t;
+
+typedef struct
+{
+  const char *Text;                     // In the file's image; not NUL-
+  int Length;                           // terminated.  Includes the '\n'.
+  char *Prepared;                       // After --simulation and "#>" fixups,
+                                        // or NULL if there were none.
+  unsigned Blank :1;                    // Line is entirely whitespace.
+  unsigned PoundPound :1;               // A "##" line, but not "## Page".
+  SourceTokens_t *RawTokens;            // Created on first use.
+  SourceTokens_t *PreparedTokens;       // Created on first use.
+} SourceLine_t;
+
+typedef struct
+{
+  Line_t Filename;
+  int yulType;                          // 0 for .agc, 1 for .yul.
+  const char *Image;                    // The whole file, as read.
+  size_t ImageSize;
+  int Mapped;                           // Image is mmap'd rather than malloc'd.
+  int NumLines;
+  SourceLine_t *Lines;
+} SourceFile_t;
+
+// Position within a source file, used in place of a FILE pointer.
+typedef struct
+{
+  SourceFile_t *File;
+  int Next;                             // Index of next line to read.
+} SourceCursor_t;
+
 // Stuff for parsers.
 typedef struct
 {
@@ -364,8 +523,6 @@ typedef struct
   int Index;
   unsigned Extend :2;
   unsigned IndexValid :1;
-  EBank_t EBank;
-  SBank_t SBank;
   // This isn't really column 8, but rather the column preceding the operator,
   // which in our syntax really forms the first character of the operator,
   // but needs to be removed before the operator is processed.  The only way
@@ -375,6 +532,10 @@ typedef struct
   char Column8;
   int InversionPending;
   int commentColumn;
+  // The fields from here on are carried over from the preceding line by
+  // Pass(), rather than being reset for each line.
+  EBank_t EBank;
+  SBank_t SBank;
 } ParseInput_t;
 
 typedef struct
@@ -383,7 +544,6 @@ typedef struct
   int Reserved;                         // Unused.
   int Words[MAX_ASSEMBLED_WORDS];       // Binary data assembled
   int NumWords;                         // ... and how many of them.
-  Line_t ErrorMessage;                  // If any.
   Address_t LabelValue;                 // Value of the label.
   int Index;
   unsigned Warning :1;                   // Non-zero for warning.
@@ -391,12 +551,64 @@ typedef struct
   unsigned LabelValueValid :1;           // Non-zero if LabelValue valid.
   unsigned Extend :2;
   unsigned IndexValid :1;
-  EBank_t EBank;                        // For EBANK= manipulations.
-  SBank_t SBank;                        // For SBANK= manipulations.
   int Equals;                           // Non-zero if = or EQUALS.
   char Column8;                         // Used only for Block1.
+  // The fields from here on aren't simply reset by Pass() for each line:
+  // the banks are carried over from the preceding line, and only the
+  // first character of the (rather large) error message is cleared.
+  EBank_t EBank;                        // For EBANK= manipulations.
+  SBank_t SBank;                        // For SBANK= manipulations.
+  Line_t ErrorMessage;                  // If any.
 } ParseOutput_t;
 
+// The state carried by Pass() from one source line to the next.  Resolve.c
+// compares these from one pass to the next, to decide whether a line needs
+// to be re-evaluated.  Only Pass.c knows what goes into them.
+typedef struct
+{
+  Address_t ProgramCounter;
+  EBank_t EBank;
+  SBank_t SBank;
+  int Index;
+  int Extend;
+  int IndexValid;
+  int NumInterpretiveOperands, RawNumInterpretiveOperands;
+  int nnnnFields[4];
+  unsigned char SwitchIncrement[4], SwitchInvert[4];
+  int StadrInvert;
+  int ExpectedOperatorLines, CurrentOperatorLines;
+  int NoOperator, FoundOperandCount;
+  int LineInFile;
+} LineState_t;
+
+// A point in the top-level source file at which the output pass can be
+// split up among several processes (see ParallelPass.c), along with the
+// complete state of the assembly at that point.
+typedef struct
+{
+  int Line;                             // Index of the line in the file.
+  int CurrentLineAll, CurrentLineInFile, inHeader;
+  LineState_t State;
+  int UsedInBank[044];
+  unsigned StyleHash;                   // HtmlStyleHash(), if --html.
+  int ResolveLine;                      // ResolveLineCount().
+} PassBoundary_t;
+
+// What FetchSymbolPlusOffset() made of a line's operand, kept by Resolve.c
+// from one pass to the next so that it needn't be worked out again.
+typedef struct
+{
+  char Operand[MAX_LABEL_LENGTH + 1];
+  char Mod1[MAX_LABEL_LENGTH + 1];
+  unsigned Filled :1;                   // If 0, the fields below are unset.
+  unsigned IsNumber :1;                 // If 1, Operand is the number Offset.
+  unsigned HasOffset :1;                // If 1, Mod1 is the number Offset.
+  int Symbol;                           // The symbol number, if not IsNumber.
+  int Offset;
+  unsigned Clock;                       // The symbol clock when filled.
+  Address_t Value;                      // The result, if not IsNumber.
+} OperandCache_t;
+
 typedef int
 Parser_t(ParseInput_t *ParseIn, ParseOutput_t *ParseOut);
 
@@ -453,11 +665,42 @@ PseudoToStruct(int Value, Address_t *Address);
 // From SymbolPass.c
 void
 SymbolPass(const char *InputFilename);
+int
+DiscoverSymbols(SourceFile_t *File, SourceLine_t *Line);
+
+// From yaYUL.c
+int
+Assemble(int argc, char *argv[]);
+
+// From Batch.c
+int
+Batch(int argc, char *argv[]);
+
+// From Library.c.  A yaYULJob_t gives what yaYULAssembleJob() needs to know
+// besides the command line; any of the fields may be NULL.
+typedef struct
+{
+  const char *Directory;                // Where to assemble; else the cwd.
+  FILE *Listing;                        // What goes to stdout; else stdout.
+  FILE *Errors;                         // What goes to stderr; else stderr.
+} yaYULJob_t;
+int
+yaYULAssemble(int argc, char *argv[], FILE *Listing);
+int
+yaYULAssembleJob(int argc, char *argv[], const yaYULJob_t *Job);
 
 // From Pass.c
 int
 Pass(int WriteOutput, const char *InputFilename, FILE *OutputFile, int *Fatals,
     int *Warnings);
+void
+SortAllOperators(void);
+void
+ClearPass(void);
+int
+ClearObjectCode(void);
+int
+LookUpOperator(const char *Name, int Search);
 int
 AddressPrint(Address_t *Address);
 
@@ -467,11 +710,19 @@ ClearSymbols(void);
 int
 AddSymbol(const char *Name);
 int
+DefineSymbol(const char *Name);
+int
 EditSymbol(const char *Name, Address_t *Value);
 int
 SortSymbols(void);
-Symbol_t *
+int
+FindSymbol(const char *Name);
+Address_t *
 GetSymbol(const char *Name);
+Address_t *
+GetNumberedSymbol(const char *Name, int *Number);
+char *
+GetSymbolFileName(int Symbol);
 void
 PrintSymbols(void);
 void
@@ -480,8 +731,12 @@ int
 UnresolvedSymbols(void);
 double
 ScaleFactor(char *s);
+double
+GetDecimal(const char *s);
 int
 GetOctOrDec(const char *s, int *Value);
+int
+GetNumber(const char *s, int *Value, int *Radix);
 char *
 NormalizeFilename(char *SourceName);
 int
@@ -489,8 +744,10 @@ HtmlCreate(char *Filename);
 void
 HtmlClose(void);
 int
-HtmlCheck(int WriteOutput, FILE *InputFile, char *s, int sSize,
+HtmlCheck(int WriteOutput, SourceCursor_t *InputFile, char *s, int sSize,
     char *CurrentFilename, int *CurrentLineAll, int *CurrentLineInFile);
+unsigned
+HtmlStyleHash(void);
 char *
 NormalizeAnchor(char *Name);
 char *
@@ -498,6 +755,134 @@ NormalizeString(char *Input);
 char *
 NormalizeStringN(char *Input, int PadTo);
 
+// From SourceLines.c
+SourceFile_t *
+GetSourceFile(const char *Filename);
+int
+OpenSource(SourceCursor_t *Cursor, const char *Filename);
+SourceLine_t *
+NextSourceLine(SourceCursor_t *Cursor);
+char *
+SourceGets(char *s, int Size, SourceCursor_t *Cursor);
+char *
+SourceText(char *s, int Size, const SourceLine_t *Line, int Raw);
+int
+SourceFirstChar(const SourceLine_t *Line);
+SourceTokens_t *
+GetSourceTokens(SourceFile_t *File, SourceLine_t *Line, int Raw);
+SourceTokens_t *
+TokenizeSourceLine(SourceFile_t *File, SourceLine_t *Line, int Column16);
+SourceTokens_t *
+GetSymbolTokens(SourceFile_t *File, SourceLine_t *Line);
+void
+FreeSourceTokens(SourceLine_t *Line, SourceTokens_t *Tokens);
+void
+ClearSourceFiles(void);
+
+// From ParallelPass.c
+int
+ParallelPass(const char *InputFilename, FILE *OutputFile, int *Fatals,
+    int *Warnings);
+
+// From Cache.c
+int
+CacheLookup(const char *Directory, const char *InputFilename, int argc,
+    char *argv[]);
+void
+CacheNoteOutput(const char *Filename);
+void
+CacheTrackOutputs(void);
+char **
+CacheOutputs(int *Count);
+int
+CacheStore(int RetVal);
+int
+CacheRestore(void);
+
+// From Rope.c
+enum
+{
+  ROPE_PLAIN, ROPE_PARITY, ROPE_HARDWARE
+};
+int
+RopeStart(int Format);
+void
+RopeAddBank(int Bank);
+int
+RopeFinish(FILE *Output);
+
+// From Checksum.c
+void
+ChecksumBanks(const int Lengths[044], uint16_t Sums[044]);
+int
+VerifyChecksums(const char *Filename, int Format, int PosChecksums);
+
+// From Stats.c
+enum
+{
+  STATS_SYMBOL_PASS, STATS_SORT_SYMBOLS, STATS_BUGGER_WORDS,
+  STATS_WRITE_BINARY, STATS_HTML, STATS_NUM_PHASES
+};
+typedef struct
+{
+  double Wall, Cpu;                     // Seconds.
+} StatsTime_t;
+typedef struct
+{
+  unsigned long SymbolLookups, SymbolMisses, IncPcCalls, PassesSaved;
+} StatsCounters_t;
+// What one of the worker processes of --processes adds to the statistics.
+typedef struct
+{
+  StatsCounters_t Counters;
+  StatsTime_t Phases[STATS_NUM_PHASES], Time;
+} StatsChild_t;
+extern ASSEMBLY int StatsEnabled;
+extern ASSEMBLY StatsCounters_t StatsCounters;
+void
+StatsMark(StatsTime_t *Mark);
+void
+StatsStart(void);
+void
+StatsPhase(int Phase, const StatsTime_t *Since);
+void
+StatsPass(const StatsTime_t *Since, int Final, int Unresolved, int Reassigned);
+void
+StatsChildStart(StatsChild_t *Child);
+void
+StatsChildEnd(StatsChild_t *Child);
+void
+StatsChildAdd(const StatsChild_t *Child);
+void
+StatsReport(const char *Filename, const char *InputFilename);
+
+// From Resolve.c
+void
+ResolveStartPass(int Enable);
+void
+ResolveClear(void);
+int
+ResolveBeginLine(SourceLine_t *Line, int RawTokens, LineState_t *State);
+void
+ResolveEndLine(LineState_t *State);
+void
+ResolveNoteRead(int Symbol);
+void
+ResolveNoteEdit(int Symbol, Address_t *Value, int Type, unsigned LineNumber,
+    int Changed);
+void
+ResolveVolatile(void);
+void
+ResolveRenumber(const int *NewNumbers, int OldCount, int NewCount);
+int
+ResolveConverged(void);
+OperandCache_t *
+ResolveOperandCache(const char *Operand, const char *Mod1, int *Hit);
+int
+ResolveLineCount(void);
+void
+ResolveSetLineCount(int Count);
+
 // From ParseGeneral.c.
 int
 ParseGeneral(ParseInput_t *, ParseOutput_t *, int, int);
@@ -524,6 +909,12 @@ void
 PrintBankCounts(void);
 int
 GetBankCount(int Bank);
+void
+GetBankCounts(int *Counts);
+void
+SetBankCounts(const int *Counts);
+int
+BankCountsChanged(void);
 
 // From ParseST.c
 int
@@ -551,6 +942,12 @@ PrintTrace(const ParseInput_t *inRecord, const ParseOutput_t *outRecord);
 int
 CalculateParity(int Value);
 
+// The odd-parity bit of a 16-bit word:  1 if the word has an even number
+// of 1 bits.  The nibbles are folded together and the result looked up in
+// a 16-bit table.
+#define PARITY16(n) ((0x9669 >> (((n) ^ ((n) >> 4) ^ ((n) >> 8) \
+    ^ ((n) >> 12)) & 0xF)) & 1)
+
 // Various parsers.
 Parser_t ParseBLOCK, ParseEQUALS, ParseEqualsECADR, ParseCHECKequals, ParseBANK,
     ParseEquate, Parse2DEC, Parse2DECstar, ParseDEC, ParseDECstar, ParseSETLOC,
@@ -565,39 +962,55 @@ Parser_t ParseBLOCK, ParseEQUALS, ParseEqualsECADR, ParseCHECKequals, ParseBANK,
     Parse2OCT, ParseSBANKEquals, ParseEDRUPT, ParseInterpretiveOperand,
     ParseEqMinus, ParseXCADR, ParseSECSIZ;
 
-extern int Block1;
-extern int EarlySBank;
-extern int Raytheon;
-extern int blk2;
-extern char *assemblyTarget;
-extern int Html;
-extern FILE *HtmlOut;
-extern int Simulation;
-
-extern int ObjectCode[044][02000];
-extern unsigned char Parities[044][02000];
-
-extern int NumInterpretiveOperands, RawNumInterpretiveOperands;
-extern int nnnnFields[4];
-extern unsigned char SwitchIncrement[4], SwitchInvert[4];
-extern int OpcodeOffset;
-extern int ArgType;
-
-extern int formatOnly;
-extern int toYulOnly, toYulOnlySequenceNumber;
-extern Line_t toYulOnlyLogSection;
+extern ASSEMBLY int Block1;
+extern ASSEMBLY int EarlySBank;
+extern ASSEMBLY int Raytheon;
+extern ASSEMBLY int blk2;
+extern ASSEMBLY char *assemblyTarget;
+extern ASSEMBLY int Html;
+extern ASSEMBLY FILE *HtmlOut;
+extern ASSEMBLY int Simulation;
+
+// The object code, one 15-bit word per cell, with OBJECT_WRITTEN set in
+// the cells which have been assembled (or filled in with bugger words and
+// such).  Only those get parity bits; see PARITY16.
+extern ASSEMBLY uint16_t (*ObjectCode)[02000];
+#define OBJECT_WRITTEN         (0100000)
+extern ASSEMBLY PassBoundary_t *PassBoundaries;
+extern ASSEMBLY int NumPassBoundaries, PassTotalLines;
+extern ASSEMBLY const PassBoundary_t *ChunkStart;
+extern ASSEMBLY int ChunkEnd;
+extern ASSEMBLY PassBoundary_t ChunkEndState;
+extern ASSEMBLY int Processes;
+
+// Set wherever memory runs out and the error can't simply be returned to
+// the caller.  The assembly stops after the current pass, and fails.
+extern ASSEMBLY int OutOfMemory;
+
+extern ASSEMBLY int NumInterpretiveOperands, RawNumInterpretiveOperands;
+extern ASSEMBLY int nnnnFields[4];
+extern ASSEMBLY unsigned char SwitchIncrement[4], SwitchInvert[4];
+extern ASSEMBLY int OpcodeOffset;
+extern ASSEMBLY int ArgType;
+
+extern ASSEMBLY int formatOnly;
+extern ASSEMBLY int toYulOnly, toYulOnlySequenceNumber;
+extern ASSEMBLY Line_t toYulOnlyLogSection;
 extern int flipBugger[044];
 
-extern int trace;
-extern int asYUL;
-extern int numSymbolsReassigned;
-extern int thisIsTheLastPass;
+extern ASSEMBLY int trace;
+extern ASSEMBLY int asYUL;
+extern ASSEMBLY int numSymbolsReassigned;
+extern ASSEMBLY int DiscoveringSymbols;
+extern ASSEMBLY int LinesEvaluated, LinesSkipped;
+extern ASSEMBLY unsigned long OperandHits, OperandMisses;
+extern ASSEMBLY int thisIsTheLastPass;
 
-extern int debugLevel;
+extern ASSEMBLY int debugLevel;
 #define DEBUG_SOLARIUM 0x8000
-extern int debugPass;
-extern int debugLine;
-extern char *debugLineString;
+extern ASSEMBLY int debugPass;
+extern ASSEMBLY int debugLine;
+extern ASSEMBLY char *debugLineString;
 void debugPrint(char *msg);
 
 #endif // INCLUDED_YAYUL_H